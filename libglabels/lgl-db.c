@@ -46,6 +46,9 @@
 #define USER_CONFIG_DIR       g_build_filename (g_get_user_config_dir (), "libglabels", "templates" , NULL)
 #define ALT_USER_CONFIG_DIR   g_build_filename (g_get_home_dir (), ".glabels", NULL)
 
+/* Drop all cached filter results once this many distinct filters are cached. */
+#define MAX_CACHED_FILTERS    64
+
 
 /*===========================================*/
 /* Private types                             */
@@ -63,6 +66,29 @@ typedef struct _lglDbModel          lglDbModel;
 typedef struct _lglDbModelClass     lglDbModelClass;
 
 
+/*
+ * Per-template sort and match keys, computed once at registration so that
+ * name list queries neither casefold nor allocate while comparing.
+ */
+typedef struct {
+        lglTemplate *template;   /* Owned by lglDbModel::templates */
+        gchar       *name;       /* "brand part" */
+        gchar       *sort_key;   /* See _lgl_str_part_name_collate_key() */
+        gchar       *brand_key;  /* Collation key of casefolded brand */
+        gchar       *signature;  /* See _lgl_template_get_geometry_signature() */
+        gchar       *match_key;  /* See match_key_new() */
+} TemplateEntry;
+
+
+/*
+ * A template file queued for parsing by read_templates().
+ */
+typedef struct {
+        gchar            *filename;
+        lglTemplateBatch *batch;
+} TemplateFile;
+
+
 struct _lglDbModel {
         GObject     parent;
 
@@ -70,8 +96,15 @@ struct _lglDbModel {
         GList      *categories;
         GList      *vendors;
         GList      *templates;
+        GList      *templates_tail;     /* Last link of templates, for appending */
 
         GHashTable *template_cache;
+        GHashTable *template_keys;      /* Set of TemplateEntry match keys */
+
+        GPtrArray  *template_entries;   /* TemplateEntry, sorted if entries_sorted_flag */
+        gboolean    entries_sorted_flag;
+        GHashTable *filter_cache;       /* filter key -> sorted GPtrArray of TemplateEntry */
+        GHashTable *signature_index;    /* signature -> GPtrArray of TemplateEntry */
 };
 
 
@@ -108,7 +141,23 @@ static lglDbModel *model = NULL;
 
 static void   lgl_db_model_finalize        (GObject     *object);
 
+static void   append_template              (lglTemplate *template);
 static void   add_to_template_cache        (lglTemplate *template);
+static void   remove_from_template_cache   (lglTemplate *template);
+
+static TemplateEntry *template_entry_new   (lglTemplate *template);
+static void   template_entry_free          (TemplateEntry *entry);
+static gint   template_entry_cmp           (gconstpointer a,
+                                            gconstpointer b);
+static gchar *fold_key_new                 (const gchar *s);
+static gchar *match_key_new                (const gchar *brand,
+                                            const gchar *part);
+static GPtrArray *get_sorted_entries       (void);
+static GPtrArray *get_filtered_entries     (const gchar *brand,
+                                            const gchar *paper_id,
+                                            const gchar *category_id);
+static void   add_to_signature_index       (TemplateEntry *entry);
+static void   remove_from_signature_index  (TemplateEntry *entry);
 
 static GList *read_papers                  (void);
 static GList *read_paper_files_from_dir    (GList       *papers,
@@ -123,7 +172,14 @@ static GList *read_vendor_files_from_dir   (GList       *vendors,
                                             const gchar *dirname);
 
 static void   read_templates               (void);
-static void   read_template_files_from_dir (const gchar *dirname);
+static void   read_template_files_from_dir (GPtrArray   *files,
+                                            const gchar *dirname);
+static gint   compare_filenames            (gconstpointer a,
+                                            gconstpointer b);
+static void   parse_template_files         (GPtrArray   *files);
+static void   parse_template_file_func     (TemplateFile *file,
+                                            gpointer     user_data);
+static void   template_file_free           (TemplateFile *file);
 
 static lglTemplate *template_full_page     (const gchar *page_size);
 
@@ -165,6 +221,11 @@ static void
 lgl_db_model_init (lglDbModel *this)
 {
         this->template_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)lgl_template_free);
+
+        this->template_entries = g_ptr_array_new_with_free_func ((GDestroyNotify)template_entry_free);
+        this->filter_cache     = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_ptr_array_unref);
+        this->signature_index  = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_ptr_array_unref);
+        this->template_keys    = g_hash_table_new (g_str_hash, g_str_equal);
 }
 
 
@@ -181,6 +242,10 @@ lgl_db_model_finalize (GObject *object)
         this = LGL_DB_MODEL (object);
 
         g_hash_table_unref (this->template_cache);
+        g_hash_table_unref (this->filter_cache);
+        g_hash_table_unref (this->signature_index);
+        g_hash_table_unref (this->template_keys);
+        g_ptr_array_unref (this->template_entries);
 
         for (p = this->papers; p != NULL; p = p->next)
         {
@@ -252,6 +317,9 @@ lgl_db_init (void)
         lglTemplate *template;
         GList       *page_sizes;
         GList       *p;
+        GTimer      *timer;
+
+        timer = g_timer_new ();
 
         model = lgl_db_model_new ();
 
@@ -299,6 +367,9 @@ lgl_db_init (void)
         }
         lgl_db_free_paper_id_list (page_sizes);
 
+        g_debug ("Template database initialized in %.1f ms (%u templates).",
+                 1000*g_timer_elapsed (timer, NULL), model->template_entries->len);
+        g_timer_destroy (timer);
 }
 
 
@@ -1482,8 +1553,7 @@ _lgl_db_register_template_internal (const lglTemplate   *template)
         if (!lgl_db_does_template_exist (template->brand, template->part))
         {
                 template_copy = lgl_template_dup (template);
-                model->templates = g_list_append (model->templates, template_copy);
-                add_to_template_cache (template_copy);
+                append_template (template_copy);
         }
         else
         {
@@ -1533,8 +1603,7 @@ lgl_db_register_template (const lglTemplate *template)
                 {
                         template_copy = lgl_template_dup (template);
                         lgl_template_add_category (template_copy, "user-defined");
-                        model->templates = g_list_append (model->templates, template_copy);
-                        add_to_template_cache (template_copy);
+                        append_template (template_copy);
                         g_signal_emit (G_OBJECT (model), signals[CHANGED], 0);
                         return LGL_DB_REG_OK;
                 }
@@ -1604,6 +1673,11 @@ lgl_db_delete_template_by_name (const gchar *name)
 
                         if ( lgl_template_do_templates_match (template, template1) )
                         {
+                                remove_from_template_cache (template1);
+                                if ( p == model->templates_tail )
+                                {
+                                        model->templates_tail = p->prev;
+                                }
                                 model->templates = g_list_delete_link (model->templates, p);
                                 g_hash_table_remove (model->template_cache, name);
                                 break;
@@ -1664,8 +1738,8 @@ gboolean
 lgl_db_does_template_exist (const gchar *brand,
                             const gchar *part)
 {
-        GList            *p_tmplt;
-        lglTemplate      *template;
+        gchar            *key;
+        gboolean          exists;
 
         if (!model)
         {
@@ -1677,18 +1751,11 @@ lgl_db_does_template_exist (const gchar *brand,
                 return FALSE;
         }
 
-        for (p_tmplt = model->templates; p_tmplt != NULL; p_tmplt = p_tmplt->next)
-        {
-                template = (lglTemplate *) p_tmplt->data;
-
-                if ( UTF8_EQUAL (brand, template->brand) &&
-                     UTF8_EQUAL (part, template->part) )
-                {
-                        return TRUE;
-                }
-        }
+        key = match_key_new (brand, part);
+        exists = g_hash_table_contains (model->template_keys, key);
+        g_free (key);
 
-        return FALSE;
+        return exists;
 }
 
 
@@ -1753,26 +1820,22 @@ lgl_db_get_template_name_list_all (const gchar *brand,
                                    const gchar *paper_id,
                                    const gchar *category_id)
 {
-        GList            *p_tmplt;
-        lglTemplate      *template;
-        gchar            *name;
+        GPtrArray        *entries;
+        TemplateEntry    *entry;
         GList            *names = NULL;
+        gint              i;
 
         if (!model)
         {
                 lgl_db_init ();
         }
 
-        for (p_tmplt = model->templates; p_tmplt != NULL; p_tmplt = p_tmplt->next)
+        entries = get_filtered_entries (brand, paper_id, category_id);
+
+        for (i = entries->len - 1; i >= 0; i--)
         {
-                template = (lglTemplate *) p_tmplt->data;
-                if (lgl_template_does_brand_match (template, brand) &&
-                    lgl_template_does_page_size_match (template, paper_id) &&
-                    lgl_template_does_category_match (template, category_id))
-                {
-                        name = g_strdup_printf ("%s %s", template->brand, template->part);
-                        names = g_list_insert_sorted (names, name, (GCompareFunc)lgl_str_part_name_cmp);
-                }
+                entry = g_ptr_array_index (entries, i);
+                names = g_list_prepend (names, g_strdup (entry->name));
         }
 
         return names;
@@ -1791,11 +1854,14 @@ lgl_db_get_template_name_list_all (const gchar *brand,
 GList *
 lgl_db_get_similar_template_name_list (const gchar  *name)
 {
-        GList            *p_tmplt;
+        GPtrArray        *matches, *candidates;
+        TemplateEntry    *entry;
         lglTemplate      *template1;
-        lglTemplate      *template2;
-        gchar            *name2;
+        gchar            *signature;
+        gint              offset1, offset2;
         GList            *names = NULL;
+        guint             j;
+        gint              i;
 
         if (!model)
         {
@@ -1813,22 +1879,42 @@ lgl_db_get_similar_template_name_list (const gchar  *name)
                 return NULL;
         }
 
-        for (p_tmplt = model->templates; p_tmplt != NULL; p_tmplt = p_tmplt->next)
+        /*
+         * Identical templates can only live in the buckets adjacent to
+         * template1's own, so probe those and do the exact test on the few
+         * candidates found.
+         */
+        matches = g_ptr_array_new ();
+        for (offset1 = -1; offset1 <= 1; offset1++)
         {
-                template2 = (lglTemplate *) p_tmplt->data;
-
-                if ( lgl_template_are_templates_identical (template1, template2) )
+                for (offset2 = -1; offset2 <= 1; offset2++)
                 {
+                        signature = _lgl_template_get_geometry_signature (template1, offset1, offset2);
+                        candidates = g_hash_table_lookup (model->signature_index, signature);
+                        g_free (signature);
 
-                        name2 = g_strdup_printf ("%s %s", template2->brand, template2->part);
-                        if ( !UTF8_EQUAL (name2, name) )
+                        for (j = 0; candidates && (j < candidates->len); j++)
                         {
-                                names = g_list_insert_sorted (names, name2,
-                                                              (GCompareFunc)lgl_str_part_name_cmp);
-                        }
+                                entry = g_ptr_array_index (candidates, j);
 
+                                if ( lgl_template_are_templates_identical (template1, entry->template) &&
+                                     !UTF8_EQUAL (entry->name, name) )
+                                {
+                                        g_ptr_array_add (matches, entry);
+                                }
+                        }
                 }
         }
+        g_ptr_array_sort (matches, template_entry_cmp);
+
+        for (i = matches->len - 1; i >= 0; i--)
+        {
+                entry = g_ptr_array_index (matches, i);
+                names = g_list_prepend (names, g_strdup (entry->name));
+        }
+
+        g_ptr_array_unref (matches);
+        lgl_template_free (template1);
 
         return names;
 }
@@ -1940,50 +2026,330 @@ lgl_db_lookup_template_from_brand_part(const gchar *brand,
 }
 
 
+static void
+append_template (lglTemplate *template)
+{
+        GList            *link;
+
+        link = g_list_alloc ();
+        link->data = template;
+        link->prev = model->templates_tail;
+
+        if ( model->templates_tail )
+        {
+                model->templates_tail->next = link;
+        }
+        else
+        {
+                model->templates = link;
+        }
+        model->templates_tail = link;
+
+        add_to_template_cache (template);
+}
+
+
 static void
 add_to_template_cache (lglTemplate *template)
 {
+        TemplateEntry    *entry;
         gchar            *name;
 
         name = g_strdup_printf ("%s %s", template->brand, template->part);
 
         g_hash_table_insert (model->template_cache, name, template);
+
+        entry = template_entry_new (template);
+        g_ptr_array_add (model->template_entries, entry);
+        add_to_signature_index (entry);
+        g_hash_table_add (model->template_keys, entry->match_key);
+        model->entries_sorted_flag = FALSE;
+        g_hash_table_remove_all (model->filter_cache);
+}
+
+
+static void
+remove_from_template_cache (lglTemplate *template)
+{
+        TemplateEntry    *entry;
+        guint             i;
+
+        for (i = 0; i < model->template_entries->len; i++)
+        {
+                entry = g_ptr_array_index (model->template_entries, i);
+                if ( entry->template == template )
+                {
+                        remove_from_signature_index (entry);
+                        g_hash_table_remove (model->template_keys, entry->match_key);
+
+                        /* Keeps remaining entries in order. */
+                        g_ptr_array_remove_index (model->template_entries, i);
+                        break;
+                }
+        }
+
+        g_hash_table_remove_all (model->filter_cache);
+}
+
+
+static TemplateEntry *
+template_entry_new (lglTemplate *template)
+{
+        TemplateEntry    *entry;
+
+        entry = g_new0 (TemplateEntry, 1);
+
+        entry->template  = template;
+        entry->name      = g_strdup_printf ("%s %s", template->brand, template->part);
+        entry->sort_key  = _lgl_str_part_name_collate_key (entry->name);
+        entry->brand_key = fold_key_new (template->brand);
+        entry->signature = _lgl_template_get_geometry_signature (template, 0, 0);
+        entry->match_key = match_key_new (template->brand, template->part);
+
+        return entry;
+}
+
+
+static void
+template_entry_free (TemplateEntry *entry)
+{
+        g_free (entry->name);
+        g_free (entry->sort_key);
+        g_free (entry->brand_key);
+        g_free (entry->signature);
+        g_free (entry->match_key);
+        g_free (entry);
+}
+
+
+static gint
+template_entry_cmp (gconstpointer a,
+                    gconstpointer b)
+{
+        const TemplateEntry *entry_a = *(const TemplateEntry **)a;
+        const TemplateEntry *entry_b = *(const TemplateEntry **)b;
+
+        return _lgl_str_part_name_collate_key_cmp (entry_a->sort_key, entry_b->sort_key);
+}
+
+
+/*
+ * Two strings are UTF8_EQUAL() exactly when these keys are equal.
+ */
+static gchar *
+fold_key_new (const gchar *s)
+{
+        gchar *folded;
+        gchar *key;
+
+        folded = g_utf8_casefold (s, -1);
+        key    = g_utf8_collate_key (folded, -1);
+        g_free (folded);
+
+        return key;
+}
+
+
+static void
+add_to_signature_index (TemplateEntry *entry)
+{
+        GPtrArray        *bucket;
+
+        bucket = g_hash_table_lookup (model->signature_index, entry->signature);
+        if ( bucket == NULL )
+        {
+                bucket = g_ptr_array_new ();
+                g_hash_table_insert (model->signature_index, g_strdup (entry->signature), bucket);
+        }
+
+        g_ptr_array_add (bucket, entry);
+}
+
+
+static void
+remove_from_signature_index (TemplateEntry *entry)
+{
+        GPtrArray        *bucket;
+
+        bucket = g_hash_table_lookup (model->signature_index, entry->signature);
+        if ( bucket != NULL )
+        {
+                g_ptr_array_remove_fast (bucket, entry);
+                if ( bucket->len == 0 )
+                {
+                        g_hash_table_remove (model->signature_index, entry->signature);
+                }
+        }
+}
+
+
+/*
+ * Two templates match in the sense of lgl_db_does_template_exist() exactly
+ * when these keys are equal.  The length prefix keeps the brand/part split
+ * unambiguous.
+ */
+static gchar *
+match_key_new (const gchar *brand,
+               const gchar *part)
+{
+        gchar *brand_key, *part_key;
+        gchar *key;
+
+        brand_key = fold_key_new (brand);
+        part_key  = fold_key_new (part);
+
+        key = g_strdup_printf ("%" G_GSIZE_FORMAT ":%s%s", strlen (brand_key), brand_key, part_key);
+
+        g_free (brand_key);
+        g_free (part_key);
+
+        return key;
+}
+
+
+/*
+ * All templates, sorted in part name order.  Sorted at most once per
+ * change to the database.
+ */
+static GPtrArray *
+get_sorted_entries (void)
+{
+        if ( !model->entries_sorted_flag )
+        {
+                g_ptr_array_sort (model->template_entries, template_entry_cmp);
+                model->entries_sorted_flag = TRUE;
+        }
+
+        return model->template_entries;
+}
+
+
+/*
+ * Templates matching the given filter, sorted in part name order.  Results
+ * are cached per filter until the database changes.  The returned array is
+ * owned by the cache.
+ */
+static GPtrArray *
+get_filtered_entries (const gchar *brand,
+                      const gchar *paper_id,
+                      const gchar *category_id)
+{
+        gchar            *brand_key = NULL;
+        gchar            *paper_key, *category_key, *filter_key;
+        GPtrArray        *all_entries;
+        GPtrArray        *entries;
+        TemplateEntry    *entry;
+        guint             i;
+
+        if ( brand != NULL )
+        {
+                brand_key = fold_key_new (brand);
+        }
+        paper_key    = paper_id ? g_ascii_strdown (paper_id, -1) : NULL;
+        category_key = category_id ? g_ascii_strdown (category_id, -1) : NULL;
+
+        /* NULL matches everything, so keep it distinct from an empty string. */
+        filter_key = g_strdup_printf ("%c%s\x1f%c%s\x1f%c%s",
+                                      brand_key    ? '=' : '*', brand_key    ? brand_key    : "",
+                                      paper_key    ? '=' : '*', paper_key    ? paper_key    : "",
+                                      category_key ? '=' : '*', category_key ? category_key : "");
+        g_free (paper_key);
+        g_free (category_key);
+
+        entries = g_hash_table_lookup (model->filter_cache, filter_key);
+        if ( entries == NULL )
+        {
+                all_entries = get_sorted_entries ();
+
+                entries = g_ptr_array_new ();
+                for (i = 0; i < all_entries->len; i++)
+                {
+                        entry = g_ptr_array_index (all_entries, i);
+
+                        if ( ((brand_key == NULL) || (strcmp (brand_key, entry->brand_key) == 0)) &&
+                             lgl_template_does_page_size_match (entry->template, paper_id) &&
+                             lgl_template_does_category_match (entry->template, category_id) )
+                        {
+                                g_ptr_array_add (entries, entry);
+                        }
+                }
+
+                if ( g_hash_table_size (model->filter_cache) >= MAX_CACHED_FILTERS )
+                {
+                        g_hash_table_remove_all (model->filter_cache);
+                }
+                g_hash_table_insert (model->filter_cache, filter_key, entries);
+        }
+        else
+        {
+                g_free (filter_key);
+        }
+
+        g_free (brand_key);
+
+        return entries;
 }
 
 
 void
 read_templates (void)
 {
-        gchar       *data_dir;
-        GList       *p;
-        lglTemplate *template;
+        gchar        *data_dir;
+        GPtrArray    *files;
+        guint         n_user_files, i;
+        TemplateFile *file;
+        GList        *p;
+        lglTemplate  *template;
 
         /*
-         * User defined templates.  Add to user-defined category.
+         * Collect files in registration order: user defined templates,
+         * alternate user defined templates (used for manually created
+         * templates), then system templates.  The first definition of a
+         * brand/part wins, so this order must not change.
          */
+        files = g_ptr_array_new_with_free_func ((GDestroyNotify)template_file_free);
+
         data_dir = USER_CONFIG_DIR;
-        read_template_files_from_dir (data_dir);
+        read_template_files_from_dir (files, data_dir);
         g_free (data_dir);
-        for ( p=model->templates; p != NULL; p=p->next )
-        {
-                template = (lglTemplate *)p->data;
-                lgl_template_add_category (template, "user-defined");
-        }
+        n_user_files = files->len;
 
-        /*
-         * Alternate user defined templates.  (Used for manually created templates).
-         */
         data_dir = ALT_USER_CONFIG_DIR;
-        read_template_files_from_dir (data_dir);
+        read_template_files_from_dir (files, data_dir);
         g_free (data_dir);
 
-        /*
-         * System templates.
-         */
         data_dir = SYSTEM_CONFIG_DIR;
-        read_template_files_from_dir (data_dir);
+        read_template_files_from_dir (files, data_dir);
         g_free (data_dir);
 
+        /*
+         * Parsing is independent per file, registration is not.
+         */
+        parse_template_files (files);
+
+        for ( i = 0; i < files->len; i++ )
+        {
+                file = g_ptr_array_index (files, i);
+                if ( file->batch )
+                {
+                        _lgl_xml_template_batch_register (file->batch);
+                }
+
+                /*
+                 * User defined templates.  Add to user-defined category.
+                 */
+                if ( i == n_user_files - 1 )
+                {
+                        for ( p=model->templates; p != NULL; p=p->next )
+                        {
+                                template = (lglTemplate *)p->data;
+                                lgl_template_add_category (template, "user-defined");
+                        }
+                }
+        }
+
+        g_ptr_array_unref (files);
+
         if (model->templates == NULL)
         {
                 g_critical (_("Unable to locate any template files.  Libglabels may not be installed correctly!"));
@@ -1992,12 +2358,15 @@ read_templates (void)
 
 
 void
-read_template_files_from_dir (const gchar *dirname)
+read_template_files_from_dir (GPtrArray   *files,
+                              const gchar *dirname)
 {
-        GDir        *dp;
-        const gchar *filename, *extension, *extension2;
-        gchar       *full_filename = NULL;
-        GError      *gerror = NULL;
+        GDir         *dp;
+        const gchar  *filename, *extension, *extension2;
+        GPtrArray    *names;
+        TemplateFile *file;
+        guint         i;
+        GError       *gerror = NULL;
 
         if (dirname == NULL)
                 return;
@@ -2014,6 +2383,8 @@ read_template_files_from_dir (const gchar *dirname)
                 return;
         }
 
+        names = g_ptr_array_new_with_free_func (g_free);
+
         while ((filename = g_dir_read_name (dp)) != NULL)
         {
 
@@ -2023,15 +2394,88 @@ read_template_files_from_dir (const gchar *dirname)
                 if ( (extension && ASCII_EQUAL (extension, ".template")) ||
                      (extension2 && ASCII_EQUAL (extension2, "-templates.xml")) )
                 {
-
-                        full_filename = g_build_filename (dirname, filename, NULL);
-                        lgl_xml_template_read_templates_from_file (full_filename);
-                        g_free (full_filename);
+                        g_ptr_array_add (names, g_strdup (filename));
                 }
 
         }
 
         g_dir_close (dp);
+
+        /* Directory order is filesystem dependent; make it deterministic. */
+        g_ptr_array_sort (names, compare_filenames);
+
+        for ( i = 0; i < names->len; i++ )
+        {
+                file = g_new0 (TemplateFile, 1);
+                file->filename = g_build_filename (dirname, g_ptr_array_index (names, i), NULL);
+                g_ptr_array_add (files, file);
+        }
+
+        g_ptr_array_unref (names);
+}
+
+
+static gint
+compare_filenames (gconstpointer a,
+                   gconstpointer b)
+{
+        return strcmp (*(const gchar **)a, *(const gchar **)b);
+}
+
+
+/*
+ * Parse all template files, concurrently where there is more than one
+ * processor.  Only the paper database is consulted while parsing.
+ */
+static void
+parse_template_files (GPtrArray *files)
+{
+        GThreadPool  *pool;
+        gint          n_threads;
+        guint         i;
+
+        LIBXML_TEST_VERSION;
+
+        n_threads = MIN (g_get_num_processors (), (gint)files->len);
+
+        if ( n_threads <= 1 )
+        {
+                for ( i = 0; i < files->len; i++ )
+                {
+                        parse_template_file_func (g_ptr_array_index (files, i), NULL);
+                }
+                return;
+        }
+
+        pool = g_thread_pool_new ((GFunc)parse_template_file_func, NULL,
+                                  n_threads, FALSE, NULL);
+
+        for ( i = 0; i < files->len; i++ )
+        {
+                g_thread_pool_push (pool, g_ptr_array_index (files, i), NULL);
+        }
+
+        /* Wait for all files. */
+        g_thread_pool_free (pool, FALSE, TRUE);
+
+        g_debug ("Parsed %u template files on %d threads.", files->len, n_threads);
+}
+
+
+static void
+parse_template_file_func (TemplateFile *file,
+                          gpointer      user_data)
+{
+        file->batch = _lgl_xml_template_batch_read (file->filename);
+}
+
+
+static void
+template_file_free (TemplateFile *file)
+{
+        _lgl_xml_template_batch_free (file->batch);
+        g_free (file->filename);
+        g_free (file);
 }
 
 
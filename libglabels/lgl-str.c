@@ -25,6 +25,8 @@
 #include <string.h>
 #include <math.h>
 
+#include "libglabels-private.h"
+
 #define FRAC_EPSILON 0.00005
 
 
@@ -45,6 +47,9 @@
 static gchar *span_digits (gchar **p);
 static gchar *span_non_digits (gchar **p);
 
+static gsize  span_length (const gchar *p,
+                           gboolean     digits_flag);
+
 /*===========================================*/
 /* Functions.                                */
 /*===========================================*/
@@ -221,6 +226,138 @@ span_non_digits (gchar **p)
 }
 
 
+/*
+ * Part name collation keys.
+ *
+ * A key is the sequence of chunks of the casefolded string, as split by
+ * lgl_str_part_name_cmp().  Each chunk is stored as a type byte ('n' for
+ * numeric, 't' for text), the 64 bit big-endian value of numeric chunks,
+ * and the NUL terminated g_utf8_collate_key() of the chunk.  A zero type
+ * byte ends the key.  Comparing two keys with
+ * _lgl_str_part_name_collate_key_cmp() gives the same result as comparing
+ * the original strings with lgl_str_part_name_cmp(), without allocating.
+ */
+gchar *
+_lgl_str_part_name_collate_key (const gchar *s)
+{
+        GString  *key;
+        gchar    *folded, *p, *chunk, *chunk_key;
+        gboolean  isnum;
+        gsize     len;
+        guint64   n;
+        guchar    be[8];
+        gint      i;
+
+        key = g_string_new (NULL);
+
+        if ( s != NULL )
+        {
+                folded = g_utf8_casefold (s, -1);
+
+                for ( p = folded; *p != '\0'; p += len )
+                {
+                        isnum = g_ascii_isdigit (*p);
+                        len   = span_length (p, isnum);
+
+                        chunk     = g_strndup (p, len);
+                        chunk_key = g_utf8_collate_key (chunk, -1);
+
+                        if ( isnum )
+                        {
+                                g_string_append_c (key, 'n');
+                                n = g_ascii_strtoull (chunk, NULL, 10);
+                                for ( i = 7; i >= 0; i--, n >>= 8 )
+                                {
+                                        be[i] = n & 0xFF;
+                                }
+                                g_string_append_len (key, (gchar *)be, 8);
+                        }
+                        else
+                        {
+                                g_string_append_c (key, 't');
+                        }
+                        g_string_append_len (key, chunk_key, strlen (chunk_key) + 1);
+
+                        g_free (chunk_key);
+                        g_free (chunk);
+                }
+
+                g_free (folded);
+        }
+
+        g_string_append_c (key, '\0');
+
+        return g_string_free (key, FALSE);
+}
+
+
+gint
+_lgl_str_part_name_collate_key_cmp (const gchar *key1,
+                                    const gchar *key2)
+{
+        gboolean isnum1, isnum2;
+        guint64  n1, n2;
+        gint     i, result;
+
+        while ( (*key1 != '\0') && (*key2 != '\0') )
+        {
+                isnum1 = (*key1++ == 'n');
+                isnum2 = (*key2++ == 'n');
+
+                n1 = n2 = 0;
+                if ( isnum1 )
+                {
+                        for ( i = 0; i < 8; i++ )
+                        {
+                                n1 = (n1 << 8) | (guchar)*key1++;
+                        }
+                }
+                if ( isnum2 )
+                {
+                        for ( i = 0; i < 8; i++ )
+                        {
+                                n2 = (n2 << 8) | (guchar)*key2++;
+                        }
+                }
+
+                if ( isnum1 && isnum2 )
+                {
+                        if ( n1 < n2 ) return -1;
+                        if ( n1 > n2 ) return  1;
+                }
+                else
+                {
+                        result = strcmp (key1, key2);
+                        if ( result != 0 )
+                        {
+                                return result;
+                        }
+                }
+
+                key1 += strlen (key1) + 1;
+                key2 += strlen (key2) + 1;
+        }
+
+        /* The string that ran out of chunks first sorts first. */
+        return (*key1 != '\0') - (*key2 != '\0');
+}
+
+
+static gsize
+span_length (const gchar *p,
+             gboolean     digits_flag)
+{
+        const gchar *start = p;
+
+        while ( *p && (g_ascii_isdigit (*p) == digits_flag) )
+        {
+                p = g_utf8_next_char (p);
+        }
+
+        return p - start;
+}
+
+
 /**
  * lgl_str_format_fraction:
  * @x: Floating point number to convert to fractional notation
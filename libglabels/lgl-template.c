@@ -50,6 +50,10 @@
 /* Private globals                           */
 /*===========================================*/
 
+/* Sorted origins of each frame, keyed by frame, built on first use. */
+static GHashTable *origins_cache = NULL;
+G_LOCK_DEFINE_STATIC (origins_cache);
+
 
 /*===========================================*/
 /* Local function prototypes                 */
@@ -59,6 +63,8 @@ static gint         compare_origins              (gconstpointer           a,
                                                   gconstpointer           b,
                                                   gpointer                user_data);
 
+static void         forget_origins               (const lglTemplateFrame *frame);
+
 /*===========================================*/
 /* Functions.                                */
 /*===========================================*/
@@ -375,6 +381,75 @@ lgl_template_are_templates_identical (const lglTemplate   *template1,
 }
 
 
+/*
+ * _lgl_template_get_geometry_signature:
+ *   @template:  Pointer to template structure
+ *   @offset1:   Bucket offset for 1st frame dimension (-1, 0 or 1)
+ *   @offset2:   Bucket offset for 2nd frame dimension (-1, 0 or 1)
+ *
+ * Build a hash key from the properties lgl_template_are_templates_identical()
+ * compares: paper id and page size exactly, frame shape, and frame size
+ * quantized to buckets 2*EPSILON wide.  Two frame sizes within EPSILON of
+ * each other land in the same or an adjacent bucket, so every template
+ * identical to @template has a signature equal to one of those built with
+ * offsets in -1..1.  Layouts are left to the exact test, since it only
+ * requires the layouts of the first template to be a subset of the second's.
+ *
+ * Returns:  A newly allocated signature string.
+ */
+gchar *
+_lgl_template_get_geometry_signature (const lglTemplate *template,
+                                      gint               offset1,
+                                      gint               offset2)
+{
+        lglTemplateFrame  *frame;
+        gchar             *paper_id;
+        gint               shape = -1;
+        gdouble            d1 = 0.0, d2 = 0.0;
+        gchar             *signature;
+
+        if ( template->frames )
+        {
+                frame = (lglTemplateFrame *)template->frames->data;
+                shape = frame->shape;
+
+                switch ( frame->shape )
+                {
+                case LGL_TEMPLATE_FRAME_SHAPE_RECT:
+                        d1 = frame->rect.w;
+                        d2 = frame->rect.h;
+                        break;
+                case LGL_TEMPLATE_FRAME_SHAPE_ELLIPSE:
+                        d1 = frame->ellipse.w;
+                        d2 = frame->ellipse.h;
+                        break;
+                case LGL_TEMPLATE_FRAME_SHAPE_ROUND:
+                        d1 = frame->round.r;
+                        break;
+                case LGL_TEMPLATE_FRAME_SHAPE_CD:
+                        d1 = frame->cd.r1;
+                        d2 = frame->cd.r2;
+                        break;
+                }
+        }
+
+        paper_id = g_utf8_casefold (template->paper_id ? template->paper_id : "", -1);
+
+        /* %a is exact, matching the exact page size comparison. */
+        signature = g_strdup_printf ("%s|%a|%a|%d|%d|%d",
+                                     paper_id,
+                                     template->page_width,
+                                     template->page_height,
+                                     shape,
+                                     (gint)floor (d1 / (2*EPSILON)) + offset1,
+                                     (gint)floor (d2 / (2*EPSILON)) + offset2);
+
+        g_free (paper_id);
+
+        return signature;
+}
+
+
 /**
  * lgl_template_add_frame:
  *   @template:  Pointer to template structure
@@ -811,6 +886,36 @@ lgl_template_frame_get_size_description (const lglTemplateFrame *frame,
  */
 lglTemplateOrigin *
 lgl_template_frame_get_origins (const lglTemplateFrame *frame)
+{
+        gint               n_labels;
+        lglTemplateOrigin *origins;
+
+        g_return_val_if_fail (frame, NULL);
+
+        n_labels = lgl_template_frame_get_n_labels (frame);
+        origins  = g_new (lglTemplateOrigin, n_labels);
+        memcpy (origins, lgl_template_frame_get_origins_const (frame),
+                n_labels * sizeof (lglTemplateOrigin));
+
+        return origins;
+}
+
+
+/**
+ * lgl_template_frame_get_origins_const:
+ * @frame: #lglTemplateFrame structure to query
+ *
+ * Get the array of label origins for the given frame, in the same order as
+ * lgl_template_frame_get_origins().  The array is computed once per frame and
+ * kept until the frame's layouts change or the frame is freed.  It may be
+ * requested from several threads.
+ *
+ * Returns: A pointer to an array of #lglTemplateOrigin structures owned by @frame.
+ *          Do not modify or free it.
+ *
+ */
+const lglTemplateOrigin *
+lgl_template_frame_get_origins_const (const lglTemplateFrame *frame)
 {
         gint               i_label, n_labels, ix, iy;
         lglTemplateOrigin *origins;
@@ -819,31 +924,141 @@ lgl_template_frame_get_origins (const lglTemplateFrame *frame)
 
         g_return_val_if_fail (frame, NULL);
 
-        n_labels = lgl_template_frame_get_n_labels (frame);
-        origins = g_new0 (lglTemplateOrigin, n_labels);
+        G_LOCK (origins_cache);
 
-        i_label = 0;
-        for ( p=frame->all.layouts; p != NULL; p=p->next )
+        if ( origins_cache == NULL )
         {
-                layout = (lglTemplateLayout *)p->data;
+                origins_cache = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                       NULL, g_free);
+        }
 
-                for (iy = 0; iy < layout->ny; iy++)
+        origins = g_hash_table_lookup (origins_cache, frame);
+        if ( origins == NULL )
+        {
+                n_labels = lgl_template_frame_get_n_labels (frame);
+                origins = g_new0 (lglTemplateOrigin, n_labels);
+
+                i_label = 0;
+                for ( p=frame->all.layouts; p != NULL; p=p->next )
                 {
-                        for (ix = 0; ix < layout->nx; ix++, i_label++)
+                        layout = (lglTemplateLayout *)p->data;
+
+                        for (iy = 0; iy < layout->ny; iy++)
                         {
-                                origins[i_label].x = ix*layout->dx + layout->x0;
-                                origins[i_label].y = iy*layout->dy + layout->y0;
+                                for (ix = 0; ix < layout->nx; ix++, i_label++)
+                                {
+                                        origins[i_label].x = ix*layout->dx + layout->x0;
+                                        origins[i_label].y = iy*layout->dy + layout->y0;
+                                }
                         }
                 }
+
+                g_qsort_with_data (origins, n_labels, sizeof(lglTemplateOrigin),
+                                   compare_origins, NULL);
+
+                g_hash_table_insert (origins_cache, (gpointer)frame, origins);
         }
 
-        g_qsort_with_data (origins, n_labels, sizeof(lglTemplateOrigin),
-                           compare_origins, NULL);
+        G_UNLOCK (origins_cache);
 
         return origins;
 }
 
 
+/**
+ * lgl_template_frame_find_nearest_label:
+ * @frame: #lglTemplateFrame structure to query
+ * @x:     X coordinate relative to upper left hand corner of paper
+ * @y:     Y coordinate relative to upper left hand corner of paper
+ *
+ * Find the label whose center is nearest to the given point.  Each layout is
+ * a regular grid, so the nearest label of a layout is found directly from its
+ * pitch rather than by testing every label.
+ *
+ * Returns: Index of the nearest label in the array returned by
+ *          lgl_template_frame_get_origins(), or -1 if the frame has no labels.
+ *
+ */
+gint
+lgl_template_frame_find_nearest_label (const lglTemplateFrame *frame,
+                                       gdouble                 x,
+                                       gdouble                 y)
+{
+        const lglTemplateOrigin *origins;
+        lglTemplateOrigin        nearest;
+        gdouble                  w, h, ox, oy, d2, min_d2;
+        gint                     ix, iy, lo, hi, mid, cmp;
+        GList                   *p;
+        lglTemplateLayout       *layout;
+
+        g_return_val_if_fail (frame, -1);
+
+        lgl_template_frame_get_size (frame, &w, &h);
+
+        /* Work with origins rather than centers. */
+        x -= w/2.0;
+        y -= h/2.0;
+
+        min_d2 = G_MAXDOUBLE;
+        nearest.x = nearest.y = 0.0;
+        for ( p=frame->all.layouts; p != NULL; p=p->next )
+        {
+                layout = (lglTemplateLayout *)p->data;
+
+                if ( (layout->nx < 1) || (layout->ny < 1) )
+                {
+                        continue;
+                }
+
+                ix = (layout->dx > 0) ? (gint) floor ((x - layout->x0)/layout->dx + 0.5) : 0;
+                iy = (layout->dy > 0) ? (gint) floor ((y - layout->y0)/layout->dy + 0.5) : 0;
+                ix = CLAMP (ix, 0, layout->nx - 1);
+                iy = CLAMP (iy, 0, layout->ny - 1);
+
+                /* Same arithmetic as lgl_template_frame_get_origins_const(). */
+                ox = ix*layout->dx + layout->x0;
+                oy = iy*layout->dy + layout->y0;
+
+                d2 = (x - ox)*(x - ox) + (y - oy)*(y - oy);
+                if ( d2 < min_d2 )
+                {
+                        min_d2 = d2;
+                        nearest.x = ox;
+                        nearest.y = oy;
+                }
+        }
+
+        if ( min_d2 == G_MAXDOUBLE )
+        {
+                return -1;
+        }
+
+        /* Locate the nearest origin in the sorted array. */
+        origins = lgl_template_frame_get_origins_const (frame);
+        lo = 0;
+        hi = lgl_template_frame_get_n_labels (frame) - 1;
+        while ( lo <= hi )
+        {
+                mid = (lo + hi) / 2;
+                cmp = compare_origins (&origins[mid], &nearest, NULL);
+                if ( cmp < 0 )
+                {
+                        lo = mid + 1;
+                }
+                else if ( cmp > 0 )
+                {
+                        hi = mid - 1;
+                }
+                else
+                {
+                        return mid;
+                }
+        }
+
+        return 0;
+}
+
+
 /**
  * lgl_template_frame_add_layout:
  *   @frame:  Pointer to template frame to add layout to.
@@ -860,6 +1075,8 @@ lgl_template_frame_add_layout (lglTemplateFrame   *frame,
         g_return_if_fail (layout);
 
         frame->all.layouts = g_list_append (frame->all.layouts, layout);
+
+        forget_origins (frame);
 }
  
 
@@ -1287,6 +1504,8 @@ lgl_template_frame_free (lglTemplateFrame *frame)
                 g_list_free (frame->all.markups);
                 frame->all.markups = NULL;
 
+                forget_origins (frame);
+
                 g_free (frame);
 
         }
@@ -1404,6 +1623,23 @@ compare_origins (gconstpointer a,
 }
 
 
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Drop cached origins of frame, if any.                          */
+/*--------------------------------------------------------------------------*/
+static void
+forget_origins (const lglTemplateFrame *frame)
+{
+        G_LOCK (origins_cache);
+
+        if ( origins_cache != NULL )
+        {
+                g_hash_table_remove (origins_cache, frame);
+        }
+
+        G_UNLOCK (origins_cache);
+}
+
+
 /**
  * lgl_template_print:
  *   @template: template
@@ -302,6 +302,12 @@ gint                 lgl_template_frame_get_n_labels   (const lglTemplateFrame
 
 lglTemplateOrigin   *lgl_template_frame_get_origins    (const lglTemplateFrame    *frame);
 
+const lglTemplateOrigin *lgl_template_frame_get_origins_const (const lglTemplateFrame *frame);
+
+gint                 lgl_template_frame_find_nearest_label (const lglTemplateFrame *frame,
+                                                            gdouble                 x,
+                                                            gdouble                 y);
+
 gchar               *lgl_template_frame_get_layout_description (const lglTemplateFrame *frame);
 
 gchar               *lgl_template_frame_get_size_description   (const lglTemplateFrame *frame,
@@ -36,6 +36,21 @@
 /* Private types                             */
 /*===========================================*/
 
+/*
+ * One <Template> node of a batch.  Templates defined as equivalents of
+ * other parts can only be built once those parts are registered, so they
+ * are kept as nodes and parsed at registration time.
+ */
+typedef struct {
+        xmlNodePtr   node;
+        lglTemplate *template;  /* NULL if deferred */
+} BatchItem;
+
+struct _lglTemplateBatch {
+        xmlDocPtr    doc;
+        GArray      *items;     /* BatchItem, in document order */
+};
+
 /*===========================================*/
 /* Private globals                           */
 /*===========================================*/
@@ -43,6 +58,8 @@
 /*===========================================*/
 /* Local function prototypes                 */
 /*===========================================*/
+static gboolean xml_check_templates_root    (const xmlDocPtr         templates_doc);
+
 static void  xml_parse_meta_node            (xmlNodePtr              label_node,
                                              lglTemplate            *template);
 static void  xml_parse_label_rectangle_node (xmlNodePtr              label_node,
@@ -105,30 +122,16 @@ static void  xml_create_markup_ellipse_node (const lglTemplateMarkup      *circl
 void
 lgl_xml_template_read_templates_from_file (const gchar *utf8_filename)
 {
-        gchar      *filename;
-        xmlDocPtr   templates_doc;
+        lglTemplateBatch *batch;
 
         LIBXML_TEST_VERSION;
 
-        filename = g_filename_from_utf8 (utf8_filename, -1, NULL, NULL, NULL);
-        if (!filename)
+        batch = _lgl_xml_template_batch_read (utf8_filename);
+        if (batch)
         {
-                g_message ("Utf8 filename conversion error");
-                return;
-        }
-
-        templates_doc = xmlParseFile (filename);
-        if (!templates_doc)
-        {
-                g_message ("\"%s\" is not a glabels template file (not XML)",
-                      filename);
-                return;
+                _lgl_xml_template_batch_register (batch);
+                _lgl_xml_template_batch_free (batch);
         }
-
-        lgl_xml_template_parse_templates_doc (templates_doc);
-
-        g_free (filename);
-        xmlFreeDoc (templates_doc);
 }
 
 
@@ -148,20 +151,12 @@ lgl_xml_template_parse_templates_doc (const xmlDocPtr templates_doc)
 
         LIBXML_TEST_VERSION;
 
-        root = xmlDocGetRootElement (templates_doc);
-        if (!root || !root->name)
+        if (!xml_check_templates_root (templates_doc))
         {
-                g_message ("\"%s\" is not a glabels template file (no root node)",
-                           templates_doc->URL);
-                return;
-        }
-        if (!lgl_xml_is_node (root, "Glabels-templates"))
-        {
-                g_message ("\"%s\" is not a glabels template file (wrong root node)",
-                      templates_doc->URL);
                 return;
         }
 
+        root = xmlDocGetRootElement (templates_doc);
         for (node = root->xmlChildrenNode; node != NULL; node = node->next)
         {
 
@@ -188,6 +183,177 @@ lgl_xml_template_parse_templates_doc (const xmlDocPtr templates_doc)
 }
 
 
+/*
+ * _lgl_xml_template_batch_read:
+ * @utf8_filename:       Filename of templates file (name encoded as UTF-8)
+ *
+ * Parse a template file without registering its templates.  Only reads the
+ * paper database, so may be called from several threads at once once the
+ * papers are loaded.
+ *
+ * Returns: a new #lglTemplateBatch, or NULL if the file could not be read.
+ */
+lglTemplateBatch *
+_lgl_xml_template_batch_read (const gchar *utf8_filename)
+{
+        gchar            *filename;
+        xmlDocPtr         templates_doc;
+        lglTemplateBatch *batch;
+        xmlNodePtr        node;
+        gchar            *equiv_part;
+        BatchItem         item;
+
+        filename = g_filename_from_utf8 (utf8_filename, -1, NULL, NULL, NULL);
+        if (!filename)
+        {
+                g_message ("Utf8 filename conversion error");
+                return NULL;
+        }
+
+        templates_doc = xmlParseFile (filename);
+        if (!templates_doc)
+        {
+                g_message ("\"%s\" is not a glabels template file (not XML)",
+                      filename);
+                g_free (filename);
+                return NULL;
+        }
+        g_free (filename);
+
+        if (!xml_check_templates_root (templates_doc))
+        {
+                xmlFreeDoc (templates_doc);
+                return NULL;
+        }
+
+        batch = g_new0 (lglTemplateBatch, 1);
+        batch->doc   = templates_doc;
+        batch->items = g_array_new (FALSE, FALSE, sizeof (BatchItem));
+
+        node = xmlDocGetRootElement (templates_doc)->xmlChildrenNode;
+        for (; node != NULL; node = node->next)
+        {
+
+                if (lgl_xml_is_node (node, "Template"))
+                {
+                        item.node     = node;
+                        item.template = NULL;
+
+                        equiv_part = lgl_xml_get_prop_string (node, "equiv", NULL);
+                        if (!equiv_part)
+                        {
+                                item.template = lgl_xml_template_parse_template_node (node);
+                                if (!item.template)
+                                {
+                                        continue;
+                                }
+                        }
+                        g_free (equiv_part);
+
+                        g_array_append_val (batch->items, item);
+                }
+                else
+                {
+                        if ( !xmlNodeIsText(node) )
+                        {
+                                if (!lgl_xml_is_node (node,"comment"))
+                                {
+                                        g_message ("bad node =  \"%s\"",node->name);
+                                }
+                        }
+                }
+        }
+
+        return batch;
+}
+
+
+/*
+ * _lgl_xml_template_batch_register:
+ * @batch:  Batch returned by _lgl_xml_template_batch_read()
+ *
+ * Register the templates of a batch in document order, parsing any deferred
+ * equivalent templates on the way.  Must be called from the thread that
+ * owns the template database.
+ */
+void
+_lgl_xml_template_batch_register (lglTemplateBatch *batch)
+{
+        BatchItem   *item;
+        lglTemplate *template;
+        guint        i;
+
+        for (i = 0; i < batch->items->len; i++)
+        {
+                item = &g_array_index (batch->items, BatchItem, i);
+
+                template = item->template;
+                if (!template)
+                {
+                        template = lgl_xml_template_parse_template_node (item->node);
+                }
+
+                if (template)
+                {
+                        _lgl_db_register_template_internal (template);
+                        lgl_template_free (template);
+                }
+
+                item->template = NULL;
+        }
+}
+
+
+/*
+ * _lgl_xml_template_batch_free:
+ * @batch:  Batch returned by _lgl_xml_template_batch_read()
+ *
+ * Free a batch, including any templates not yet registered.
+ */
+void
+_lgl_xml_template_batch_free (lglTemplateBatch *batch)
+{
+        guint        i;
+
+        if (batch)
+        {
+                for (i = 0; i < batch->items->len; i++)
+                {
+                        lgl_template_free (g_array_index (batch->items, BatchItem, i).template);
+                }
+                g_array_free (batch->items, TRUE);
+                xmlFreeDoc (batch->doc);
+                g_free (batch);
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Check that document is a templates file.                       */
+/*--------------------------------------------------------------------------*/
+static gboolean
+xml_check_templates_root (const xmlDocPtr templates_doc)
+{
+        xmlNodePtr   root;
+
+        root = xmlDocGetRootElement (templates_doc);
+        if (!root || !root->name)
+        {
+                g_message ("\"%s\" is not a glabels template file (no root node)",
+                           templates_doc->URL);
+                return FALSE;
+        }
+        if (!lgl_xml_is_node (root, "Glabels-templates"))
+        {
+                g_message ("\"%s\" is not a glabels template file (wrong root node)",
+                      templates_doc->URL);
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+
 /**
  * lgl_xml_template_parse_template_node:
  * @template_node:  libxml #xmlNodePtr template node from a #xmlDocPtr tree.
@@ -32,7 +32,21 @@
 #define UTF8_EQUAL(s1,s2) (!lgl_str_utf8_casecmp (s1, s2))
 #define ASCII_EQUAL(s1,s2) (!g_ascii_strcasecmp (s1, s2))
 
-void _lgl_db_register_template_internal (const lglTemplate   *template);
+void  _lgl_db_register_template_internal (const lglTemplate   *template);
+
+gchar *_lgl_str_part_name_collate_key     (const gchar         *s);
+gint   _lgl_str_part_name_collate_key_cmp (const gchar         *key1,
+                                           const gchar         *key2);
+
+gchar *_lgl_template_get_geometry_signature (const lglTemplate *template,
+                                             gint               offset1,
+                                             gint               offset2);
+
+typedef struct _lglTemplateBatch lglTemplateBatch;
+
+lglTemplateBatch *_lgl_xml_template_batch_read     (const gchar      *utf8_filename);
+void              _lgl_xml_template_batch_register (lglTemplateBatch *batch);
+void              _lgl_xml_template_batch_free     (lglTemplateBatch *batch);
 
 
 #endif /* __LIBGLABELS_PRIVATE_H__ */
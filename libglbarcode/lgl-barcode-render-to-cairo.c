@@ -67,33 +67,32 @@ void
 lgl_barcode_render_to_cairo (const lglBarcode  *bc,
                              cairo_t           *cr)
 {
-        GList                  *p;
+        lglBarcodeShapeIter           iter;
 
-        lglBarcodeShape        *shape;
-        lglBarcodeShapeLine    *line;
-        lglBarcodeShapeBox     *box;
-        lglBarcodeShapeChar    *bchar;
-        lglBarcodeShapeString  *bstring;
-        lglBarcodeShapeRing    *ring;
-        lglBarcodeShapeHexagon *hexagon;
+        const lglBarcodeShape        *shape;
+        const lglBarcodeShapeLine    *line;
+        const lglBarcodeShapeBox     *box;
+        const lglBarcodeShapeChar    *bchar;
+        const lglBarcodeShapeString  *bstring;
+        const lglBarcodeShapeRing    *ring;
+        const lglBarcodeShapeHexagon *hexagon;
 
-        PangoLayout            *layout;
-        PangoFontDescription   *desc;
-        gchar                  *cstring;
-        gdouble                 x_offset, y_offset;
-        gint                    iw, ih;
-        gdouble                 layout_width;
+        PangoLayout                  *layout;
+        PangoFontDescription         *desc;
+        gchar                        *cstring;
+        gdouble                       x_offset, y_offset;
+        gint                          iw, ih;
+        gdouble                       layout_width;
 
 
-        for (p = bc->shapes; p != NULL; p = p->next) {
-
-                shape = (lglBarcodeShape *)p->data;
+        lgl_barcode_shape_iter_init (&iter, bc);
+        while ( (shape = lgl_barcode_shape_iter_next (&iter)) ) {
 
                 switch (shape->type)
                 {
 
                 case LGL_BARCODE_SHAPE_LINE:
-                        line = (lglBarcodeShapeLine *) shape;
+                        line = (const lglBarcodeShapeLine *) shape;
 
                         cairo_move_to (cr, line->x, line->y);
                         cairo_line_to (cr, line->x, line->y + line->length);
@@ -103,7 +102,7 @@ lgl_barcode_render_to_cairo (const lglBarcode  *bc,
                         break;
 
                 case LGL_BARCODE_SHAPE_BOX:
-                        box = (lglBarcodeShapeBox *) shape;
+                        box = (const lglBarcodeShapeBox *) shape;
 
                         cairo_rectangle (cr, box->x, box->y, box->width, box->height);
                         cairo_fill (cr);
@@ -111,7 +110,7 @@ lgl_barcode_render_to_cairo (const lglBarcode  *bc,
                         break;
 
                 case LGL_BARCODE_SHAPE_CHAR:
-                        bchar = (lglBarcodeShapeChar *) shape;
+                        bchar = (const lglBarcodeShapeChar *) shape;
 
                         layout = pango_cairo_create_layout (cr);
 
@@ -135,7 +134,7 @@ lgl_barcode_render_to_cairo (const lglBarcode  *bc,
                         break;
 
                 case LGL_BARCODE_SHAPE_STRING:
-                        bstring = (lglBarcodeShapeString *) shape;
+                        bstring = (const lglBarcodeShapeString *) shape;
 
                         layout = pango_cairo_create_layout (cr);
 
@@ -161,7 +160,7 @@ lgl_barcode_render_to_cairo (const lglBarcode  *bc,
                         break;
 
                 case LGL_BARCODE_SHAPE_RING:
-                        ring = (lglBarcodeShapeRing *) shape;
+                        ring = (const lglBarcodeShapeRing *) shape;
 
                         cairo_arc (cr, ring->x, ring->y, ring->radius, 0.0, 2 * G_PI);
                         cairo_set_line_width (cr, ring->line_width);
@@ -170,7 +169,7 @@ lgl_barcode_render_to_cairo (const lglBarcode  *bc,
                         break;
 
                 case LGL_BARCODE_SHAPE_HEXAGON:
-                        hexagon = (lglBarcodeShapeHexagon *) shape;
+                        hexagon = (const lglBarcodeShapeHexagon *) shape;
 
                         cairo_move_to (cr, hexagon->x, hexagon->y);
                         cairo_line_to (cr, hexagon->x + 0.433*hexagon->height, hexagon->y + 0.25*hexagon->height);
@@ -212,47 +211,46 @@ void
 lgl_barcode_render_to_cairo_path (const lglBarcode  *bc,
                                   cairo_t           *cr)
 {
-        GList                  *p;
-
-        lglBarcodeShape        *shape;
-        lglBarcodeShapeLine    *line;
-        lglBarcodeShapeBox     *box;
-        lglBarcodeShapeChar    *bchar;
-        lglBarcodeShapeString  *bstring;
-        lglBarcodeShapeRing    *ring;
-        lglBarcodeShapeHexagon *hexagon;
+        lglBarcodeShapeIter           iter;
 
-        PangoLayout            *layout;
-        PangoFontDescription   *desc;
-        gchar                  *cstring;
-        gdouble                 x_offset, y_offset;
-        gint                    iw, ih;
-        gdouble                 layout_width;
+        const lglBarcodeShape        *shape;
+        const lglBarcodeShapeLine    *line;
+        const lglBarcodeShapeBox     *box;
+        const lglBarcodeShapeChar    *bchar;
+        const lglBarcodeShapeString  *bstring;
+        const lglBarcodeShapeRing    *ring;
+        const lglBarcodeShapeHexagon *hexagon;
 
+        PangoLayout                  *layout;
+        PangoFontDescription         *desc;
+        gchar                        *cstring;
+        gdouble                       x_offset, y_offset;
+        gint                          iw, ih;
+        gdouble                       layout_width;
 
-        for (p = bc->shapes; p != NULL; p = p->next) {
 
-                shape = (lglBarcodeShape *)p->data;
+        lgl_barcode_shape_iter_init (&iter, bc);
+        while ( (shape = lgl_barcode_shape_iter_next (&iter)) ) {
 
                 switch (shape->type)
                 {
 
                 case LGL_BARCODE_SHAPE_LINE:
-                        line = (lglBarcodeShapeLine *) shape;
+                        line = (const lglBarcodeShapeLine *) shape;
 
                         cairo_rectangle (cr, line->x - line->width/2, line->y, line->width, line->length);
 
                         break;
 
                 case LGL_BARCODE_SHAPE_BOX:
-                        box = (lglBarcodeShapeBox *) shape;
+                        box = (const lglBarcodeShapeBox *) shape;
 
                         cairo_rectangle (cr, box->x, box->y, box->width, box->height);
 
                         break;
 
                 case LGL_BARCODE_SHAPE_CHAR:
-                        bchar = (lglBarcodeShapeChar *) shape;
+                        bchar = (const lglBarcodeShapeChar *) shape;
 
                         layout = pango_cairo_create_layout (cr);
 
@@ -276,7 +274,7 @@ lgl_barcode_render_to_cairo_path (const lglBarcode  *bc,
                         break;
 
                 case LGL_BARCODE_SHAPE_STRING:
-                        bstring = (lglBarcodeShapeString *) shape;
+                        bstring = (const lglBarcodeShapeString *) shape;
 
                         layout = pango_cairo_create_layout (cr);
 
@@ -302,7 +300,7 @@ lgl_barcode_render_to_cairo_path (const lglBarcode  *bc,
                         break;
 
                 case LGL_BARCODE_SHAPE_RING:
-                        ring = (lglBarcodeShapeRing *) shape;
+                        ring = (const lglBarcodeShapeRing *) shape;
 
                         cairo_new_sub_path (cr);
                         cairo_arc (cr, ring->x, ring->y, ring->radius + ring->line_width/2, 0.0, 2 * G_PI);
@@ -313,7 +311,7 @@ lgl_barcode_render_to_cairo_path (const lglBarcode  *bc,
                         break;
 
                 case LGL_BARCODE_SHAPE_HEXAGON:
-                        hexagon = (lglBarcodeShapeHexagon *) shape;
+                        hexagon = (const lglBarcodeShapeHexagon *) shape;
 
                         cairo_move_to (cr, hexagon->x, hexagon->y);
                         cairo_line_to (cr, hexagon->x + 0.433*hexagon->height, hexagon->y + 0.25*hexagon->height);
@@ -22,30 +22,62 @@
 
 #include "lgl-barcode.h"
 
+#include <string.h>
+
 
 /*========================================================*/
 /* Private macros and constants.                          */
 /*========================================================*/
 
+#define N_SHAPE_TYPES       (LGL_BARCODE_SHAPE_HEXAGON + 1)
+
+#define INITIAL_N_SHAPES    64
+#define STRING_CHUNK_SIZE   256
+
 
 /*========================================================*/
 /* Private types.                                         */
 /*========================================================*/
 
+/*
+ * Shapes are stored by value in one growable array per shape type, and the
+ * text of string shapes lives in a single string chunk.  A barcode with
+ * thousands of modules thus costs a handful of allocations instead of two
+ * (shape + list node) per module.  The public lglBarcode must be first so
+ * that a pointer to it is also a pointer to this structure.
+ */
+typedef struct {
+
+        lglBarcode    bc;
+
+        GArray       *shapes[N_SHAPE_TYPES];
+        GStringChunk *strings;
+
+} lglBarcodePrivate;
+
+#define LGL_BARCODE_PRIVATE(bc) ((lglBarcodePrivate *)(bc))
+
 
 /*========================================================*/
 /* Private globals.                                       */
 /*========================================================*/
 
+static const gsize shape_size[N_SHAPE_TYPES] = {
+        sizeof (lglBarcodeShapeLine),
+        sizeof (lglBarcodeShapeBox),
+        sizeof (lglBarcodeShapeChar),
+        sizeof (lglBarcodeShapeString),
+        sizeof (lglBarcodeShapeRing),
+        sizeof (lglBarcodeShapeHexagon)
+};
+
 
 /*========================================================*/
 /* Private function prototypes.                           */
 /*========================================================*/
 
-static void lgl_barcode_add_shape        (lglBarcode      *bc,
-                                          lglBarcodeShape *shape);
-
-static void lgl_barcode_shape_free       (lglBarcodeShape *shape);
+static gpointer lgl_barcode_add_shape    (lglBarcode          *bc,
+                                          lglBarcodeShapeType  type);
 
 
 /*****************************************************************************/
@@ -54,7 +86,9 @@ static void lgl_barcode_shape_free       (lglBarcodeShape *shape);
  *
  * Allocate a new #lglBarcode structure.
  *
- * This function allocates a new #lglBarcode structure.
+ * This function allocates a new #lglBarcode structure.  This is the only
+ * way to obtain one, since the structure is followed by private storage for
+ * its drawing primitives.
  * 
  * <note><para>
  *       This function is intended to be used internally by barcode implementations.
@@ -69,7 +103,9 @@ static void lgl_barcode_shape_free       (lglBarcodeShape *shape);
 lglBarcode *
 lgl_barcode_new (void)
 {
-        return g_new0 (lglBarcode, 1);
+        lglBarcodePrivate *priv = g_new0 (lglBarcodePrivate, 1);
+
+        return &priv->bc;
 }
 
 
@@ -84,18 +120,26 @@ lgl_barcode_new (void)
 void
 lgl_barcode_free (lglBarcode *bc)
 {
-        GList *p;
+        lglBarcodePrivate *priv = LGL_BARCODE_PRIVATE (bc);
+        gint               i;
 
         if (bc != NULL)
         {
 
-                for (p = bc->shapes; p != NULL; p = p->next)
+                for (i = 0; i < N_SHAPE_TYPES; i++)
+                {
+                        if (priv->shapes[i] != NULL)
+                        {
+                                g_array_free (priv->shapes[i], TRUE);
+                        }
+                }
+                if (priv->strings != NULL)
                 {
-                        lgl_barcode_shape_free ((lglBarcodeShape *)p->data);
+                        g_string_chunk_free (priv->strings);
                 }
                 g_list_free (bc->shapes);
 
-                g_free (bc);
+                g_free (priv);
 
         }
 }
@@ -125,15 +169,14 @@ lgl_barcode_add_line (lglBarcode      *bc,
                       gdouble          length,
                       gdouble          width)
 {
-        lglBarcodeShapeLine *line_shape = g_new0 (lglBarcodeShapeLine, 1);
-        line_shape->type = LGL_BARCODE_SHAPE_LINE;
+        lglBarcodeShapeLine *line_shape = lgl_barcode_add_shape (bc, LGL_BARCODE_SHAPE_LINE);
+
+        g_return_if_fail (line_shape);
 
         line_shape->x      = x;
         line_shape->y      = y;
         line_shape->length = length;
         line_shape->width  = width;
-
-        lgl_barcode_add_shape (bc, (lglBarcodeShape *)line_shape);
 }
 
 
@@ -161,15 +204,14 @@ lgl_barcode_add_box (lglBarcode      *bc,
                      gdouble          width,
                      gdouble          height)
 {
-        lglBarcodeShapeBox *box_shape = g_new0 (lglBarcodeShapeBox, 1);
-        box_shape->type = LGL_BARCODE_SHAPE_BOX;
+        lglBarcodeShapeBox *box_shape = lgl_barcode_add_shape (bc, LGL_BARCODE_SHAPE_BOX);
+
+        g_return_if_fail (box_shape);
 
         box_shape->x      = x;
         box_shape->y      = y;
         box_shape->width  = width;
         box_shape->height = height;
-
-        lgl_barcode_add_shape (bc, (lglBarcodeShape *)box_shape);
 }
 
 
@@ -197,15 +239,14 @@ lgl_barcode_add_char (lglBarcode      *bc,
                       gdouble          fsize,
                       gchar            c)
 {
-        lglBarcodeShapeChar *char_shape = g_new0 (lglBarcodeShapeChar, 1);
-        char_shape->type = LGL_BARCODE_SHAPE_CHAR;
+        lglBarcodeShapeChar *char_shape = lgl_barcode_add_shape (bc, LGL_BARCODE_SHAPE_CHAR);
+
+        g_return_if_fail (char_shape);
 
         char_shape->x      = x;
         char_shape->y      = y;
         char_shape->fsize  = fsize;
         char_shape->c      = c;
-
-        lgl_barcode_add_shape (bc, (lglBarcodeShape *)char_shape);
 }
 
 
@@ -235,15 +276,28 @@ lgl_barcode_add_string (lglBarcode      *bc,
                         gchar           *string,
                         gsize            length)
 {
-        lglBarcodeShapeString *string_shape = g_new0 (lglBarcodeShapeString, 1);
-        string_shape->type = LGL_BARCODE_SHAPE_STRING;
+        lglBarcodePrivate     *priv = LGL_BARCODE_PRIVATE (bc);
+        lglBarcodeShapeString *string_shape = lgl_barcode_add_shape (bc, LGL_BARCODE_SHAPE_STRING);
+        const gchar           *nul;
+
+        g_return_if_fail (string_shape);
+
+        if (priv->strings == NULL)
+        {
+                priv->strings = g_string_chunk_new (STRING_CHUNK_SIZE);
+        }
+
+        /* Like g_strndup(), stop at an embedded NUL. */
+        nul = memchr (string, '\0', length);
+        if (nul != NULL)
+        {
+                length = nul - string;
+        }
 
         string_shape->x      = x;
         string_shape->y      = y;
         string_shape->fsize  = fsize;
-        string_shape->string = g_strndup(string, length);
-
-        lgl_barcode_add_shape (bc, (lglBarcodeShape *)string_shape);
+        string_shape->string = g_string_chunk_insert_len (priv->strings, string, length);
 }
 
 /*****************************************************************************/
@@ -270,15 +324,14 @@ lgl_barcode_add_ring (lglBarcode      *bc,
                       gdouble          radius,
                       gdouble          line_width)
 {
-        lglBarcodeShapeRing *ring_shape = g_new0 (lglBarcodeShapeRing, 1);
-        ring_shape->type = LGL_BARCODE_SHAPE_RING;
+        lglBarcodeShapeRing *ring_shape = lgl_barcode_add_shape (bc, LGL_BARCODE_SHAPE_RING);
+
+        g_return_if_fail (ring_shape);
 
         ring_shape->x          = x;
         ring_shape->y          = y;
         ring_shape->radius     = radius;
         ring_shape->line_width = line_width;
-
-        lgl_barcode_add_shape (bc, (lglBarcodeShape *)ring_shape);
 }
 
 /*****************************************************************************/
@@ -304,52 +357,173 @@ lgl_barcode_add_hexagon (lglBarcode      *bc,
                          gdouble          y,
                          gdouble          height)
 {
-        lglBarcodeShapeHexagon *hexagon_shape = g_new0 (lglBarcodeShapeHexagon, 1);
-        hexagon_shape->type = LGL_BARCODE_SHAPE_HEXAGON;
+        lglBarcodeShapeHexagon *hexagon_shape = lgl_barcode_add_shape (bc, LGL_BARCODE_SHAPE_HEXAGON);
+
+        g_return_if_fail (hexagon_shape);
 
         hexagon_shape->x      = x;
         hexagon_shape->y      = y;
         hexagon_shape->height = height;
-
-        lgl_barcode_add_shape (bc, (lglBarcodeShape *)hexagon_shape);
 }
 
 
 /*****************************************************************************/
-/* Add shape to barcode.                                                     */
+/**
+ * lgl_barcode_get_n_shapes:
+ * @bc:     An #lglBarcode structure
+ *
+ * Get the number of drawing primitives in barcode.
+ *
+ * Returns: Number of shapes.
+ *
+ */
+guint
+lgl_barcode_get_n_shapes (const lglBarcode *bc)
+{
+        lglBarcodePrivate *priv = LGL_BARCODE_PRIVATE (bc);
+        guint              n = 0;
+        gint               i;
+
+        g_return_val_if_fail (bc, 0);
+
+        for (i = 0; i < N_SHAPE_TYPES; i++)
+        {
+                if (priv->shapes[i] != NULL)
+                {
+                        n += priv->shapes[i]->len;
+                }
+        }
+
+        return n;
+}
+
+
 /*****************************************************************************/
-static void
-lgl_barcode_add_shape (lglBarcode      *bc,
-                       lglBarcodeShape *shape)
+/**
+ * lgl_barcode_shape_iter_init:
+ * @iter:   An uninitialized #lglBarcodeShapeIter
+ * @bc:     An #lglBarcode structure
+ *
+ * Initialize an iterator over the drawing primitives of barcode.  Shapes are
+ * visited grouped by type, in the order they were added within each type.
+ * The iterator is invalidated if shapes are added to barcode.
+ *
+ */
+void
+lgl_barcode_shape_iter_init (lglBarcodeShapeIter *iter,
+                             const lglBarcode    *bc)
 {
+        g_return_if_fail (iter);
         g_return_if_fail (bc);
-        g_return_if_fail (shape);
 
-        bc->shapes = g_list_prepend (bc->shapes, shape);
+        iter->bc   = bc;
+        iter->type = 0;
+        iter->i    = 0;
 }
 
 
 /*****************************************************************************/
-/* Free a shape primitive.                                                   */
-/*****************************************************************************/
-static void
-lgl_barcode_shape_free (lglBarcodeShape *shape)
+/**
+ * lgl_barcode_shape_iter_next:
+ * @iter:   An #lglBarcodeShapeIter
+ *
+ * Advance iterator.
+ *
+ * Returns: The next shape, or %NULL if there are no more shapes.  The shape
+ *          is owned by the barcode.  Only the member of the #lglBarcodeShape
+ *          union matching its type may be accessed.
+ *
+ */
+const lglBarcodeShape *
+lgl_barcode_shape_iter_next (lglBarcodeShapeIter *iter)
 {
-        switch (shape->type)
+        lglBarcodePrivate *priv;
+        GArray            *array;
+
+        g_return_val_if_fail (iter, NULL);
+
+        priv = LGL_BARCODE_PRIVATE (iter->bc);
+
+        for ( ; iter->type < N_SHAPE_TYPES; iter->type++, iter->i = 0 )
         {
+                array = priv->shapes[iter->type];
+
+                if ( (array != NULL) && (iter->i < array->len) )
+                {
+                        return (const lglBarcodeShape *)(array->data + (iter->i++ * shape_size[iter->type]));
+                }
+        }
+
+        return NULL;
+}
+
 
-        case LGL_BARCODE_SHAPE_STRING:
-                g_free (shape->string.string);
-                break;
+/*****************************************************************************/
+/**
+ * lgl_barcode_get_shapes:
+ * @bc:     An #lglBarcode structure
+ *
+ * Get drawing primitives as a list.  This is a compatibility interface for
+ * code written against the shapes list of earlier versions; new code should
+ * use lgl_barcode_shape_iter_init() instead.  The list is cached in the
+ * @shapes member of barcode until shapes are added or barcode is freed.
+ *
+ * Returns: A #GList of #lglBarcodeShape pointers, owned by the barcode.
+ *
+ */
+GList *
+lgl_barcode_get_shapes (lglBarcode *bc)
+{
+        lglBarcodeShapeIter    iter;
+        const lglBarcodeShape *shape;
+        GList                 *list = NULL;
+
+        g_return_val_if_fail (bc, NULL);
 
-        default:
-                break;
+        if ( (bc->shapes == NULL) && (lgl_barcode_get_n_shapes (bc) > 0) )
+        {
+                lgl_barcode_shape_iter_init (&iter, bc);
+                while ( (shape = lgl_barcode_shape_iter_next (&iter)) )
+                {
+                        list = g_list_prepend (list, (gpointer)shape);
+                }
+                bc->shapes = g_list_reverse (list);
         }
 
-        g_free (shape);
+        return bc->shapes;
 }
 
 
+/*****************************************************************************/
+/* Add shape of given type to barcode.  Returns the new zeroed shape.        */
+/*****************************************************************************/
+static gpointer
+lgl_barcode_add_shape (lglBarcode          *bc,
+                       lglBarcodeShapeType  type)
+{
+        lglBarcodePrivate  *priv = LGL_BARCODE_PRIVATE (bc);
+        lglBarcodeShapeAny *shape;
+        GArray             *array;
+
+        g_return_val_if_fail (bc, NULL);
+
+        if (priv->shapes[type] == NULL)
+        {
+                priv->shapes[type] = g_array_sized_new (FALSE, TRUE, shape_size[type], INITIAL_N_SHAPES);
+        }
+        array = priv->shapes[type];
+
+        /* Growing the array may move existing shapes, drop any cached list. */
+        g_list_free (bc->shapes);
+        bc->shapes = NULL;
+
+        g_array_set_size (array, array->len + 1);
+
+        shape = (lglBarcodeShapeAny *)(array->data + ((array->len - 1) * shape_size[type]));
+        shape->type = type;
+
+        return shape;
+}
 
 
 /*
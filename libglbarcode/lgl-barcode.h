@@ -34,7 +34,8 @@ G_BEGIN_DECLS
  * lglBarcode:
  *  @width:    Width of barcode bounding box (points)
  *  @height:   Height of barcode bounding box (points)
- *  @shapes:   List of #lglBarcodeShape drawing primitives
+ *  @shapes:   Cached list of #lglBarcodeShape drawing primitives, only valid
+ *             after calling lgl_barcode_get_shapes()
  *
  * This structure contains the libglbarcode intermediate barcode format.  This
  * structure contains a simple vectorized representation of the barcode.  This
@@ -42,13 +43,20 @@ G_BEGIN_DECLS
  * either vector or raster formats.  A simple API is provided for constructing
  * barcodes in this format.
  *
+ * <note><para>
+ *       Since libglbarcode-3.0 interface 1, an #lglBarcode must be allocated
+ *       with lgl_barcode_new(), never declared or allocated directly, and
+ *       @shapes is %NULL until lgl_barcode_get_shapes() is called.  Renderers
+ *       should visit the drawing primitives with an #lglBarcodeShapeIter.
+ * </para></note>
+ *
  */
 typedef struct {
 
         gdouble  width;
         gdouble  height;
 
-        GList   *shapes;    /* List of lglBarcodeShape drawing primitives */
+        GList   *shapes;    /* See lgl_barcode_get_shapes() */
 
 } lglBarcode;
 
@@ -399,6 +407,37 @@ typedef union {
 } lglBarcodeShape;
 
 
+/*******************************/
+/* Barcode Shape Access.       */
+/*******************************/
+
+/**
+ * lglBarcodeShapeIter:
+ *
+ * An iterator over the drawing primitives of an #lglBarcode.  All fields are
+ * private.  Iterators are stack allocated and initialized with
+ * lgl_barcode_shape_iter_init().
+ */
+typedef struct {
+
+        /*< private >*/
+        const lglBarcode    *bc;
+        gint                 type;
+        guint                i;
+
+} lglBarcodeShapeIter;
+
+
+guint                  lgl_barcode_get_n_shapes     (const lglBarcode    *bc);
+
+void                   lgl_barcode_shape_iter_init  (lglBarcodeShapeIter *iter,
+                                                     const lglBarcode    *bc);
+
+const lglBarcodeShape *lgl_barcode_shape_iter_next  (lglBarcodeShapeIter *iter);
+
+GList                 *lgl_barcode_get_shapes       (lglBarcode          *bc);
+
+
 G_END_DECLS
 
 #endif /* __LGL_BARCODE_H__ */
@@ -51,9 +51,21 @@ typedef lglBarcode *(*glBarcodeNewFunc) (const gchar    *id,
                                          const gchar    *digits);
 
 
+typedef gint (*glBarcodeLookupFunc) (const gchar    *id);
+
+typedef lglBarcode *(*glBarcodeSymbologyNewFunc) (gint            symbology,
+                                                  gboolean        text_flag,
+                                                  gboolean        checksum_flag,
+                                                  gdouble         w,
+                                                  gdouble         h,
+                                                  const gchar    *digits);
+
+
 typedef struct {
-        gchar            *id;
-        gchar            *name;
+        gchar                     *id;
+        gchar                     *name;
+        glBarcodeLookupFunc        lookup;
+        glBarcodeSymbologyNewFunc  new_symbology;
 } Backend;
 
 
@@ -72,27 +84,36 @@ typedef struct {
 } Style;
 
 
+struct _glBarcodeStyleHandle {
+        const Backend    *backend;
+        const Style      *style;
+        gint              symbology;
+};
+
+
 /*========================================================*/
 /* Private globals.                                       */
 /*========================================================*/
 
 static const Backend backends[] = {
 
-        { "built-in",    N_("Built-in") },
+        { "built-in",    N_("Built-in"),
+          gl_barcode_builtin_lookup, gl_barcode_builtin_new_symbology },
 #ifdef HAVE_LIBBARCODE
-        { "gnu-barcode", "GNU Barcode" },
+        { "gnu-barcode", "GNU Barcode", NULL, NULL },
 #endif
 #ifdef HAVE_LIBZINT
-        { "zint",        "Zint" },
+        { "zint",        "Zint",
+          gl_barcode_zint_lookup, gl_barcode_zint_new_symbology },
 #endif
 #ifdef HAVE_LIBIEC16022
-        { "libiec16022", "IEC16022" },
+        { "libiec16022", "IEC16022", NULL, NULL },
 #endif
 #ifdef HAVE_LIBQRENCODE
-        { "libqrencode", "QREncode" },
+        { "libqrencode", "QREncode", NULL, NULL },
 #endif
 
-        { NULL, NULL }
+        { NULL, NULL, NULL, NULL }
 };
 
 
@@ -428,6 +449,10 @@ static const Style styles[] = {
 };
 
 
+/* Resolved handles, one per entry in styles[].  Built once on first use. */
+static glBarcodeStyleHandle *handles = NULL;
+
+
 /*========================================================*/
 /* Private function prototypes.                           */
 /*========================================================*/
@@ -439,6 +464,8 @@ static gint style_id_to_index     (const gchar *backend_id,
 static gint style_name_to_index   (const gchar *backend_id,
                                    const gchar *name);
 
+static const glBarcodeStyleHandle *get_handles (void);
+
 /*---------------------------------------------------------------------------*/
 /* Convert backend id to index into backends table.                          */
 /*---------------------------------------------------------------------------*/
@@ -575,6 +602,54 @@ style_name_to_index (const gchar *backend_id,
 }
 
 
+/*---------------------------------------------------------------------------*/
+/* Build table of resolved style handles, parallel to styles table.          */
+/*---------------------------------------------------------------------------*/
+static const glBarcodeStyleHandle *
+get_handles (void)
+{
+        static gsize          init = 0;
+        glBarcodeStyleHandle *table;
+        gint                  n, i, j;
+
+        if (g_once_init_enter (&init))
+        {
+                for (n=0; styles[n].id != NULL; n++);
+
+                table = g_new0 (glBarcodeStyleHandle, n);
+
+                for (i=0; i < n; i++)
+                {
+                        table[i].style = &styles[i];
+
+                        for (j=0; backends[j].id != NULL; j++)
+                        {
+                                if (g_ascii_strcasecmp (styles[i].backend_id, backends[j].id) == 0)
+                                {
+                                        table[i].backend = &backends[j];
+                                        break;
+                                }
+                        }
+
+                        if ( table[i].backend && table[i].backend->lookup )
+                        {
+                                table[i].symbology = table[i].backend->lookup (styles[i].id);
+                        }
+                        else
+                        {
+                                table[i].symbology = -1;
+                        }
+                }
+
+                handles = table;
+
+                g_once_init_leave (&init, 1);
+        }
+
+        return handles;
+}
+
+
 /*****************************************************************************/
 /* Get a list of names for configured backends.                              */
 /*****************************************************************************/
@@ -838,21 +913,109 @@ gl_barcode_backends_new_barcode (const gchar    *backend_id,
                                  gdouble         h,
                                  const gchar    *digits)
 {
-        lglBarcode *gbc;
-        gint        i;
+        g_return_val_if_fail (digits!=NULL, NULL);
+
+        return gl_barcode_backends_handle_new_barcode (gl_barcode_backends_resolve_style (backend_id, id),
+                                                       text_flag,
+                                                       checksum_flag,
+                                                       w,
+                                                       h,
+                                                       digits);
+}
+
+
+/*****************************************************************************/
+/* Resolve style ids to a handle.  The handle is owned by the backends       */
+/* module and stays valid for the life of the program, so callers can look   */
+/* it up once when a style is set instead of matching strings per barcode.   */
+/*****************************************************************************/
+const glBarcodeStyleHandle *
+gl_barcode_backends_resolve_style (const gchar *backend_id,
+                                   const gchar *id)
+{
+        return &get_handles ()[style_id_to_index (backend_id, id)];
+}
+
+
+/*****************************************************************************/
+/* Query resolved style handle.                                              */
+/*****************************************************************************/
+gchar *
+gl_barcode_backends_handle_default_digits (const glBarcodeStyleHandle *handle,
+                                           guint                       n)
+{
+        g_return_val_if_fail (handle != NULL, NULL);
+
+        if (handle->style->can_freeform)
+        {
+                return g_strnfill (MAX (n,1), '0');
+        }
+        else
+        {
+                return g_strdup (handle->style->default_digits);
+        }
+}
+
+
+gboolean
+gl_barcode_backends_handle_can_text (const glBarcodeStyleHandle *handle)
+{
+        g_return_val_if_fail (handle != NULL, FALSE);
+
+        return handle->style->can_text;
+}
+
+
+gboolean
+gl_barcode_backends_handle_can_csum (const glBarcodeStyleHandle *handle)
+{
+        g_return_val_if_fail (handle != NULL, FALSE);
+
+        return handle->style->can_checksum;
+}
+
+
+guint
+gl_barcode_backends_handle_get_prefered_n (const glBarcodeStyleHandle *handle)
+{
+        g_return_val_if_fail (handle != NULL, 0);
 
+        return handle->style->prefered_n;
+}
+
+
+/*****************************************************************************/
+/* Create barcode in intermediate format from a resolved style handle.       */
+/*****************************************************************************/
+lglBarcode *
+gl_barcode_backends_handle_new_barcode (const glBarcodeStyleHandle *handle,
+                                        gboolean                    text_flag,
+                                        gboolean                    checksum_flag,
+                                        gdouble                     w,
+                                        gdouble                     h,
+                                        const gchar                *digits)
+{
+        g_return_val_if_fail (handle != NULL, NULL);
         g_return_val_if_fail (digits!=NULL, NULL);
 
-        i = style_id_to_index (backend_id, id);
+        gl_stats_inc (GL_STATS_BARCODES_BUILT);
 
-        gbc = styles[i].new_barcode (styles[i].id,
-                                     text_flag,
-                                     checksum_flag,
-                                     w,
-                                     h,
-                                     digits);
+        if ( handle->backend && handle->backend->new_symbology )
+        {
+                return handle->backend->new_symbology (handle->symbology,
+                                                       text_flag,
+                                                       checksum_flag,
+                                                       w,
+                                                       h,
+                                                       digits);
+        }
 
-        return gbc;
+        return handle->style->new_barcode (handle->style->id,
+                                           text_flag,
+                                           checksum_flag,
+                                           w,
+                                           h,
+                                           digits);
 }
 
 
@@ -27,6 +27,9 @@
 G_BEGIN_DECLS
 
 
+typedef struct _glBarcodeStyleHandle glBarcodeStyleHandle;
+
+
 GList           *gl_barcode_backends_get_backend_list     (void);
 void             gl_barcode_backends_free_backend_list    (GList          *backend_list);
 
@@ -72,6 +75,23 @@ lglBarcode      *gl_barcode_backends_new_barcode          (const gchar    *backe
                                                            const gchar    *digits);
 
 
+const glBarcodeStyleHandle *gl_barcode_backends_resolve_style  (const gchar                *backend_id,
+                                                                const gchar                *id);
+
+gchar           *gl_barcode_backends_handle_default_digits (const glBarcodeStyleHandle *handle,
+                                                            guint                       n);
+gboolean         gl_barcode_backends_handle_can_text       (const glBarcodeStyleHandle *handle);
+gboolean         gl_barcode_backends_handle_can_csum       (const glBarcodeStyleHandle *handle);
+guint            gl_barcode_backends_handle_get_prefered_n (const glBarcodeStyleHandle *handle);
+
+lglBarcode      *gl_barcode_backends_handle_new_barcode    (const glBarcodeStyleHandle *handle,
+                                                            gboolean                    text_flag,
+                                                            gboolean                    checksum_flag,
+                                                            gdouble                     w,
+                                                            gdouble                     h,
+                                                            const gchar                *digits);
+
+
 
 
 G_END_DECLS
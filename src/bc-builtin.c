@@ -36,14 +36,31 @@
 
 
 /*===========================================*/
-/* Private globals                           */
+/* Private types                             */
 /*===========================================*/
 
+typedef struct {
+        gchar           *id;
+        lglBarcodeType   type;
+} Symbology;
+
 
 /*===========================================*/
-/* Local function prototypes                 */
+/* Private globals                           */
 /*===========================================*/
 
+static const Symbology symbologies[] = {
+        { "POSTNET",    LGL_BARCODE_TYPE_POSTNET },
+        { "POSTNET-5",  LGL_BARCODE_TYPE_POSTNET_5 },
+        { "POSTNET-9",  LGL_BARCODE_TYPE_POSTNET_9 },
+        { "POSTNET-11", LGL_BARCODE_TYPE_POSTNET_11 },
+        { "CEPNET",     LGL_BARCODE_TYPE_CEPNET },
+        { "ONECODE",    LGL_BARCODE_TYPE_ONECODE },
+        { "Code39",     LGL_BARCODE_TYPE_CODE39 },
+        { "Code39Ext",  LGL_BARCODE_TYPE_CODE39_EXT },
+        { NULL, 0 }
+};
+
 
 /****************************************************************************/
 /* Generate list of lines that form the barcode for the given digits.       */
@@ -56,44 +73,51 @@ gl_barcode_builtin_new (const gchar    *id,
                         gdouble         h,
                         const gchar    *digits)
 {
-        if ( (g_ascii_strcasecmp (id, "POSTNET") == 0) )
-        {
-                return lgl_barcode_create (LGL_BARCODE_TYPE_POSTNET, text_flag, checksum_flag, w, h, digits);
-        }
-        if ( (g_ascii_strcasecmp (id, "POSTNET-5") == 0) )
-        {
-                return lgl_barcode_create (LGL_BARCODE_TYPE_POSTNET_5, text_flag, checksum_flag, w, h, digits);
-        }
-        if ( (g_ascii_strcasecmp (id, "POSTNET-9") == 0) )
-        {
-                return lgl_barcode_create (LGL_BARCODE_TYPE_POSTNET_9, text_flag, checksum_flag, w, h, digits);
-        }
-        if ( (g_ascii_strcasecmp (id, "POSTNET-11") == 0) )
-        {
-                return lgl_barcode_create (LGL_BARCODE_TYPE_POSTNET_11, text_flag, checksum_flag, w, h, digits);
-        }
-        if ( (g_ascii_strcasecmp (id, "CEPNET") == 0) )
-        {
-                return lgl_barcode_create (LGL_BARCODE_TYPE_CEPNET, text_flag, checksum_flag, w, h, digits);
-        }
-        if ( (g_ascii_strcasecmp (id, "ONECODE") == 0) )
-        {
-                return lgl_barcode_create (LGL_BARCODE_TYPE_ONECODE, text_flag, checksum_flag, w, h, digits);
-        }
-        if ( (g_ascii_strcasecmp (id, "Code39") == 0) )
-        {
-                return lgl_barcode_create (LGL_BARCODE_TYPE_CODE39, text_flag, checksum_flag, w, h, digits);
-        }
-        if ( (g_ascii_strcasecmp (id, "Code39Ext") == 0) )
+        return gl_barcode_builtin_new_symbology (gl_barcode_builtin_lookup (id),
+                                                 text_flag, checksum_flag, w, h, digits);
+}
+
+
+/****************************************************************************/
+/* Resolve id to a symbology code for gl_barcode_builtin_new_symbology().   */
+/****************************************************************************/
+gint
+gl_barcode_builtin_lookup (const gchar    *id)
+{
+        gint i;
+
+        for (i=0; symbologies[i].id != NULL; i++)
         {
-                return lgl_barcode_create (LGL_BARCODE_TYPE_CODE39_EXT, text_flag, checksum_flag, w, h, digits);
+                if (g_ascii_strcasecmp (id, symbologies[i].id) == 0)
+                {
+                        return i;
+                }
         }
 
         g_message ("Invalid builtin barcode ID: \"%s\"\n", id);
-        return NULL;
+        return -1;
 }
 
 
+/****************************************************************************/
+/* Generate barcode for an already resolved symbology code.                 */
+/****************************************************************************/
+lglBarcode *
+gl_barcode_builtin_new_symbology (gint            symbology,
+                                  gboolean        text_flag,
+                                  gboolean        checksum_flag,
+                                  gdouble         w,
+                                  gdouble         h,
+                                  const gchar    *digits)
+{
+        if ( (symbology < 0) || (symbology >= (gint)G_N_ELEMENTS (symbologies) - 1) )
+        {
+                return NULL;
+        }
+
+        return lgl_barcode_create (symbologies[symbology].type, text_flag, checksum_flag, w, h, digits);
+}
+
 
 /*
  * Local Variables:       -- emacs
@@ -33,6 +33,15 @@ lglBarcode *gl_barcode_builtin_new (const gchar    *id,
                                     gdouble         h,
                                     const gchar    *digits);
 
+gint        gl_barcode_builtin_lookup (const gchar    *id);
+
+lglBarcode *gl_barcode_builtin_new_symbology (gint            symbology,
+                                              gboolean        text_flag,
+                                              gboolean        checksum_flag,
+                                              gdouble         w,
+                                              gdouble         h,
+                                              const gchar    *digits);
+
 G_END_DECLS
 
 #endif /* __BC_BUILTIN_H__ */
@@ -39,6 +39,94 @@
 #define DEFAULT_H  72
 
 
+/*========================================================*/
+/* Private types.                                         */
+/*========================================================*/
+
+typedef struct {
+        gchar    *id;
+        gint      symbology;
+        gboolean  gs1_flag;
+} Symbology;
+
+
+/*========================================================*/
+/* Private globals.                                       */
+/*========================================================*/
+
+static const Symbology symbologies[] = {
+        { "AUSP",     BARCODE_AUSPOST,           FALSE },
+        { "AUSRP",    BARCODE_AUSREPLY,          FALSE },
+        { "AUSRT",    BARCODE_AUSROUTE,          FALSE },
+        { "AUSRD",    BARCODE_AUSREDIRECT,       FALSE },
+        { "AZTEC",    BARCODE_AZTEC,             FALSE },
+        { "AZRUN",    BARCODE_AZRUNE,            FALSE },
+        { "CBR",      BARCODE_CODABAR,           FALSE },
+        { "Code1",    BARCODE_CODEONE,           FALSE },
+        { "Code11",   BARCODE_CODE11,            FALSE },
+        { "C16K",     BARCODE_CODE16K,           FALSE },
+        { "C25M",     BARCODE_C25MATRIX,         FALSE },
+        { "C25I",     BARCODE_C25IATA,           FALSE },
+        { "C25DL",    BARCODE_C25LOGIC,          FALSE },
+        { "Code32",   BARCODE_CODE32,            FALSE },
+        { "Code39",   BARCODE_CODE39,            FALSE },
+        { "Code39E",  BARCODE_EXCODE39,          FALSE },
+        { "Code49",   BARCODE_CODE49,            FALSE },
+        { "Code93",   BARCODE_CODE93,            FALSE },
+        { "Code128",  BARCODE_CODE128,           FALSE },
+        { "Code128B", BARCODE_CODE128B,          FALSE },
+        { "DAFT",     BARCODE_DAFT,              FALSE },
+        { "DMTX",     BARCODE_DATAMATRIX,        FALSE },
+        { "DMTX-GS1", BARCODE_DATAMATRIX,        TRUE },
+        { "DPL",      BARCODE_DPLEIT,            FALSE },
+        { "DPI",      BARCODE_DPIDENT,           FALSE },
+        { "KIX",      BARCODE_KIX,               FALSE },
+        { "EAN",      BARCODE_EANX,              FALSE },
+        { "HIBC128",  BARCODE_HIBC_128,          FALSE },
+        { "HIBC39",   BARCODE_HIBC_39,           FALSE },
+        { "HIBCDM",   BARCODE_HIBC_DM,           FALSE },
+        { "HIBCQR",   BARCODE_HIBC_QR,           FALSE },
+        { "HIBCPDF",  BARCODE_HIBC_MICPDF,       FALSE },
+        { "HIBCMPDF", BARCODE_HIBC_AZTEC,        FALSE },
+        { "HIBCAZ",   BARCODE_C25INTER,          FALSE },
+        { "I25",      BARCODE_C25INTER,          FALSE },
+        { "ISBN",     BARCODE_ISBNX,             FALSE },
+        { "ITF14",    BARCODE_ITF14,             FALSE },
+        { "GMTX",     BARCODE_GRIDMATRIX,        FALSE },
+        { "GS1-128",  BARCODE_EAN128,            FALSE },
+        { "LOGM",     BARCODE_LOGMARS,           FALSE },
+        { "RSS14",    BARCODE_RSS14,             FALSE },
+        { "RSSLTD",   BARCODE_RSS_LTD,           FALSE },
+        { "RSSEXP",   BARCODE_RSS_EXP,           FALSE },
+        { "RSSS",     BARCODE_RSS14STACK,        FALSE },
+        { "RSSSO",    BARCODE_RSS14STACK_OMNI,   FALSE },
+        { "RSSSE",    BARCODE_RSS_EXPSTACK,      FALSE },
+        { "PHARMA",   BARCODE_PHARMA,            FALSE },
+        { "PHARMA2",  BARCODE_PHARMA_TWO,        FALSE },
+        { "PZN",      BARCODE_PZN,               FALSE },
+        { "TELE",     BARCODE_TELEPEN,           FALSE },
+        { "TELEX",    BARCODE_TELEPEN_NUM,       FALSE },
+        { "JAPAN",    BARCODE_JAPANPOST,         FALSE },
+        { "KOREA",    BARCODE_KOREAPOST,         FALSE },
+        { "MAXI",     BARCODE_MAXICODE,          FALSE },
+        { "MPDF",     BARCODE_MICROPDF417,       FALSE },
+        { "MSI",      BARCODE_MSI_PLESSEY,       FALSE },
+        { "MQR",      BARCODE_MICROQR,           FALSE },
+        { "NVE",      BARCODE_NVE18,             FALSE },
+        { "PLAN",     BARCODE_PLANET,            FALSE },
+        { "POSTNET",  BARCODE_POSTNET,           FALSE },
+        { "PDF",      BARCODE_PDF417,            FALSE },
+        { "PDFT",     BARCODE_PDF417TRUNC,       FALSE },
+        { "QR",       BARCODE_QRCODE,            FALSE },
+        { "RM4",      BARCODE_RM4SCC,            FALSE },
+        { "UPC-A",    BARCODE_UPCA,              FALSE },
+        { "UPC-E",    BARCODE_UPCE,              FALSE },
+        { "USPS",     BARCODE_ONECODE,           FALSE },
+        { "PLS",      BARCODE_PLESSEY,           FALSE },
+        { NULL,       0,                         FALSE }
+};
+
+
 /*===========================================*/
 /* Local function prototypes                 */
 /*===========================================*/
@@ -56,6 +144,43 @@ gl_barcode_zint_new (const gchar          *id,
                            gdouble         w,
                            gdouble         h,
                            const gchar    *digits)
+{
+        return gl_barcode_zint_new_symbology (gl_barcode_zint_lookup (id),
+                                              text_flag, checksum_flag, w, h, digits);
+}
+
+
+/*****************************************************************************/
+/* Resolve id to a symbology code for gl_barcode_zint_new_symbology().       */
+/*****************************************************************************/
+gint
+gl_barcode_zint_lookup (const gchar    *id)
+{
+        gint i;
+
+        for (i=0; symbologies[i].id != NULL; i++)
+        {
+                if (g_ascii_strcasecmp (id, symbologies[i].id) == 0)
+                {
+                        return i;
+                }
+        }
+
+        gl_debug (DEBUG_BARCODE, "Unknown zint barcode id \"%s\"", id);
+        return -1;
+}
+
+
+/*****************************************************************************/
+/* Generate barcode for an already resolved symbology code.                  */
+/*****************************************************************************/
+lglBarcode *
+gl_barcode_zint_new_symbology (gint            symbology,
+                               gboolean        text_flag,
+                               gboolean        checksum_flag,
+                               gdouble         w,
+                               gdouble         h,
+                               const gchar    *digits)
 {
         lglBarcode          *gbc;
         struct zint_symbol  *symbol;
@@ -70,76 +195,15 @@ gl_barcode_zint_new (const gchar          *id,
                 h = DEFAULT_H;
         }
 
-        /* Assign type flag.  Pre-filter by length for subtypes. */
-        if (g_ascii_strcasecmp (id, "AUSP") == 0)     { symbol->symbology = BARCODE_AUSPOST; }
-        if (g_ascii_strcasecmp (id, "AUSRP") == 0)    { symbol->symbology = BARCODE_AUSREPLY; }
-        if (g_ascii_strcasecmp (id, "AUSRT") == 0)    { symbol->symbology = BARCODE_AUSROUTE; }
-        if (g_ascii_strcasecmp (id, "AUSRD") == 0)    { symbol->symbology = BARCODE_AUSREDIRECT; }
-        if (g_ascii_strcasecmp (id, "AZTEC") == 0)    { symbol->symbology = BARCODE_AZTEC; }
-        if (g_ascii_strcasecmp (id, "AZRUN") == 0)    { symbol->symbology = BARCODE_AZRUNE; }
-        if (g_ascii_strcasecmp (id, "CBR") == 0)      { symbol->symbology = BARCODE_CODABAR; }
-        if (g_ascii_strcasecmp (id, "Code1") == 0)    { symbol->symbology = BARCODE_CODEONE; }
-        if (g_ascii_strcasecmp (id, "Code11") == 0)   { symbol->symbology = BARCODE_CODE11; }
-        if (g_ascii_strcasecmp (id, "C16K") == 0)     { symbol->symbology = BARCODE_CODE16K; }
-        if (g_ascii_strcasecmp (id, "C25M") == 0)     { symbol->symbology = BARCODE_C25MATRIX; }
-        if (g_ascii_strcasecmp (id, "C25I") == 0)     { symbol->symbology = BARCODE_C25IATA; }
-        if (g_ascii_strcasecmp (id, "C25DL") == 0)    { symbol->symbology = BARCODE_C25LOGIC; }
-        if (g_ascii_strcasecmp (id, "Code32") == 0)   { symbol->symbology = BARCODE_CODE32; }
-        if (g_ascii_strcasecmp (id, "Code39") == 0)   { symbol->symbology = BARCODE_CODE39; }
-        if (g_ascii_strcasecmp (id, "Code39E") == 0)  { symbol->symbology = BARCODE_EXCODE39; }
-        if (g_ascii_strcasecmp (id, "Code49") == 0)   { symbol->symbology = BARCODE_CODE49; }
-        if (g_ascii_strcasecmp (id, "Code93") == 0)   { symbol->symbology = BARCODE_CODE93; }
-        if (g_ascii_strcasecmp (id, "Code128") == 0)  { symbol->symbology = BARCODE_CODE128; }
-        if (g_ascii_strcasecmp (id, "Code128B") == 0) { symbol->symbology = BARCODE_CODE128B; }
-        if (g_ascii_strcasecmp (id, "DAFT") == 0)     { symbol->symbology = BARCODE_DAFT; }
-        if (g_ascii_strcasecmp (id, "DMTX") == 0)     { symbol->symbology = BARCODE_DATAMATRIX; }
-        if (g_ascii_strcasecmp (id, "DMTX-GS1") == 0) { symbol->symbology = BARCODE_DATAMATRIX;
-	                                                symbol->input_mode = GS1_MODE; }
-        if (g_ascii_strcasecmp (id, "DPL") == 0)      { symbol->symbology = BARCODE_DPLEIT; }
-        if (g_ascii_strcasecmp (id, "DPI") == 0)      { symbol->symbology = BARCODE_DPIDENT; }
-        if (g_ascii_strcasecmp (id, "KIX") == 0)      { symbol->symbology = BARCODE_KIX; }
-        if (g_ascii_strcasecmp (id, "EAN") == 0)      { symbol->symbology = BARCODE_EANX; }
-        if (g_ascii_strcasecmp (id, "HIBC128") == 0)  { symbol->symbology = BARCODE_HIBC_128; }
-        if (g_ascii_strcasecmp (id, "HIBC39") == 0)   { symbol->symbology = BARCODE_HIBC_39; }
-        if (g_ascii_strcasecmp (id, "HIBCDM") == 0)   { symbol->symbology = BARCODE_HIBC_DM; }
-        if (g_ascii_strcasecmp (id, "HIBCQR") == 0)   { symbol->symbology = BARCODE_HIBC_QR; }
-        if (g_ascii_strcasecmp (id, "HIBCPDF") == 0)  { symbol->symbology = BARCODE_HIBC_MICPDF; }
-        if (g_ascii_strcasecmp (id, "HIBCMPDF") == 0) { symbol->symbology = BARCODE_HIBC_AZTEC; }
-        if (g_ascii_strcasecmp (id, "HIBCAZ") == 0)   { symbol->symbology = BARCODE_C25INTER; }
-        if (g_ascii_strcasecmp (id, "I25") == 0)      { symbol->symbology = BARCODE_C25INTER; }
-        if (g_ascii_strcasecmp (id, "ISBN") == 0)     { symbol->symbology = BARCODE_ISBNX; }
-        if (g_ascii_strcasecmp (id, "ITF14") == 0)    { symbol->symbology = BARCODE_ITF14; }
-        if (g_ascii_strcasecmp (id, "GMTX") == 0)     { symbol->symbology = BARCODE_GRIDMATRIX; }
-        if (g_ascii_strcasecmp (id, "GS1-128") == 0)  { symbol->symbology = BARCODE_EAN128; }
-        if (g_ascii_strcasecmp (id, "LOGM") == 0)     { symbol->symbology = BARCODE_LOGMARS; }
-        if (g_ascii_strcasecmp (id, "RSS14") == 0)    { symbol->symbology = BARCODE_RSS14; }
-        if (g_ascii_strcasecmp (id, "RSSLTD") == 0)   { symbol->symbology = BARCODE_RSS_LTD; }
-        if (g_ascii_strcasecmp (id, "RSSEXP") == 0)   { symbol->symbology = BARCODE_RSS_EXP; }
-        if (g_ascii_strcasecmp (id, "RSSS") == 0)     { symbol->symbology = BARCODE_RSS14STACK; }
-        if (g_ascii_strcasecmp (id, "RSSSO") == 0)    { symbol->symbology = BARCODE_RSS14STACK_OMNI; }
-        if (g_ascii_strcasecmp (id, "RSSSE") == 0)    { symbol->symbology = BARCODE_RSS_EXPSTACK; }
-        if (g_ascii_strcasecmp (id, "PHARMA") == 0)   { symbol->symbology = BARCODE_PHARMA; }
-        if (g_ascii_strcasecmp (id, "PHARMA2") == 0)  { symbol->symbology = BARCODE_PHARMA_TWO; }
-        if (g_ascii_strcasecmp (id, "PZN") == 0)      { symbol->symbology = BARCODE_PZN; }
-        if (g_ascii_strcasecmp (id, "TELE") == 0)     { symbol->symbology = BARCODE_TELEPEN; }
-        if (g_ascii_strcasecmp (id, "TELEX") == 0)    { symbol->symbology = BARCODE_TELEPEN_NUM; }
-        if (g_ascii_strcasecmp (id, "JAPAN") == 0)    { symbol->symbology = BARCODE_JAPANPOST; }
-        if (g_ascii_strcasecmp (id, "KOREA") == 0)    { symbol->symbology = BARCODE_KOREAPOST; }
-        if (g_ascii_strcasecmp (id, "MAXI") == 0)     { symbol->symbology = BARCODE_MAXICODE; }
-        if (g_ascii_strcasecmp (id, "MPDF") == 0)     { symbol->symbology = BARCODE_MICROPDF417; }
-        if (g_ascii_strcasecmp (id, "MSI") == 0)      { symbol->symbology = BARCODE_MSI_PLESSEY; }
-        if (g_ascii_strcasecmp (id, "MQR") == 0)      { symbol->symbology = BARCODE_MICROQR; }
-        if (g_ascii_strcasecmp (id, "NVE") == 0)      { symbol->symbology = BARCODE_NVE18; }
-        if (g_ascii_strcasecmp (id, "PLAN") == 0)     { symbol->symbology = BARCODE_PLANET; }
-        if (g_ascii_strcasecmp (id, "POSTNET") == 0)  { symbol->symbology = BARCODE_POSTNET; }
-        if (g_ascii_strcasecmp (id, "PDF") == 0)      { symbol->symbology = BARCODE_PDF417; }
-        if (g_ascii_strcasecmp (id, "PDFT") == 0)     { symbol->symbology = BARCODE_PDF417TRUNC; }
-        if (g_ascii_strcasecmp (id, "QR") == 0)       { symbol->symbology = BARCODE_QRCODE; }
-        if (g_ascii_strcasecmp (id, "RM4") == 0)      { symbol->symbology = BARCODE_RM4SCC; }
-        if (g_ascii_strcasecmp (id, "UPC-A") == 0)    { symbol->symbology = BARCODE_UPCA; }
-        if (g_ascii_strcasecmp (id, "UPC-E") == 0)    { symbol->symbology = BARCODE_UPCE; }
-        if (g_ascii_strcasecmp (id, "USPS") == 0)     { symbol->symbology = BARCODE_ONECODE; }
-        if (g_ascii_strcasecmp (id, "PLS") == 0)      { symbol->symbology = BARCODE_PLESSEY; }
+        /* Assign type flag. */
+        if ( (symbology >= 0) && (symbology < (gint)G_N_ELEMENTS (symbologies) - 1) )
+        {
+                symbol->symbology = symbologies[symbology].symbology;
+                if ( symbologies[symbology].gs1_flag )
+                {
+                        symbol->input_mode = GS1_MODE;
+                }
+        }
 
 
         result = ZBarcode_Encode(symbol, (unsigned char *)digits, 0);
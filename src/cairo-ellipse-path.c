@@ -22,8 +22,6 @@
 
 #include "cairo-ellipse-path.h"
 
-#include <math.h>
-
 #include "debug.h"
 
 
@@ -31,7 +29,9 @@
 /* Private macros and constants.             */
 /*===========================================*/
 
-#define ARC_FINE   2
+/* Distance of Bezier control points from end points of a quarter arc of a
+ * unit circle: 4/3*(sqrt(2)-1).  Radial error is below 0.03%. */
+#define KAPPA   0.5522847498307936
 
 
 /*===========================================*/
@@ -50,25 +50,27 @@
 
 
 /*****************************************************************************/
-/* Create ellipse path                                                       */
+/* Create ellipse path, bounded by the rectangle (0,0)-(2*rx,2*ry), from     */
+/* four Bezier quarter arcs.                                                 */
 /*****************************************************************************/
 void
 gl_cairo_ellipse_path (cairo_t           *cr,
                        gdouble            rx,
                        gdouble            ry)
 {
-        gdouble x, y;
-        gint i_theta;
+        gdouble kx, ky;
 
         gl_debug (DEBUG_VIEW, "START");
 
+        kx = KAPPA * rx;
+        ky = KAPPA * ry;
+
         cairo_new_path (cr);
-        cairo_move_to (cr, 2*rx, ry);
-        for (i_theta = ARC_FINE; i_theta <= 360; i_theta += ARC_FINE) {
-                x = rx + rx * cos (i_theta * G_PI / 180.0);
-                y = ry + ry * sin (i_theta * G_PI / 180.0);
-                cairo_line_to (cr, x, y);
-        }
+        cairo_move_to  (cr, 2*rx, ry);
+        cairo_curve_to (cr, 2*rx,    ry+ky,   rx+kx,   2*ry,    rx,      2*ry);
+        cairo_curve_to (cr, rx-kx,   2*ry,    0,       ry+ky,   0,       ry);
+        cairo_curve_to (cr, 0,       ry-ky,   rx-kx,   0,       rx,      0);
+        cairo_curve_to (cr, rx+kx,   0,       2*rx,    ry-ky,   2*rx,    ry);
         cairo_close_path (cr);
 
         gl_debug (DEBUG_VIEW, "END");
@@ -23,46 +23,72 @@
 #include "cairo-label-path.h"
 
 #include <math.h>
+#include <string.h>
 
 #include "cairo-ellipse-path.h"
 
 #include "debug.h"
 
 
+/*===========================================*/
+/* Private macros and constants.             */
+/*===========================================*/
+
+#define MAX_CACHED_PATHS 32
+
+
 /*===========================================*/
 /* Private types                             */
 /*===========================================*/
 
+/*
+ * Everything that determines the outline of a label, with rotation and
+ * waste already applied.  Fields that do not apply to a shape are zero.
+ */
+typedef struct {
+        lglTemplateFrameShape   shape;
+        gdouble                 w, h;
+        gdouble                 r, r1, r2;
+        gdouble                 x_waste, y_waste;
+} PathKey;
+
 
 /*===========================================*/
 /* Private globals                           */
 /*===========================================*/
 
+/* Paths are shared by print threads, so the cache is locked. */
+G_LOCK_DEFINE_STATIC (path_cache);
+static GHashTable *path_cache = NULL;
+
 
 /*===========================================*/
 /* Local function prototypes                 */
 /*===========================================*/
 
+static void         path_key_init                    (PathKey                *key,
+                                                      const lglTemplate      *template,
+                                                      gboolean                rotate_flag,
+                                                      gboolean                waste_flag);
+static guint        path_key_hash                    (gconstpointer           key);
+static gboolean     path_key_equal                   (gconstpointer           key1,
+                                                      gconstpointer           key2);
+static cairo_path_t *build_path                      (const PathKey          *key);
+static void         path_free                        (gpointer                path);
+
 static void gl_cairo_rect_label_path             (cairo_t                *cr,
-                                                  const lglTemplate      *template,
-                                                  gboolean                rotate_flag,
-                                                  gboolean                waste_flag);
+                                                  const PathKey          *key);
 static void gl_cairo_ellipse_label_path          (cairo_t                *cr,
-                                                  const lglTemplate      *template,
-                                                  gboolean                rotate_flag,
-                                                  gboolean                waste_flag);
+                                                  const PathKey          *key);
 static void gl_cairo_round_label_path            (cairo_t                *cr,
-                                                  const lglTemplate      *template,
-                                                  gboolean                rotate_flag,
-                                                  gboolean                waste_flag);
+                                                  const PathKey          *key);
 static void gl_cairo_cd_label_path               (cairo_t                *cr,
-                                                  const lglTemplate      *template,
-                                                  gboolean                rotate_flag,
-                                                  gboolean                waste_flag);
+                                                  const PathKey          *key);
 
 
 /*--------------------------------------------------------------------------*/
-/* Create label path                                                        */
+/* Create label path.  The outline of each distinct label geometry is only  */
+/* constructed once, then replayed from a cache.                            */
 /*--------------------------------------------------------------------------*/
 void
 gl_cairo_label_path (cairo_t           *cr,
@@ -70,28 +96,179 @@ gl_cairo_label_path (cairo_t           *cr,
                      gboolean           rotate_flag,
                      gboolean           waste_flag)
 {
-        const lglTemplateFrame *frame;
+        PathKey       key, *new_key;
+        cairo_path_t *path;
 
         gl_debug (DEBUG_PATH, "START");
 
+        path_key_init (&key, template, rotate_flag, waste_flag);
+
+        G_LOCK (path_cache);
+
+        if ( path_cache == NULL )
+        {
+                path_cache = g_hash_table_new_full (path_key_hash, path_key_equal,
+                                                    g_free, path_free);
+        }
+
+        path = g_hash_table_lookup (path_cache, &key);
+        if ( path == NULL )
+        {
+                if ( g_hash_table_size (path_cache) >= MAX_CACHED_PATHS )
+                {
+                        g_hash_table_remove_all (path_cache);
+                }
+
+                path = build_path (&key);
+
+                new_key  = g_new (PathKey, 1);
+                *new_key = key;
+                g_hash_table_insert (path_cache, new_key, path);
+        }
+
+        cairo_new_path (cr);
+        cairo_append_path (cr, path);
+
+        G_UNLOCK (path_cache);
+
+        gl_debug (DEBUG_PATH, "END");
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Extract outline geometry from template.                        */
+/*--------------------------------------------------------------------------*/
+static void
+path_key_init (PathKey           *key,
+               const lglTemplate *template,
+               gboolean           rotate_flag,
+               gboolean           waste_flag)
+{
+        const lglTemplateFrame *frame;
+        gdouble                 x_waste = 0.0, y_waste = 0.0;
+
         frame = (lglTemplateFrame *)template->frames->data;
 
+        memset (key, 0, sizeof (PathKey));
+        key->shape = frame->shape;
+
+        if (rotate_flag)
+        {
+                lgl_template_frame_get_size (frame, &key->h, &key->w);
+        }
+        else
+        {
+                lgl_template_frame_get_size (frame, &key->w, &key->h);
+        }
+
         switch (frame->shape) {
 
         case LGL_TEMPLATE_FRAME_SHAPE_RECT:
-                gl_cairo_rect_label_path (cr, template, rotate_flag, waste_flag);
+                key->r  = frame->rect.r;
+                x_waste = frame->rect.x_waste;
+                y_waste = frame->rect.y_waste;
                 break;
 
         case LGL_TEMPLATE_FRAME_SHAPE_ELLIPSE:
-                gl_cairo_ellipse_label_path (cr, template, rotate_flag, waste_flag);
+                x_waste = y_waste = frame->ellipse.waste;
                 break;
 
         case LGL_TEMPLATE_FRAME_SHAPE_ROUND:
-                gl_cairo_round_label_path (cr, template, rotate_flag, waste_flag);
+                x_waste = y_waste = frame->round.waste;
                 break;
 
         case LGL_TEMPLATE_FRAME_SHAPE_CD:
-                gl_cairo_cd_label_path (cr, template, rotate_flag, waste_flag);
+                key->r1 = frame->cd.r1;
+                key->r2 = frame->cd.r2;
+                x_waste = y_waste = frame->cd.waste;
+                break;
+
+        default:
+                break;
+        }
+
+        if (waste_flag)
+        {
+                key->x_waste = rotate_flag ? y_waste : x_waste;
+                key->y_waste = rotate_flag ? x_waste : y_waste;
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Hash outline geometry.                                         */
+/*--------------------------------------------------------------------------*/
+static guint
+path_key_hash (gconstpointer key)
+{
+        const PathKey *k = key;
+        guint          hash;
+
+        hash = k->shape;
+        hash = 31*hash + g_double_hash (&k->w);
+        hash = 31*hash + g_double_hash (&k->h);
+        hash = 31*hash + g_double_hash (&k->r);
+        hash = 31*hash + g_double_hash (&k->r1);
+        hash = 31*hash + g_double_hash (&k->r2);
+        hash = 31*hash + g_double_hash (&k->x_waste);
+        hash = 31*hash + g_double_hash (&k->y_waste);
+
+        return hash;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Compare outline geometries.                                    */
+/*--------------------------------------------------------------------------*/
+static gboolean
+path_key_equal (gconstpointer key1,
+                gconstpointer key2)
+{
+        const PathKey *k1 = key1;
+        const PathKey *k2 = key2;
+
+        return ( (k1->shape   == k2->shape)   &&
+                 (k1->w       == k2->w)       &&
+                 (k1->h       == k2->h)       &&
+                 (k1->r       == k2->r)       &&
+                 (k1->r1      == k2->r1)      &&
+                 (k1->r2      == k2->r2)      &&
+                 (k1->x_waste == k2->x_waste) &&
+                 (k1->y_waste == k2->y_waste) );
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Construct outline path, in label coordinates.                  */
+/*--------------------------------------------------------------------------*/
+static cairo_path_t *
+build_path (const PathKey *key)
+{
+        cairo_surface_t *surface;
+        cairo_t         *cr;
+        cairo_path_t    *path;
+
+        surface = cairo_recording_surface_create (CAIRO_CONTENT_ALPHA, NULL);
+        cr      = cairo_create (surface);
+
+        cairo_new_path (cr);
+
+        switch (key->shape) {
+
+        case LGL_TEMPLATE_FRAME_SHAPE_RECT:
+                gl_cairo_rect_label_path (cr, key);
+                break;
+
+        case LGL_TEMPLATE_FRAME_SHAPE_ELLIPSE:
+                gl_cairo_ellipse_label_path (cr, key);
+                break;
+
+        case LGL_TEMPLATE_FRAME_SHAPE_ROUND:
+                gl_cairo_round_label_path (cr, key);
+                break;
+
+        case LGL_TEMPLATE_FRAME_SHAPE_CD:
+                gl_cairo_cd_label_path (cr, key);
                 break;
 
         default:
@@ -99,7 +276,22 @@ gl_cairo_label_path (cairo_t           *cr,
                 break;
         }
 
-        gl_debug (DEBUG_PATH, "END");
+        path = cairo_copy_path (cr);
+
+        cairo_destroy (cr);
+        cairo_surface_destroy (surface);
+
+        return path;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Free cached path.                                              */
+/*--------------------------------------------------------------------------*/
+static void
+path_free (gpointer path)
+{
+        cairo_path_destroy ((cairo_path_t *)path);
 }
 
 
@@ -108,41 +300,18 @@ gl_cairo_label_path (cairo_t           *cr,
 /*--------------------------------------------------------------------------*/
 static void
 gl_cairo_rect_label_path (cairo_t           *cr,
-                          const lglTemplate *template,
-                          gboolean           rotate_flag,
-                          gboolean           waste_flag)
+                          const PathKey     *key)
 {
-        const lglTemplateFrame *frame;
         gdouble                 w, h, r;
         gdouble                 x_waste, y_waste;
 
         gl_debug (DEBUG_PATH, "START");
 
-        frame = (lglTemplateFrame *)template->frames->data;
-        r = frame->rect.r;
-
-        x_waste = 0.0;
-        y_waste = 0.0;
-
-        if (rotate_flag)
-        {
-                lgl_template_frame_get_size (frame, &h, &w);
-                if (waste_flag)
-                {
-                        x_waste = frame->rect.y_waste;
-                        y_waste = frame->rect.x_waste;
-                }
-        }
-        else
-        {
-                lgl_template_frame_get_size (frame, &w, &h);
-                if (waste_flag)
-                {
-                        x_waste = frame->rect.x_waste;
-                        y_waste = frame->rect.y_waste;
-                }
-        }
-
+        w       = key->w;
+        h       = key->h;
+        r       = key->r;
+        x_waste = key->x_waste;
+        y_waste = key->y_waste;
 
         if ( r == 0.0 )
         {
@@ -167,32 +336,16 @@ gl_cairo_rect_label_path (cairo_t           *cr,
 /*--------------------------------------------------------------------------*/
 static void
 gl_cairo_ellipse_label_path (cairo_t           *cr,
-                             const lglTemplate *template,
-                             gboolean           rotate_flag,
-                             gboolean           waste_flag)
+                             const PathKey     *key)
 {
-        const lglTemplateFrame *frame;
         gdouble                 w, h;
         gdouble                 waste;
 
         gl_debug (DEBUG_PATH, "START");
 
-        frame = (lglTemplateFrame *)template->frames->data;
-
-        if (rotate_flag)
-        {
-                lgl_template_frame_get_size (frame, &h, &w);
-        }
-        else
-        {
-                lgl_template_frame_get_size (frame, &w, &h);
-        }
-
-        waste = 0.0;
-        if (waste_flag)
-        {
-                waste = frame->ellipse.waste;
-        }
+        w     = key->w;
+        h     = key->h;
+        waste = key->x_waste;
 
         cairo_save (cr);
         cairo_translate (cr, -waste, -waste);
@@ -208,35 +361,16 @@ gl_cairo_ellipse_label_path (cairo_t           *cr,
 /*--------------------------------------------------------------------------*/
 static void
 gl_cairo_round_label_path (cairo_t           *cr,
-                           const lglTemplate *template,
-                           gboolean           rotate_flag,
-                           gboolean           waste_flag)
+                           const PathKey     *key)
 {
-        const lglTemplateFrame *frame;
         gdouble                 w, h;
         gdouble                 waste;
 
         gl_debug (DEBUG_PATH, "START");
 
-        frame = (lglTemplateFrame *)template->frames->data;
-        
-        if (rotate_flag)
-        {
-                lgl_template_frame_get_size (frame, &h, &w);
-        }
-        else
-        {
-                lgl_template_frame_get_size (frame, &w, &h);
-        }
-
-        if (waste_flag)
-        {
-                waste = frame->round.waste;
-        }
-        else
-        {
-                waste = 0.0;
-        }
+        w     = key->w;
+        h     = key->h;
+        waste = key->x_waste;
 
 	cairo_new_path (cr);
         cairo_arc (cr, w/2, h/2, w/2+waste, 0.0, 2*G_PI);
@@ -251,11 +385,8 @@ gl_cairo_round_label_path (cairo_t           *cr,
 /*--------------------------------------------------------------------------*/
 static void
 gl_cairo_cd_label_path (cairo_t           *cr,
-                        const lglTemplate *template,
-                        gboolean           rotate_flag,
-                        gboolean           waste_flag)
+                        const PathKey     *key)
 {
-        const lglTemplateFrame *frame;
         gdouble                 w, h;
         gdouble                 xc, yc;
         gdouble                 r1, r2;
@@ -264,31 +395,16 @@ gl_cairo_cd_label_path (cairo_t           *cr,
 
         gl_debug (DEBUG_PATH, "START");
 
-        frame = (lglTemplateFrame *)template->frames->data;
-
-        if (rotate_flag)
-        {
-                lgl_template_frame_get_size (frame, &h, &w);
-        }
-        else
-        {
-                lgl_template_frame_get_size (frame, &w, &h);
-        }
+        w = key->w;
+        h = key->h;
 
         xc = w/2.0;
         yc = h/2.0;
 
-        r1 = frame->cd.r1;
-        r2 = frame->cd.r2;
+        r1 = key->r1;
+        r2 = key->r2;
 
-        if (waste_flag)
-        {
-                waste = frame->cd.waste;
-        }
-        else
-        {
-                waste = 0.0;
-        }
+        waste = key->x_waste;
 
 	/*
 	 * Outer path (may be clipped in the case of a business card type CD)
@@ -315,7 +431,6 @@ gl_cairo_cd_label_path (cairo_t           *cr,
 }
 
 
-
 /*
  * Local Variables:       -- emacs
  * mode: C                -- emacs
@@ -31,7 +31,55 @@
 #include <glib.h>
 
 
-glDebugSection debug_flags = GLABELS_DEBUG_NONE;
+/*========================================================*/
+/* Private types.                                         */
+/*========================================================*/
+
+typedef struct {
+        gint64  start_time;
+        gint64  total_time;
+        gint    n_runs;
+} StatsTimer;
+
+
+/*========================================================*/
+/* Private globals.                                       */
+/*========================================================*/
+
+glDebugSection gl_debug_flags = GLABELS_DEBUG_NONE;
+
+gboolean       gl_stats_enabled_flag = FALSE;
+gint64         gl_stats_counters[GL_STATS_N_COUNTERS];
+
+static StatsTimer  stats_timers[GL_STATS_N_TIMERS];
+static gint64      stats_job_start_time;
+
+static const gchar *stats_counter_names[GL_STATS_N_COUNTERS] = {
+        "records_parsed",
+        "labels_drawn",
+        "barcodes_built",
+        "cache_hits",
+        "cache_misses",
+        "bytes_written"
+};
+
+static const gchar *stats_timer_names[GL_STATS_N_TIMERS] = {
+        "load",
+        "merge",
+        "render"
+};
+
+
+/*========================================================*/
+/* Private function prototypes.                           */
+/*========================================================*/
+
+static void append_json_string (GString     *str,
+                                const gchar *s);
+
+static void append_json_number (GString     *str,
+                                const gchar *name,
+                                gdouble      value);
 
 
 /****************************************************************************/
@@ -43,60 +91,60 @@ gl_debug_init (void)
 	if (g_getenv ("GLABELS_DEBUG") != NULL)
 	{
 		/* enable all debugging */
-		debug_flags = ~GLABELS_DEBUG_NONE;
+		gl_debug_flags = ~GLABELS_DEBUG_NONE;
 		return;
 	}
 
 	if (g_getenv ("GLABELS_DEBUG_VIEW") != NULL)
-		debug_flags |= GLABELS_DEBUG_VIEW;
+		gl_debug_flags |= GLABELS_DEBUG_VIEW;
 	if (g_getenv ("GLABELS_DEBUG_ITEM") != NULL)
-		debug_flags |= GLABELS_DEBUG_ITEM;
+		gl_debug_flags |= GLABELS_DEBUG_ITEM;
 	if (g_getenv ("GLABELS_DEBUG_PRINT") != NULL)
-		debug_flags |= GLABELS_DEBUG_PRINT;
+		gl_debug_flags |= GLABELS_DEBUG_PRINT;
 	if (g_getenv ("GLABELS_DEBUG_PREFS") != NULL)
-		debug_flags |= GLABELS_DEBUG_PREFS;
+		gl_debug_flags |= GLABELS_DEBUG_PREFS;
 	if (g_getenv ("GLABELS_DEBUG_FILE") != NULL)
-		debug_flags |= GLABELS_DEBUG_FILE;
+		gl_debug_flags |= GLABELS_DEBUG_FILE;
 	if (g_getenv ("GLABELS_DEBUG_LABEL") != NULL)
-		debug_flags |= GLABELS_DEBUG_LABEL;
+		gl_debug_flags |= GLABELS_DEBUG_LABEL;
 	if (g_getenv ("GLABELS_DEBUG_TEMPLATE") != NULL)
-		debug_flags |= GLABELS_DEBUG_TEMPLATE;
+		gl_debug_flags |= GLABELS_DEBUG_TEMPLATE;
 	if (g_getenv ("GLABELS_DEBUG_PAPER") != NULL)
-		debug_flags |= GLABELS_DEBUG_PAPER;
+		gl_debug_flags |= GLABELS_DEBUG_PAPER;
 	if (g_getenv ("GLABELS_DEBUG_XML") != NULL)
-		debug_flags |= GLABELS_DEBUG_XML;
+		gl_debug_flags |= GLABELS_DEBUG_XML;
 	if (g_getenv ("GLABELS_DEBUG_MERGE") != NULL)
-		debug_flags |= GLABELS_DEBUG_MERGE;
+		gl_debug_flags |= GLABELS_DEBUG_MERGE;
 	if (g_getenv ("GLABELS_DEBUG_UNDO") != NULL)
-		debug_flags |= GLABELS_DEBUG_UNDO;
+		gl_debug_flags |= GLABELS_DEBUG_UNDO;
 	if (g_getenv ("GLABELS_DEBUG_RECENT") != NULL)
-		debug_flags |= GLABELS_DEBUG_RECENT;
+		gl_debug_flags |= GLABELS_DEBUG_RECENT;
 	if (g_getenv ("GLABELS_DEBUG_COMMANDS") != NULL)
-		debug_flags |= GLABELS_DEBUG_COMMANDS;
+		gl_debug_flags |= GLABELS_DEBUG_COMMANDS;
 	if (g_getenv ("GLABELS_DEBUG_WINDOW") != NULL)
-		debug_flags |= GLABELS_DEBUG_WINDOW;
+		gl_debug_flags |= GLABELS_DEBUG_WINDOW;
 	if (g_getenv ("GLABELS_DEBUG_UI") != NULL)
-		debug_flags |= GLABELS_DEBUG_UI;
+		gl_debug_flags |= GLABELS_DEBUG_UI;
 	if (g_getenv ("GLABELS_DEBUG_PROPERTY_BAR") != NULL)
-		debug_flags |= GLABELS_DEBUG_PROPERTY_BAR;
+		gl_debug_flags |= GLABELS_DEBUG_PROPERTY_BAR;
 	if (g_getenv ("GLABELS_DEBUG_MEDIA_SELECT") != NULL)
-		debug_flags |= GLABELS_DEBUG_MEDIA_SELECT;
+		gl_debug_flags |= GLABELS_DEBUG_MEDIA_SELECT;
 	if (g_getenv ("GLABELS_DEBUG_MINI_PREVIEW") != NULL)
-		debug_flags |= GLABELS_DEBUG_MINI_PREVIEW;
+		gl_debug_flags |= GLABELS_DEBUG_MINI_PREVIEW;
 	if (g_getenv ("GLABELS_DEBUG_PIXBUF_CACHE") != NULL)
-		debug_flags |= GLABELS_DEBUG_PIXBUF_CACHE;
+		gl_debug_flags |= GLABELS_DEBUG_PIXBUF_CACHE;
 	if (g_getenv ("GLABELS_DEBUG_SVG_CACHE") != NULL)
-		debug_flags |= GLABELS_DEBUG_SVG_CACHE;
+		gl_debug_flags |= GLABELS_DEBUG_SVG_CACHE;
 	if (g_getenv ("GLABELS_DEBUG_EDITOR") != NULL)
-		debug_flags |= GLABELS_DEBUG_EDITOR;
+		gl_debug_flags |= GLABELS_DEBUG_EDITOR;
 	if (g_getenv ("GLABELS_DEBUG_WDGT") != NULL)
-		debug_flags |= GLABELS_DEBUG_WDGT;
+		gl_debug_flags |= GLABELS_DEBUG_WDGT;
 	if (g_getenv ("GLABELS_DEBUG_PATH") != NULL)
-		debug_flags |= GLABELS_DEBUG_PATH;
+		gl_debug_flags |= GLABELS_DEBUG_PATH;
 	if (g_getenv ("GLABELS_DEBUG_FIELD_BUTTON") != NULL)
-		debug_flags |= GLABELS_DEBUG_FIELD_BUTTON;
+		gl_debug_flags |= GLABELS_DEBUG_FIELD_BUTTON;
 	if (g_getenv ("GLABELS_DEBUG_BARCODE") != NULL)
-		debug_flags |= GLABELS_DEBUG_BARCODE;
+		gl_debug_flags |= GLABELS_DEBUG_BARCODE;
 }
 
 
@@ -104,14 +152,14 @@ gl_debug_init (void)
 /* Print debugging information.                                             */
 /****************************************************************************/
 void
-gl_debug (glDebugSection  section,
-	  const gchar    *file,
-	  gint            line,
-	  const gchar    *function,
-	  const gchar    *format,
-	  ...)
+gl_debug_message (glDebugSection  section,
+		  const gchar    *file,
+		  gint            line,
+		  const gchar    *function,
+		  const gchar    *format,
+		  ...)
 {
-	if  (debug_flags & section)
+	if  (gl_debug_flags & section)
 	{
 		va_list  args;
 		gchar   *msg;
@@ -130,6 +178,180 @@ gl_debug (glDebugSection  section,
 }
 
 
+/****************************************************************************/
+/* Turn on collection of statistics.                                        */
+/****************************************************************************/
+void
+gl_stats_enable (void)
+{
+        gl_stats_enabled_flag = TRUE;
+        gl_stats_reset ();
+}
+
+
+/****************************************************************************/
+/* Clear all counters and timers, starting a new job.                       */
+/****************************************************************************/
+void
+gl_stats_reset (void)
+{
+        gint i;
+
+        for ( i = 0; i < GL_STATS_N_COUNTERS; i++ )
+        {
+                gl_stats_counters[i] = 0;
+        }
+        for ( i = 0; i < GL_STATS_N_TIMERS; i++ )
+        {
+                stats_timers[i].start_time = 0;
+                stats_timers[i].total_time = 0;
+                stats_timers[i].n_runs     = 0;
+        }
+
+        stats_job_start_time = g_get_monotonic_time ();
+}
+
+
+/****************************************************************************/
+/* Start timer.                                                             */
+/****************************************************************************/
+void
+gl_stats_timer_start (glStatsTimer  timer)
+{
+        if ( gl_stats_enabled_flag )
+        {
+                stats_timers[timer].start_time = g_get_monotonic_time ();
+        }
+}
+
+
+/****************************************************************************/
+/* Stop timer, accumulating time since matching gl_stats_timer_start().     */
+/****************************************************************************/
+void
+gl_stats_timer_stop (glStatsTimer  timer)
+{
+        if ( gl_stats_enabled_flag && stats_timers[timer].start_time )
+        {
+                stats_timers[timer].total_time += g_get_monotonic_time () - stats_timers[timer].start_time;
+                stats_timers[timer].start_time  = 0;
+                stats_timers[timer].n_runs++;
+        }
+}
+
+
+/****************************************************************************/
+/* Format statistics collected since last reset as a single line JSON       */
+/* object.                                                                  */
+/****************************************************************************/
+gchar *
+gl_stats_report_json (const gchar  *job_name,
+                      const gchar  *status)
+{
+        GString *str;
+        gdouble  wall_secs, render_secs;
+        gint     i;
+
+        wall_secs   = (g_get_monotonic_time () - stats_job_start_time) / 1.0e6;
+        render_secs = stats_timers[GL_STATS_TIMER_RENDER].total_time / 1.0e6;
+
+        str = g_string_new ("{\"job\": ");
+        append_json_string (str, job_name);
+        g_string_append (str, ", \"status\": ");
+        append_json_string (str, status);
+
+        g_string_append (str, ", ");
+        append_json_number (str, "wall_ms", wall_secs * 1.0e3);
+
+        g_string_append (str, ", \"counters\": {");
+        for ( i = 0; i < GL_STATS_N_COUNTERS; i++ )
+        {
+                g_string_append_printf (str, "%s\"%s\": %" G_GINT64_FORMAT,
+                                        i ? ", " : "",
+                                        stats_counter_names[i],
+                                        gl_stats_counters[i]);
+        }
+        g_string_append (str, "}");
+
+        g_string_append (str, ", \"timers_ms\": {");
+        for ( i = 0; i < GL_STATS_N_TIMERS; i++ )
+        {
+                if ( i )
+                {
+                        g_string_append (str, ", ");
+                }
+                append_json_number (str, stats_timer_names[i],
+                                    stats_timers[i].total_time / 1.0e3);
+        }
+        g_string_append (str, "}");
+
+        g_string_append (str, ", ");
+        append_json_number (str, "labels_per_sec",
+                            render_secs > 0 ? gl_stats_counters[GL_STATS_LABELS_DRAWN] / render_secs : 0.0);
+
+        g_string_append (str, "}");
+
+        return g_string_free (str, FALSE);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Append quoted and escaped JSON string.                         */
+/*--------------------------------------------------------------------------*/
+static void
+append_json_string (GString     *str,
+                    const gchar *s)
+{
+        const gchar *p;
+
+        g_string_append_c (str, '"');
+        for ( p = s ? s : ""; *p; p++ )
+        {
+                switch (*p)
+                {
+                case '"':
+                        g_string_append (str, "\\\"");
+                        break;
+                case '\\':
+                        g_string_append (str, "\\\\");
+                        break;
+                case '\n':
+                        g_string_append (str, "\\n");
+                        break;
+                case '\t':
+                        g_string_append (str, "\\t");
+                        break;
+                default:
+                        if ( (guchar)*p < 0x20 )
+                        {
+                                g_string_append_printf (str, "\\u%04x", (guchar)*p);
+                        }
+                        else
+                        {
+                                g_string_append_c (str, *p);
+                        }
+                        break;
+                }
+        }
+        g_string_append_c (str, '"');
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Append "name": value, independent of locale.                   */
+/*--------------------------------------------------------------------------*/
+static void
+append_json_number (GString     *str,
+                    const gchar *name,
+                    gdouble      value)
+{
+        gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+        g_ascii_formatd (buf, sizeof (buf), "%.3f", value);
+        g_string_append_printf (str, "\"%s\": %s", name, buf);
+}
+
+
 
 /*
  * Local Variables:       -- emacs
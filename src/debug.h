@@ -98,14 +98,87 @@ typedef enum {
 #define	DEBUG_FIELD_BUTTON      GLABELS_DEBUG_FIELD_BUTTON,   __FILE__, __LINE__, __FUNCTION__
 #define	DEBUG_BARCODE   GLABELS_DEBUG_BARCODE,__FILE__, __LINE__, __FUNCTION__
 
-void gl_debug_init (void);
-
-void gl_debug      (glDebugSection  section,
-		    const gchar    *file,
-		    gint            line,
-		    const gchar    *function,
-		    const gchar    *format,
-		    ...);
+extern glDebugSection gl_debug_flags;
+
+void gl_debug_init    (void);
+
+void gl_debug_message (glDebugSection  section,
+		       const gchar    *file,
+		       gint            line,
+		       const gchar    *function,
+		       const gchar    *format,
+		       ...);
+
+/*
+ * gl_debug() tests the section flag inline, so a disabled section costs a
+ * single load and branch instead of a varargs call.  The extra level of
+ * macro expansion splits the DEBUG_* macros into their separate arguments.
+ */
+#define gl_debug(...)  _gl_debug_check (__VA_ARGS__)
+
+#define _gl_debug_check(section, file, line, function, ...)             \
+	G_STMT_START {                                                  \
+		if (G_UNLIKELY (gl_debug_flags & (section)))            \
+			gl_debug_message ((section), (file), (line),    \
+					  (function), __VA_ARGS__);     \
+	} G_STMT_END
+
+static inline gboolean
+gl_debug_is_enabled (glDebugSection section)
+{
+	return (gl_debug_flags & section) != 0;
+}
+
+
+/*
+ * Named counters and timers for monitoring throughput.  Statistics are off
+ * unless gl_stats_enable() has been called (e.g. by glabels-3-batch --stats),
+ * in which case each update is a plain add to a global.  Updates are not
+ * atomic: only enable statistics in single threaded programs.
+ */
+
+typedef enum {
+        GL_STATS_RECORDS_PARSED,
+        GL_STATS_LABELS_DRAWN,
+        GL_STATS_BARCODES_BUILT,
+        GL_STATS_CACHE_HITS,
+        GL_STATS_CACHE_MISSES,
+        GL_STATS_BYTES_WRITTEN,
+
+        GL_STATS_N_COUNTERS
+} glStatsCounter;
+
+typedef enum {
+        GL_STATS_TIMER_LOAD,
+        GL_STATS_TIMER_MERGE,
+        GL_STATS_TIMER_RENDER,
+
+        GL_STATS_N_TIMERS
+} glStatsTimer;
+
+extern gboolean gl_stats_enabled_flag;
+extern gint64   gl_stats_counters[GL_STATS_N_COUNTERS];
+
+static inline void
+gl_stats_add (glStatsCounter counter,
+              gint64         n)
+{
+        if (G_UNLIKELY (gl_stats_enabled_flag))
+                gl_stats_counters[counter] += n;
+}
+
+#define gl_stats_inc(counter)  gl_stats_add ((counter), 1)
+
+void    gl_stats_enable      (void);
+
+void    gl_stats_reset       (void);
+
+void    gl_stats_timer_start (glStatsTimer  timer);
+
+void    gl_stats_timer_stop  (glStatsTimer  timer);
+
+gchar  *gl_stats_report_json (const gchar  *job_name,
+                              const gchar  *status);
 
 G_END_DECLS
 
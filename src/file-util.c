@@ -110,6 +110,28 @@ gl_file_util_is_extension (const gchar       *filename,
 
 
 
+/****************************************************************************/
+/* Insert "-N" before the extension of filename, e.g. "labels-2.pdf".       */
+/****************************************************************************/
+gchar *
+gl_file_util_insert_number (const gchar       *filename,
+                            gint               n)
+{
+        const gchar *ext;
+        const gchar *sep;
+
+        ext = strrchr (filename, '.');
+        sep = strrchr (filename, G_DIR_SEPARATOR);
+
+        if ( (ext == NULL) || ((sep != NULL) && (ext < sep)) )
+        {
+                return g_strdup_printf ("%s-%d", filename, n);
+        }
+
+        return g_strdup_printf ("%.*s-%d%s", (gint)(ext - filename), filename, n, ext);
+}
+
+
 /*
  * Local Variables:       -- emacs
  * mode: C                -- emacs
@@ -33,6 +33,9 @@ gchar              *gl_file_util_make_absolute         (const gchar       *filen
 gboolean            gl_file_util_is_extension          (const gchar       *filename,
                                                         const gchar       *ext_test);
 
+gchar              *gl_file_util_insert_number         (const gchar       *filename,
+                                                        gint               n);
+
 G_END_DECLS
 
 #endif /* __FILE_UTIL_H__ */
@@ -37,6 +37,18 @@
 #include "debug.h"
 
 
+/*===========================================*/
+/* Private types                             */
+/*===========================================*/
+
+typedef struct {
+	glLabel          *label;
+	glWindow         *window;
+	gchar            *filename;
+	gboolean          save_as_flag;
+} SaveJob;
+
+
 /*===========================================*/
 /* Private globals                           */
 /*===========================================*/
@@ -68,6 +80,17 @@ static void save_as_response                 (GtkDialog         *chooser,
 					      gint               response,
 					      glLabel           *label);
 
+static void save_label                       (glLabel           *label,
+					      glWindow          *window,
+					      const gchar       *filename,
+					      gboolean           save_as_flag);
+static gboolean save_in_progress             (glLabel           *label);
+static void save_label_done_cb               (glLabel           *label,
+					      glXMLLabelStatus   status,
+					      SaveJob           *job);
+
+static void close_window                     (glWindow          *window);
+
 
 /*****************************************************************************/
 /* "New" menu callback.                                                      */
@@ -474,18 +497,25 @@ gl_file_open_real (const gchar     *filename,
 
 
 /*****************************************************************************/
-/* "Save" menu callback.                                                     */
+/* "Save" menu callback.  The file is written in the background; returns     */
+/* TRUE if the label needed no save or its save has started.                 */
 /*****************************************************************************/
 gboolean
 gl_file_save (glLabel   *label,
 	      glWindow  *window)
 {
-	glXMLLabelStatus  status;
 	gchar            *filename = NULL;
 
 	gl_debug (DEBUG_FILE, "");
 
 	g_return_val_if_fail (label != NULL, FALSE);
+
+	if (save_in_progress (label))
+	{
+		gl_debug (DEBUG_FILE, "Save in progress");
+
+		return FALSE;
+	}
 	
 	if (gl_label_is_untitled (label))
 	{
@@ -504,46 +534,119 @@ gl_file_save (glLabel   *label,
 	filename = gl_label_get_filename (label);
 	g_return_val_if_fail (filename != NULL, FALSE);
 	
-	gl_xml_label_save (label, filename, &status);
+	save_label (label, window, filename, FALSE);
+
+	g_free (filename);
+
+	return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Start writing label to filename in the background.  Until the   */
+/* save completes, the label is marked so that Save, Save As and Close       */
+/* refuse it, and the label and window are kept alive.                       */
+/*---------------------------------------------------------------------------*/
+static void
+save_label (glLabel     *label,
+	    glWindow    *window,
+	    const gchar *filename,
+	    gboolean     save_as_flag)
+{
+	SaveJob *job;
+
+	gl_debug (DEBUG_FILE, "START");
+
+	job = g_new0 (SaveJob, 1);
+	job->label        = g_object_ref (label);
+	job->window       = g_object_ref (window);
+	job->filename     = g_strdup (filename);
+	job->save_as_flag = save_as_flag;
+
+	g_object_set_data (G_OBJECT (label), "save_in_progress", GINT_TO_POINTER (TRUE));
+
+	gl_xml_label_save_async (label, filename,
+				 (glXMLLabelSaveCallback)save_label_done_cb, job);
+
+	gl_debug (DEBUG_FILE, "END");
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Is label being saved by save_label()?                           */
+/*---------------------------------------------------------------------------*/
+static gboolean
+save_in_progress (glLabel *label)
+{
+	return (g_object_get_data (G_OBJECT (label), "save_in_progress") != NULL);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Background save complete.                                       */
+/*---------------------------------------------------------------------------*/
+static void
+save_label_done_cb (glLabel          *label,
+		    glXMLLabelStatus  status,
+		    SaveJob          *job)
+{
+	GtkWidget *dialog;
+	gboolean   close_flag;
+
+	gl_debug (DEBUG_FILE, "START");
+
+	g_object_set_data (G_OBJECT (label), "save_in_progress", NULL);
+
+	close_flag = (g_object_get_data (G_OBJECT (job->window), "close_after_save") != NULL);
+	g_object_set_data (G_OBJECT (job->window), "close_after_save", NULL);
 
 	if (status != XML_LABEL_OK)
 	{
-		GtkWidget *dialog;
-
 		gl_debug (DEBUG_FILE, "FAILED");
 
-		dialog = gtk_message_dialog_new (GTK_WINDOW (window),
+		dialog = gtk_message_dialog_new (GTK_WINDOW (job->window),
 					      GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
 					      GTK_MESSAGE_ERROR,
 					      GTK_BUTTONS_CLOSE,
 					      _("Could not save file \"%s\""),
-					      filename);
+					      job->filename);
 		gtk_message_dialog_format_secondary_text (
 			GTK_MESSAGE_DIALOG (dialog),
 			_("Error encountered during save.  The file is still not saved."));
 
 		gtk_dialog_run (GTK_DIALOG (dialog));
 		gtk_widget_destroy (dialog);
-
-		g_free (filename);
-
-		return FALSE;
-	}	
+	}
 	else
 	{
 		gl_debug (DEBUG_FILE, "OK");
 
-		gl_recent_add_utf8_filename (filename);
+		gl_recent_add_utf8_filename (job->filename);
 
-		g_free (filename);
+		if (job->save_as_flag)
+		{
+			g_free (save_path);
+			save_path = g_path_get_dirname (job->filename);
+		}
 
-		return TRUE;
+		if (close_flag)
+		{
+			close_window (job->window);
+		}
 	}
+
+	g_object_unref (job->label);
+	g_object_unref (job->window);
+	g_free (job->filename);
+	g_free (job);
+
+	gl_debug (DEBUG_FILE, "END");
 }
 
 
 /*****************************************************************************/
-/* "Save As" menu callback.                                                  */
+/* "Save As" menu callback.  The file is written in the background; returns  */
+/* TRUE if its save has started.                                             */
 /*****************************************************************************/
 gboolean
 gl_file_save_as (glLabel   *label,
@@ -561,6 +664,13 @@ gl_file_save_as (glLabel   *label,
 	g_return_val_if_fail (label && GL_IS_LABEL(label), FALSE);
 	g_return_val_if_fail (window && GL_IS_WINDOW(window), FALSE);
 
+	if (save_in_progress (label))
+	{
+		gl_debug (DEBUG_FILE, "END save in progress");
+
+		return FALSE;
+	}
+
 	name = gl_label_get_short_name (label);
 	title = g_strdup_printf (_("Save \"%s\" as"), name);
 	g_free (name);
@@ -618,7 +728,7 @@ gl_file_save_as (glLabel   *label,
 
 	gl_debug (DEBUG_FILE, "END");
 
-	/* Return flag as set by one of the above callbacks, TRUE = saved */
+	/* Return flag as set by one of the above callbacks, TRUE = saving */
 	return saved_flag;
 }
 
@@ -633,7 +743,6 @@ save_as_response (GtkDialog     *chooser,
 {
 	gchar            *raw_filename, *filename, *full_filename;
 	GtkWidget        *dialog;
-	glXMLLabelStatus  status;
 	gboolean         *saved_flag;
 	gboolean          cancel_flag = FALSE;
 
@@ -696,39 +805,14 @@ save_as_response (GtkDialog     *chooser,
 
 			if (!cancel_flag) {
 
-				gl_xml_label_save (label, filename, &status);
-
-				gl_debug (DEBUG_FILE, "status of save = %d", status);
-
-				if ( status != XML_LABEL_OK ) {
-
-					dialog = gtk_message_dialog_new (
-						GTK_WINDOW(chooser),
-						GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
-						GTK_MESSAGE_ERROR,
-						GTK_BUTTONS_CLOSE,
-						_("Could not save file \"%s\""),
-						filename);
-					gtk_message_dialog_format_secondary_text (
-						GTK_MESSAGE_DIALOG (dialog),
-						_("Error encountered during save.  The file is still not saved."));
-
-					gtk_dialog_run (GTK_DIALOG (dialog));
-					gtk_widget_destroy (dialog);
-
-				} else {
+				save_label (label,
+					    GL_WINDOW (gtk_window_get_transient_for (GTK_WINDOW (chooser))),
+					    filename, TRUE);
 
-					*saved_flag = TRUE;
+				*saved_flag = TRUE;
 
-					gl_recent_add_utf8_filename (filename);
-
-					if (save_path != NULL)
-						g_free (save_path);
-					save_path = g_path_get_dirname (filename);
-
-					gtk_widget_destroy (GTK_WIDGET (chooser));
-					gtk_main_quit ();
-				}
+				gtk_widget_destroy (GTK_WIDGET (chooser));
+				gtk_main_quit ();
 
 			}
 
@@ -770,6 +854,12 @@ gl_file_close (glWindow *window)
 		view = GL_VIEW(window->view);
 		label = view->label;
 
+		if (save_in_progress (label)) {
+			gl_debug (DEBUG_FILE, "END save in progress");
+
+			return FALSE;
+		}
+
 		if (gl_label_is_modified (label))	{
 			GtkWidget *dialog;
 			gchar *fname = NULL;
@@ -810,7 +900,13 @@ gl_file_close (glWindow *window)
 			switch (ret)
 			{
 			case GTK_RESPONSE_YES:
-				close = gl_file_save (label, window);
+				/* A started save closes the window when it succeeds. */
+				g_object_set_data (G_OBJECT (window), "close_after_save",
+						   GINT_TO_POINTER (TRUE));
+				close = gl_file_save (label, window) && !save_in_progress (label);
+				if (!save_in_progress (label)) {
+					g_object_set_data (G_OBJECT (window), "close_after_save", NULL);
+				}
 				break;
 			case GTK_RESPONSE_NO:
 				close = TRUE;
@@ -825,15 +921,7 @@ gl_file_close (glWindow *window)
 	}
 
 	if (close) {
-		gtk_widget_destroy (GTK_WIDGET(window));
-
-		if ( gl_window_get_window_list () == NULL ) {
-			
-			gl_debug (DEBUG_FILE, "All windows closed.");
-	
-			gtk_main_quit ();
-		}
-
+		close_window (window);
 	}
 
 	gl_debug (DEBUG_FILE, "END");
@@ -842,6 +930,23 @@ gl_file_close (glWindow *window)
 }
 
 
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Destroy window, quitting once the last window is gone.          */
+/*---------------------------------------------------------------------------*/
+static void
+close_window (glWindow *window)
+{
+	gtk_widget_destroy (GTK_WIDGET(window));
+
+	if ( gl_window_get_window_list () == NULL ) {
+			
+		gl_debug (DEBUG_FILE, "All windows closed.");
+	
+		gtk_main_quit ();
+	}
+}
+
+
 /*****************************************************************************/
 /* "Exit" menu callback.                                                     */
 /*****************************************************************************/
@@ -75,6 +75,17 @@ static void       menu_item_activate_cb       (glFontComboMenuItem *item,
 static GtkWidget *new_font_sub_menu           (glFontComboMenu     *this,
                                                const GList         *list);
 
+static void       add_lazy_font_sub_menu      (glFontComboMenu     *this,
+                                               GtkWidget           *menu_item,
+                                               const GList         *list);
+
+static void       fill_font_sub_menu          (glFontComboMenu     *this,
+                                               GtkWidget           *menu,
+                                               const GList         *list);
+
+static void       sub_menu_item_select_cb     (GtkWidget           *menu_item,
+                                               glFontComboMenu     *this);
+
 static void       font_history_changed_cb     (glFontComboMenu     *this);
 
 
@@ -153,24 +164,21 @@ gl_font_combo_menu_init (glFontComboMenu *this)
         gtk_menu_shell_append (GTK_MENU_SHELL (this), menu_item);
 
         list = gl_font_util_get_proportional_families ();
-        sub_menu = new_font_sub_menu (this, list);
-        gtk_menu_item_set_submenu (GTK_MENU_ITEM (menu_item), sub_menu);
+        add_lazy_font_sub_menu (this, menu_item, list);
         gtk_widget_set_sensitive (menu_item, list != NULL);
 
         menu_item = gtk_menu_item_new_with_label (_("Fixed-width fonts"));
         gtk_menu_shell_append (GTK_MENU_SHELL (this), menu_item);
 
         list = gl_font_util_get_fixed_width_families ();
-        sub_menu = new_font_sub_menu (this, list);
-        gtk_menu_item_set_submenu (GTK_MENU_ITEM (menu_item), sub_menu);
+        add_lazy_font_sub_menu (this, menu_item, list);
         gtk_widget_set_sensitive (menu_item, list != NULL);
 
         menu_item = gtk_menu_item_new_with_label (_("All fonts"));
         gtk_menu_shell_append (GTK_MENU_SHELL (this), menu_item);
 
         list = gl_font_util_get_all_families ();
-        sub_menu = new_font_sub_menu (this, list);
-        gtk_menu_item_set_submenu (GTK_MENU_ITEM (menu_item), sub_menu);
+        add_lazy_font_sub_menu (this, menu_item, list);
         gtk_widget_set_sensitive (menu_item, list != NULL);
 
 
@@ -246,10 +254,48 @@ new_font_sub_menu (glFontComboMenu *this,
                    const GList     *list)
 {
         GtkWidget   *menu;
-        GtkWidget   *menu_item;
-        GList       *p;
 
         menu = gtk_menu_new ();
+        fill_font_sub_menu (this, menu, list);
+
+        gtk_widget_show (menu);
+        return menu;
+}
+
+
+/*****************************************************************************/
+/* Attach an empty font sub menu to menu_item, to be filled from list the    */
+/* first time menu_item is selected.  With thousands of installed families,  */
+/* building every sub menu up front made each new font combo slow to open.   */
+/* The list must outlive the menu.                                           */
+/*****************************************************************************/
+static void
+add_lazy_font_sub_menu (glFontComboMenu *this,
+                        GtkWidget       *menu_item,
+                        const GList     *list)
+{
+        GtkWidget   *menu;
+
+        menu = gtk_menu_new ();
+        gtk_menu_item_set_submenu (GTK_MENU_ITEM (menu_item), menu);
+        gtk_widget_show (menu);
+
+        g_object_set_data (G_OBJECT (menu_item), "font-list", (gpointer)list);
+        g_signal_connect (menu_item, "select",
+                          G_CALLBACK (sub_menu_item_select_cb), this);
+}
+
+
+/*****************************************************************************/
+/* Add an item for each family in list to font sub menu.                     */
+/*****************************************************************************/
+static void
+fill_font_sub_menu (glFontComboMenu *this,
+                    GtkWidget       *menu,
+                    const GList     *list)
+{
+        GtkWidget   *menu_item;
+        GList       *p;
 
         for ( p = (GList *)list; p != NULL; p = p->next )
         {
@@ -259,9 +305,27 @@ new_font_sub_menu (glFontComboMenu *this,
                 g_signal_connect (menu_item, "activate",
                                   G_CALLBACK (menu_item_activate_cb), this);
         }
+}
 
-        gtk_widget_show (menu);
-        return menu;
+
+/*****************************************************************************/
+/* Sub menu item selected callback: fill in its sub menu, once.              */
+/*****************************************************************************/
+static void
+sub_menu_item_select_cb (GtkWidget       *menu_item,
+                         glFontComboMenu *this)
+{
+        const GList *list;
+        GtkWidget   *menu;
+
+        list = g_object_get_data (G_OBJECT (menu_item), "font-list");
+        if ( list != NULL )
+        {
+                menu = gtk_menu_item_get_submenu (GTK_MENU_ITEM (menu_item));
+                fill_font_sub_menu (this, menu, list);
+
+                g_object_set_data (G_OBJECT (menu_item), "font-list", NULL);
+        }
 }
 
 
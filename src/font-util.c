@@ -29,13 +29,30 @@
 #include <libglabels.h>
 
 
-/****************************************************************************/
-/* Get list of all available font families.                                 */
-/****************************************************************************/
-const GList  *
-gl_font_util_get_all_families (void)
+/*===========================================*/
+/* Private globals                           */
+/*===========================================*/
+
+/* Sorted family lists, shared by all callers, and a set of installed names. */
+static GList      *all_families          = NULL;
+static GList      *proportional_families = NULL;
+static GList      *fixed_width_families  = NULL;
+static GHashTable *installed_families    = NULL;
+
+
+/*===========================================*/
+/* Local function prototypes                 */
+/*===========================================*/
+
+static void load_families (void);
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Enumerate font families once, filling all lists in one pass.   */
+/*--------------------------------------------------------------------------*/
+static void
+load_families (void)
 {
-	static GList         *list = NULL;
 	PangoFontMap         *fontmap;
 	PangoContext         *context;
 	PangoFontFamily     **families;
@@ -43,68 +60,68 @@ gl_font_util_get_all_families (void)
 	gint                  i;
 	gchar                *name;
 
-        if ( !list )
+        if ( installed_families )
         {
-                fontmap = pango_cairo_font_map_new ();
-                context = pango_font_map_create_context (PANGO_FONT_MAP (fontmap));
+                return;
+        }
 
-                pango_context_list_families (context, &families, &n);
+        installed_families = g_hash_table_new (g_str_hash, g_str_equal);
+
+        /* The default map is shared with the UI and already loaded. */
+        fontmap = pango_cairo_font_map_get_default ();
+        context = pango_font_map_create_context (PANGO_FONT_MAP (fontmap));
+
+        pango_context_list_families (context, &families, &n);
+
+        for ( i=0; i<n; i++ )
+        {
+                name = g_strdup (pango_font_family_get_name (families[i]));
 
-                for ( i=0; i<n; i++ )
+                /* Names are shared by the lists, and never freed. */
+                all_families = g_list_prepend (all_families, name);
+                if ( pango_font_family_is_monospace (families[i]) )
                 {
-                        name = g_strdup (pango_font_family_get_name (families[i]));
-                        list = g_list_insert_sorted (list, name,
-                                                     (GCompareFunc)lgl_str_utf8_casecmp);
+                        fixed_width_families = g_list_prepend (fixed_width_families, name);
+                }
+                else
+                {
+                        proportional_families = g_list_prepend (proportional_families, name);
                 }
 
-                g_free (families);
-
-                g_object_unref (context);
-                g_object_unref (fontmap);
+                g_hash_table_add (installed_families, name);
         }
 
-	return list;
+        all_families          = g_list_sort (all_families, (GCompareFunc)lgl_str_utf8_casecmp);
+        proportional_families = g_list_sort (proportional_families, (GCompareFunc)lgl_str_utf8_casecmp);
+        fixed_width_families  = g_list_sort (fixed_width_families, (GCompareFunc)lgl_str_utf8_casecmp);
+
+        g_free (families);
+
+        g_object_unref (context);
 }
 
 
 /****************************************************************************/
-/* Get list of all available proportional font families.                    */
+/* Get list of all available font families.                                 */
 /****************************************************************************/
 const GList  *
-gl_font_util_get_proportional_families (void)
+gl_font_util_get_all_families (void)
 {
-	static GList         *list = NULL;
-	PangoFontMap         *fontmap;
-	PangoContext         *context;
-	PangoFontFamily     **families;
-	gint                  n;
-	gint                  i;
-	gchar                *name;
+        load_families ();
 
-        if ( !list )
-        {
-                fontmap = pango_cairo_font_map_new ();
-                context = pango_font_map_create_context (PANGO_FONT_MAP (fontmap));
-
-                pango_context_list_families (context, &families, &n);
-
-                for ( i=0; i<n; i++ )
-                {
-                        if ( !pango_font_family_is_monospace (families[i]) )
-                        {
-                                name = g_strdup (pango_font_family_get_name (families[i]));
-                                list = g_list_insert_sorted (list, name,
-                                                             (GCompareFunc)lgl_str_utf8_casecmp);
-                        }
-                }
+	return all_families;
+}
 
-                g_free (families);
 
-                g_object_unref (context);
-                g_object_unref (fontmap);
-        }
+/****************************************************************************/
+/* Get list of all available proportional font families.                    */
+/****************************************************************************/
+const GList  *
+gl_font_util_get_proportional_families (void)
+{
+        load_families ();
 
-	return list;
+	return proportional_families;
 }
 
 
@@ -114,38 +131,9 @@ gl_font_util_get_proportional_families (void)
 const GList  *
 gl_font_util_get_fixed_width_families (void)
 {
-	static GList         *list = NULL;
-	PangoFontMap         *fontmap;
-	PangoContext         *context;
-	PangoFontFamily     **families;
-	gint                  n;
-	gint                  i;
-	gchar                *name;
+        load_families ();
 
-        if ( !list )
-        {
-                fontmap = pango_cairo_font_map_new ();
-                context = pango_font_map_create_context (PANGO_FONT_MAP (fontmap));
-
-                pango_context_list_families (context, &families, &n);
-
-                for ( i=0; i<n; i++ )
-                {
-                        if ( pango_font_family_is_monospace (families[i]) )
-                        {
-                                name = g_strdup (pango_font_family_get_name (families[i]));
-                                list = g_list_insert_sorted (list, name,
-                                                             (GCompareFunc)lgl_str_utf8_casecmp);
-                        }
-                }
-
-                g_free (families);
-
-                g_object_unref (context);
-                g_object_unref (fontmap);
-        }
-
-	return list;
+	return fixed_width_families;
 }
 
 
@@ -155,26 +143,21 @@ gl_font_util_get_fixed_width_families (void)
 gchar *
 gl_font_util_validate_family (const gchar *family)
 {
-        const GList *installed_families;
         gchar       *good_family;
 
-        installed_families = gl_font_util_get_all_families ();
+        load_families ();
 
-        if (g_list_find_custom ((GList *)installed_families,
-                                family,
-                                (GCompareFunc)g_utf8_collate))
+        if ( (family != NULL) && g_hash_table_contains (installed_families, family) )
         {
                 good_family = g_strdup (family);
         }
-        else if (g_list_find_custom ((GList *)installed_families,
-                                     "Sans",
-                                     (GCompareFunc)g_utf8_collate))
+        else if ( g_hash_table_contains (installed_families, "Sans") )
         {
                 good_family = g_strdup ("Sans");
         }
-        else if (installed_families != NULL)
+        else if (all_families != NULL)
         {
-                good_family = g_strdup (installed_families->data); /* 1st entry */
+                good_family = g_strdup (all_families->data); /* 1st entry */
         }
         else
         {
@@ -191,16 +174,9 @@ gl_font_util_validate_family (const gchar *family)
 gboolean
 gl_font_util_is_family_installed (const gchar *family)
 {
-        const GList *installed_families;
-        GList       *p;
-
-        installed_families = gl_font_util_get_all_families ();
-
-        p = g_list_find_custom ((GList *)installed_families,
-                                family,
-                                (GCompareFunc)g_utf8_collate);
+        load_families ();
 
-        return (p != NULL);
+        return g_hash_table_contains (installed_families, family);
 }
 
 
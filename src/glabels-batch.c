@@ -21,20 +21,73 @@
 #include <config.h>
 
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 
 #include <math.h>
+#include <string.h>
+
+#ifdef G_OS_UNIX
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
 
 #include <libglabels.h>
 #include "merge-init.h"
+#include "merge-filter.h"
 #include "template-history.h"
 #include "font-history.h"
 #include "xml-label.h"
 #include "print.h"
 #include "print-op.h"
+#include "print-export.h"
 #include "file-util.h"
 #include "prefs.h"
 #include "debug.h"
 
+/*============================================*/
+/* Private macros and constants.              */
+/*============================================*/
+
+#define MAX_CACHED_LABELS 16
+
+
+/*============================================*/
+/* Private types                              */
+/*============================================*/
+
+/* Command line option values, used as the defaults for each service job. */
+typedef struct {
+        gchar    *output;
+        gint      n_copies;
+        gint      n_sheets;
+        gint      first;
+        gboolean  outline_flag;
+        gboolean  reverse_flag;
+        gboolean  collate_flag;
+        gboolean  crop_marks_flag;
+        gchar    *input;
+        gchar    *pages;
+        gchar    *stats;
+        gint      split_records;
+        gchar    *split_field;
+        gchar    *filter;
+        gchar    *record_range;
+        gchar    *shard;
+} JobDefaults;
+
+/* Label kept loaded by the service, valid while its file is unchanged. */
+typedef struct {
+        glLabel  *label;
+        gchar    *merge_src;
+        gint64    mtime;
+        gint64    size;
+} CachedLabel;
+
+
 /*============================================*/
 /* Private globals                            */
 /*============================================*/
@@ -47,7 +100,18 @@ static gboolean reverse_flag     = FALSE;
 static gboolean collate_flag     = FALSE;
 static gboolean crop_marks_flag  = FALSE;
 static gchar    *input           = NULL;
+static gchar    *pages           = NULL;
+static gchar    *stats           = NULL;
+static gint     split_records    = 0;
+static gchar    *split_field     = NULL;
+static gchar    *filter          = NULL;
+static gchar    *record_range    = NULL;
+static gchar    *shard           = NULL;
 static gchar    **remaining_args = NULL;
+static gboolean serve_flag       = FALSE;
+static gchar    *socket_path     = NULL;
+
+static GHashTable *label_cache   = NULL;
 
 static GOptionEntry option_entries[] = {
         {"output", 'o', 0, G_OPTION_ARG_STRING, &output,
@@ -68,13 +132,124 @@ static GOptionEntry option_entries[] = {
          N_("print crop marks"), NULL},
         {"input", 'i', 0, G_OPTION_ARG_STRING, &input,
          N_("input file for merging"), N_("filename")},
+        {"pages", 'p', 0, G_OPTION_ARG_STRING, &pages,
+         N_("only output sheets in range, e.g. \"3\", \"2-5\" or \"4-\" (default=all)"), N_("range")},
+        {"stats", 0, 0, G_OPTION_ARG_STRING, &stats,
+         N_("report per-file statistics on standard error, FORMAT must be \"json\""), N_("format")},
+        {"split-records", 0, 0, G_OPTION_ARG_INT, &split_records,
+         N_("start a new output file every N merge records"), N_("n")},
+        {"split-field", 0, 0, G_OPTION_ARG_STRING, &split_field,
+         N_("start a new output file whenever merge field KEY changes value"), N_("key")},
+        {"filter", 0, 0, G_OPTION_ARG_STRING, &filter,
+         N_("only merge records matching EXPR, e.g. 'State = \"NY\" and Age >= 18'"), N_("expr")},
+        {"records", 0, 0, G_OPTION_ARG_STRING, &record_range,
+         N_("only output merge records in range, laid out as in the whole job, e.g. \"1-1000\""), N_("range")},
+        {"shard", 0, 0, G_OPTION_ARG_STRING, &shard,
+         N_("only output part K of the sheets of the whole job split into N parts"), N_("K/N")},
         { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY,
           &remaining_args, NULL, N_("[FILE...]") },
         { NULL }
 };
 
+static GOptionEntry service_option_entries[] = {
+        {"serve", 0, 0, G_OPTION_ARG_NONE, &serve_flag,
+         N_("keep running, reading one job per line from standard input"), NULL},
+        {"socket", 0, 0, G_OPTION_ARG_FILENAME, &socket_path,
+         N_("keep running, reading one job per line from connections to a UNIX socket"), N_("path")},
+        { NULL }
+};
+
 
 
+/*============================================*/
+/* Local function prototypes                  */
+/*============================================*/
+static gboolean parse_page_range (const gchar *range,
+                                  gint        *first_sheet,
+                                  gint        *last_sheet);
+
+static gboolean check_options    (const gchar *prog_name,
+                                  gint        *first_sheet,
+                                  gint        *last_sheet);
+
+static GList   *take_file_list   (void);
+
+static gboolean print_file       (const gchar *filename,
+                                  gint         first_sheet,
+                                  gint         last_sheet,
+                                  GIOChannel  *reply);
+
+static glLabel *open_label       (const gchar      *filename,
+                                  glXMLLabelStatus *status,
+                                  gboolean         *reused_flag,
+                                  gchar           **merge_src);
+
+static void     cached_label_free (gpointer data);
+
+static void     serve_channel    (GIOChannel  *in,
+                                  GIOChannel  *out,
+                                  JobDefaults *defaults);
+
+static void     run_job_line     (const gchar *line,
+                                  GIOChannel  *out,
+                                  JobDefaults *defaults);
+
+static void     save_defaults    (JobDefaults *defaults);
+
+static void     restore_defaults (JobDefaults *defaults);
+
+static void     free_job_options (JobDefaults *defaults);
+
+#ifdef G_OS_UNIX
+static gboolean serve_socket     (const gchar *path,
+                                  JobDefaults *defaults);
+#endif
+
+static gboolean export_label     (glLabel             *label,
+                                  const gchar         *filename,
+                                  glPrintExportFormat  format,
+                                  gint                 first_sheet,
+                                  gint                 last_sheet,
+                                  const glPrintState  *state);
+
+static gboolean parse_shard      (const gchar *spec,
+                                  gint        *shard_index,
+                                  gint        *n_shards);
+
+static gboolean split_label      (glLabel             *label,
+                                  glMerge             *merge,
+                                  const gchar         *filename,
+                                  gint                 first_sheet,
+                                  gint                 last_sheet,
+                                  GIOChannel          *reply);
+
+static gchar   *part_filename_new (const gchar        *filename,
+                                   glMergeRecord      *record,
+                                   gint                i_part,
+                                   GHashTable         *used_names);
+
+static gboolean shard_label      (glLabel             *label,
+                                  glMerge             *merge,
+                                  const gchar         *filename);
+
+static glMergeRecord **get_selected_records (glMerge  *merge,
+                                             gint     *n_records);
+
+static gboolean print_op_label   (glLabel             *label,
+                                  const gchar         *filename,
+                                  gint                 first_sheet,
+                                  gint                 last_sheet);
+
+static gboolean check_sheet_range (const gchar        *filename,
+                                   gint                first_sheet,
+                                   gint                last_sheet,
+                                   gint                n_total_sheets);
+
+static void     report_stats     (const gchar *filename,
+                                  const gchar *status,
+                                  GIOChannel  *reply);
+
+
 /*****************************************************************************/
 /* Main                                                                      */
 /*****************************************************************************/
@@ -83,15 +258,11 @@ main (int argc, char **argv)
 {
 	GOptionContext    *option_context;
         GList             *p, *file_list = NULL;
-        gchar             *abs_fn;
-        glLabel           *label = NULL;
-        glMerge           *merge = NULL;
-        const lglTemplate *template;
-        lglTemplateFrame  *frame;
-        glXMLLabelStatus   status;
-        glPrintOp         *print_op;
-	gchar	          *utf8_filename;
+        gint               first_sheet = 0, last_sheet = 0;
+        JobDefaults        defaults;
+        GIOChannel        *in, *out;
         GError            *error = NULL;
+        gboolean           ok = TRUE;
 
         bindtextdomain (GETTEXT_PACKAGE, GLABELS_LOCALE_DIR);
 	bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
@@ -101,6 +272,7 @@ main (int argc, char **argv)
         g_option_context_set_summary (option_context,
                                       _("Print files created with gLabels."));
 	g_option_context_add_main_entries (option_context, option_entries, GETTEXT_PACKAGE);
+	g_option_context_add_main_entries (option_context, service_option_entries, GETTEXT_PACKAGE);
 
 
         /* Initialize minimal gtk program */
@@ -113,20 +285,21 @@ main (int argc, char **argv)
 		return 1;
 	}
 
+        if ( !check_options (argv[0], &first_sheet, &last_sheet) )
+        {
+		return 1;
+        }
 
-        /* create file list */
-	if (remaining_args != NULL) {
-		gint i, num_args;
+#ifndef G_OS_UNIX
+        if ( socket_path )
+        {
+	        g_print(_("UNIX sockets are not supported on this platform.\n"));
+		return 1;
+        }
+#endif
 
-		num_args = g_strv_length (remaining_args);
-		for (i = 0; i < num_args; ++i) {
-			utf8_filename = g_filename_to_utf8 (remaining_args[i], -1, NULL, NULL, NULL);
-			if (utf8_filename)
-				file_list = g_list_append (file_list, utf8_filename);
-		}
-		g_strfreev (remaining_args);
-		remaining_args = NULL;
-	}
+        /* create file list */
+        file_list = take_file_list ();
 
         /* initialize components */
         gl_debug_init ();
@@ -135,66 +308,1183 @@ main (int argc, char **argv)
         gl_prefs_init_null ();
 	gl_template_history_init_null ();
 	gl_font_history_init_null ();
+        if ( stats || serve_flag || socket_path )
+        {
+                gl_stats_enable ();
+        }
 
         /* now print the files */
         for (p = file_list; p; p = p->next) {
                 g_print ("LABEL FILE = %s\n", (gchar *) p->data);
-                label = gl_xml_label_open (p->data, &status);
 
+                if ( !print_file (p->data, first_sheet, last_sheet, NULL) )
+                {
+                        ok = FALSE;
+                }
+        }
+
+        g_list_free_full (file_list, g_free);
+
+
+        /* Service mode: command line options become the defaults for each job. */
+        if ( serve_flag || socket_path )
+        {
+                label_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                     g_free, cached_label_free);
+                save_defaults (&defaults);
+
+#ifdef G_OS_UNIX
+                if ( socket_path )
+                {
+                        if ( !serve_socket (socket_path, &defaults) )
+                        {
+                                return 1;
+                        }
+                }
+                else
+#endif
+                {
+                        in  = g_io_channel_unix_new (0);
+                        out = g_io_channel_unix_new (1);
+                        g_io_channel_set_encoding (in, NULL, NULL);
+                        g_io_channel_set_encoding (out, NULL, NULL);
 
-                if ( status == XML_LABEL_OK ) {
+                        serve_channel (in, out, &defaults);
 
-                        merge = gl_label_get_merge (label);
-                        if (input != NULL) {
-                                if (merge != NULL) {
-                                        gl_merge_set_src(merge, input);
-                                        gl_label_set_merge(label, merge, FALSE);
-                                } else {
-                                        fprintf ( stderr,
-                                                  _("cannot perform document merge with glabels file %s\n"),
-                                                  (char *)p->data );
+                        g_io_channel_unref (in);
+                        g_io_channel_unref (out);
+                }
+
+                g_hash_table_destroy (label_cache);
+        }
+
+        return ok ? 0 : 1;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Validate option values, and parse sheet range.                  */
+/*---------------------------------------------------------------------------*/
+static gboolean
+check_options (const gchar *prog_name,
+               gint        *first_sheet,
+               gint        *last_sheet)
+{
+        *first_sheet = 0;
+        *last_sheet  = 0;
+
+        if ( pages && !parse_page_range (pages, first_sheet, last_sheet) )
+        {
+	        g_print(_("Invalid page range \"%s\"\nRun '%s --help' to see a full list of available command line options.\n"),
+			pages, prog_name);
+		return FALSE;
+        }
+
+        if ( stats && (g_ascii_strcasecmp (stats, "json") != 0) )
+        {
+	        g_print(_("Invalid statistics format \"%s\"\nRun '%s --help' to see a full list of available command line options.\n"),
+			stats, prog_name);
+		return FALSE;
+        }
+
+        if ( split_records < 0 )
+        {
+	        g_print(_("Invalid split record count %d\nRun '%s --help' to see a full list of available command line options.\n"),
+			split_records, prog_name);
+		return FALSE;
+        }
+
+        if ( filter )
+        {
+                glMergeFilter *merge_filter;
+                GError        *error = NULL;
+
+                merge_filter = gl_merge_filter_new (filter, &error);
+                if ( merge_filter == NULL )
+                {
+                        g_print(_("Invalid filter \"%s\": %s\nRun '%s --help' to see a full list of available command line options.\n"),
+                                filter, error->message, prog_name);
+                        g_error_free (error);
+                        return FALSE;
+                }
+                gl_merge_filter_free (merge_filter);
+        }
+
+        if ( record_range || shard )
+        {
+                gint n1, n2;
+
+                if ( record_range && !parse_page_range (record_range, &n1, &n2) )
+                {
+                        g_print(_("Invalid record range \"%s\"\nRun '%s --help' to see a full list of available command line options.\n"),
+                                record_range, prog_name);
+                        return FALSE;
+                }
+                if ( shard && !parse_shard (shard, &n1, &n2) )
+                {
+                        g_print(_("Invalid shard \"%s\"\nRun '%s --help' to see a full list of available command line options.\n"),
+                                shard, prog_name);
+                        return FALSE;
+                }
+                if ( (record_range && shard) || pages || (split_records > 0) || split_field )
+                {
+                        g_print(_("--records and --shard cannot be combined with each other, --pages or --split-*\nRun '%s --help' to see a full list of available command line options.\n"),
+                                prog_name);
+                        return FALSE;
+                }
+        }
+
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Convert remaining arguments to a list of UTF-8 filenames.       */
+/*---------------------------------------------------------------------------*/
+static GList *
+take_file_list (void)
+{
+        GList  *file_list = NULL;
+	gchar  *utf8_filename;
+        gint    i, num_args;
+
+	if (remaining_args != NULL) {
+		num_args = g_strv_length (remaining_args);
+		for (i = 0; i < num_args; ++i) {
+			utf8_filename = g_filename_to_utf8 (remaining_args[i], -1, NULL, NULL, NULL);
+			if (utf8_filename)
+				file_list = g_list_append (file_list, utf8_filename);
+		}
+		g_strfreev (remaining_args);
+		remaining_args = NULL;
+	}
+
+        return file_list;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Print one label file with the current options.  Statistics are  */
+/* written to reply if given, otherwise to standard output if requested.     */
+/*---------------------------------------------------------------------------*/
+static gboolean
+print_file (const gchar *filename,
+            gint         first_sheet,
+            gint         last_sheet,
+            GIOChannel  *reply)
+{
+        gchar             *abs_fn;
+        glLabel           *label;
+        glMerge           *merge;
+        glXMLLabelStatus   status;
+        glPrintExportFormat format;
+        gboolean           reused_flag;
+        gchar             *merge_src = NULL;
+        gboolean           ok;
+
+        gl_stats_reset ();
+        gl_stats_timer_start (GL_STATS_TIMER_LOAD);
+        label = open_label (filename, &status, &reused_flag, &merge_src);
+        gl_stats_timer_stop (GL_STATS_TIMER_LOAD);
+
+        if ( status != XML_LABEL_OK )
+        {
+                fprintf ( stderr, _("cannot open glabels file %s\n"), filename );
+                report_stats (filename, "error", reply);
+                if ( label != NULL )
+                {
+                        g_object_unref (label);
+                }
+                return FALSE;
+        }
+
+        /*
+         * A label kept by the service may still hold the records of an
+         * earlier job, so it is always merged again, from its own source
+         * unless one is given.  A filter also needs the source read again,
+         * dropping records that do not match as they are read.
+         */
+        if ( input != NULL )
+        {
+                g_free (merge_src);
+                merge_src = g_strdup (input);
+        }
+
+        merge = gl_label_get_merge (label);
+        if ( (merge_src == NULL) && !reused_flag )
+        {
+                merge_src = gl_merge_get_src (merge);
+        }
+        if ( (input != NULL) || reused_flag || (filter != NULL) )
+        {
+                if (merge != NULL) {
+                        gl_stats_timer_start (GL_STATS_TIMER_MERGE);
+                        gl_merge_set_filter (merge, filter, NULL);
+                        gl_merge_set_src(merge, merge_src);
+                        gl_stats_timer_stop (GL_STATS_TIMER_MERGE);
+                        gl_label_set_merge(label, merge, FALSE);
+                } else if ( (input != NULL) || (filter != NULL) ) {
+                        fprintf ( stderr,
+                                  _("cannot perform document merge with glabels file %s\n"),
+                                  filename );
+                }
+        }
+        g_free (merge_src);
+
+        abs_fn = gl_file_util_make_absolute ( output );
+
+        gl_stats_timer_start (GL_STATS_TIMER_RENDER);
+        if ( (record_range != NULL) || (shard != NULL) )
+        {
+                ok = shard_label (label, merge, abs_fn);
+        }
+        else if ( (split_records > 0) || (split_field != NULL) )
+        {
+                ok = split_label (label, merge, abs_fn,
+                                  first_sheet, last_sheet, reply);
+        }
+        else if ( gl_print_export_format_from_filename (abs_fn, &format) )
+        {
+                ok = export_label (label, abs_fn, format,
+                                   first_sheet, last_sheet, NULL);
+        }
+        else
+        {
+                ok = print_op_label (label, abs_fn,
+                                     first_sheet, last_sheet);
+        }
+        gl_stats_timer_stop (GL_STATS_TIMER_RENDER);
+
+        report_stats (filename, ok ? "ok" : "error", reply);
+
+        g_free (abs_fn);
+        if ( merge != NULL )
+        {
+                g_object_unref (merge);
+        }
+
+        g_object_unref (label);
+
+        return ok;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Open label file, or reuse the copy kept by the service if the   */
+/* file has not changed since.  When the service keeps labels, merge_src is  */
+/* set to the merge source saved in the file.                                */
+/*---------------------------------------------------------------------------*/
+static glLabel *
+open_label (const gchar      *filename,
+            glXMLLabelStatus *status,
+            gboolean         *reused_flag,
+            gchar           **merge_src)
+{
+        gchar       *abs_fn;
+        GStatBuf     stat_buf;
+        CachedLabel *cached;
+        glLabel     *label;
+        glMerge     *merge;
+
+        *reused_flag = FALSE;
+        *merge_src   = NULL;
+
+        if ( label_cache == NULL )
+        {
+                return gl_xml_label_open (filename, status);
+        }
+
+        abs_fn = gl_file_util_make_absolute (filename);
+        if ( g_stat (abs_fn, &stat_buf) != 0 )
+        {
+                g_free (abs_fn);
+                *status = XML_LABEL_ERROR_OPEN_PARSE;
+                return NULL;
+        }
+
+        cached = g_hash_table_lookup (label_cache, abs_fn);
+        if ( (cached != NULL) &&
+             (cached->mtime == stat_buf.st_mtime) && (cached->size == stat_buf.st_size) )
+        {
+                gl_stats_inc (GL_STATS_CACHE_HITS);
+                g_free (abs_fn);
+
+                *status      = XML_LABEL_OK;
+                *reused_flag = TRUE;
+                *merge_src   = g_strdup (cached->merge_src);
+                return g_object_ref (cached->label);
+        }
+
+        gl_stats_inc (GL_STATS_CACHE_MISSES);
+
+        label = gl_xml_label_open (abs_fn, status);
+        if ( *status != XML_LABEL_OK )
+        {
+                g_hash_table_remove (label_cache, abs_fn);
+                g_free (abs_fn);
+                return label;
+        }
+
+        if ( g_hash_table_size (label_cache) >= MAX_CACHED_LABELS )
+        {
+                g_hash_table_remove_all (label_cache);
+        }
+
+        merge = gl_label_get_merge (label);
+
+        cached = g_new0 (CachedLabel, 1);
+        cached->label     = g_object_ref (label);
+        cached->merge_src = gl_merge_get_src (merge);
+        cached->mtime     = stat_buf.st_mtime;
+        cached->size      = stat_buf.st_size;
+        g_hash_table_replace (label_cache, abs_fn, cached);
+
+        *merge_src = g_strdup (cached->merge_src);
+
+        if ( merge != NULL )
+        {
+                g_object_unref (merge);
+        }
+
+        return label;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Free label kept by the service.                                 */
+/*---------------------------------------------------------------------------*/
+static void
+cached_label_free (gpointer data)
+{
+        CachedLabel *cached = data;
+
+        g_object_unref (cached->label);
+        g_free (cached->merge_src);
+        g_free (cached);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Run jobs read from in, one per line, until end of input.        */
+/* Blank lines and lines starting with '#' are ignored.                      */
+/*---------------------------------------------------------------------------*/
+static void
+serve_channel (GIOChannel  *in,
+               GIOChannel  *out,
+               JobDefaults *defaults)
+{
+        gchar     *line;
+        GIOStatus  io_status;
+
+        while ( (io_status = g_io_channel_read_line (in, &line, NULL, NULL, NULL)) != G_IO_STATUS_EOF )
+        {
+                if ( io_status == G_IO_STATUS_ERROR )
+                {
+                        break;
+                }
+                if ( io_status != G_IO_STATUS_NORMAL )
+                {
+                        continue;
+                }
+
+                g_strstrip (line);
+                if ( (*line != '\0') && (*line != '#') )
+                {
+                        run_job_line (line, out, defaults);
+                }
+
+                g_free (line);
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Run one job.  A job line has the same syntax as the command     */
+/* line, "[OPTION...] FILE...", and one status line is written per file.     */
+/*---------------------------------------------------------------------------*/
+static void
+run_job_line (const gchar *line,
+              GIOChannel  *out,
+              JobDefaults *defaults)
+{
+        gchar          **job_argv, **argv;
+        gint             job_argc, argc;
+        GOptionContext  *option_context;
+        GList           *p, *file_list;
+        gint             first_sheet, last_sheet;
+        GError          *error = NULL;
+
+        if ( !g_shell_parse_argv (line, &job_argc, &job_argv, &error) )
+        {
+                fprintf ( stderr, _("invalid job \"%s\": %s\n"), line, error->message );
+                g_error_free (error);
+                gl_stats_reset ();
+                report_stats (line, "error", out);
+                return;
+        }
+
+        /* Options are parsed as for the command line, from argv[1]. */
+        argc = job_argc + 1;
+        argv = g_new0 (gchar *, argc + 1);
+        argv[0] = g_get_prgname () ? (gchar *)g_get_prgname () : "glabels-3-batch";
+        memcpy (&argv[1], job_argv, job_argc * sizeof (gchar *));
+
+        restore_defaults (defaults);
+
+	option_context = g_option_context_new (NULL);
+	g_option_context_add_main_entries (option_context, option_entries, GETTEXT_PACKAGE);
+        g_option_context_set_help_enabled (option_context, FALSE);
+
+        if ( !g_option_context_parse (option_context, &argc, &argv, &error) ||
+             !check_options (argv[0], &first_sheet, &last_sheet) )
+        {
+                if ( error != NULL )
+                {
+                        fprintf ( stderr, _("invalid job \"%s\": %s\n"), line, error->message );
+                        g_error_free (error);
+                }
+                g_strfreev (remaining_args);
+                remaining_args = NULL;
+                gl_stats_reset ();
+                report_stats (line, "error", out);
+        }
+        else
+        {
+                file_list = take_file_list ();
+                for ( p = file_list; p != NULL; p = p->next )
+                {
+                        print_file (p->data, first_sheet, last_sheet, out);
+                }
+                g_list_free_full (file_list, g_free);
+        }
+
+        g_option_context_free (option_context);
+        free_job_options (defaults);
+
+        /* Only the array was ours, its strings belong to job_argv. */
+        g_free (argv);
+        g_strfreev (job_argv);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Save command line option values as defaults for each job.      */
+/*---------------------------------------------------------------------------*/
+static void
+save_defaults (JobDefaults *defaults)
+{
+        defaults->output          = output;
+        defaults->n_copies        = n_copies;
+        defaults->n_sheets        = n_sheets;
+        defaults->first           = first;
+        defaults->outline_flag    = outline_flag;
+        defaults->reverse_flag    = reverse_flag;
+        defaults->collate_flag    = collate_flag;
+        defaults->crop_marks_flag = crop_marks_flag;
+        defaults->input           = input;
+        defaults->pages           = pages;
+        defaults->stats           = stats;
+        defaults->split_records   = split_records;
+        defaults->split_field     = split_field;
+        defaults->filter          = filter;
+        defaults->record_range    = record_range;
+        defaults->shard           = shard;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Reset option values to defaults before parsing a job.           */
+/*---------------------------------------------------------------------------*/
+static void
+restore_defaults (JobDefaults *defaults)
+{
+        output          = defaults->output;
+        n_copies        = defaults->n_copies;
+        n_sheets        = defaults->n_sheets;
+        first           = defaults->first;
+        outline_flag    = defaults->outline_flag;
+        reverse_flag    = defaults->reverse_flag;
+        collate_flag    = defaults->collate_flag;
+        crop_marks_flag = defaults->crop_marks_flag;
+        input           = defaults->input;
+        pages           = defaults->pages;
+        stats           = defaults->stats;
+        split_records   = defaults->split_records;
+        split_field     = defaults->split_field;
+        filter          = defaults->filter;
+        record_range    = defaults->record_range;
+        shard           = defaults->shard;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Free option strings set by a job, and return to defaults.       */
+/*---------------------------------------------------------------------------*/
+static void
+free_job_options (JobDefaults *defaults)
+{
+        if ( output != defaults->output ) g_free (output);
+        if ( input  != defaults->input )  g_free (input);
+        if ( pages  != defaults->pages )  g_free (pages);
+        if ( stats  != defaults->stats )  g_free (stats);
+        if ( split_field != defaults->split_field ) g_free (split_field);
+        if ( filter != defaults->filter ) g_free (filter);
+        if ( record_range != defaults->record_range ) g_free (record_range);
+        if ( shard != defaults->shard ) g_free (shard);
+
+        restore_defaults (defaults);
+}
+
+
+#ifdef G_OS_UNIX
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Listen on a UNIX socket, serving one connection at a time.      */
+/* A stale socket left at path by an earlier service is replaced.           */
+/*---------------------------------------------------------------------------*/
+static gboolean
+serve_socket (const gchar *path,
+              JobDefaults *defaults)
+{
+        struct sockaddr_un  addr;
+        GStatBuf            stat_buf;
+        gint                fd, client_fd;
+        gint                bind_status;
+        mode_t              old_umask;
+        GIOChannel         *channel;
+
+        if ( strlen (path) >= sizeof (addr.sun_path) )
+        {
+                fprintf ( stderr, _("socket path too long: %s\n"), path );
+                return FALSE;
+        }
+
+        if ( (g_lstat (path, &stat_buf) == 0) && S_ISSOCK (stat_buf.st_mode) )
+        {
+                g_unlink (path);
+        }
+
+        memset (&addr, 0, sizeof (addr));
+        addr.sun_family = AF_UNIX;
+        strcpy (addr.sun_path, path);
+
+        fd = socket (AF_UNIX, SOCK_STREAM, 0);
+
+        /* Only the owner of the service may connect to it and submit jobs. */
+        bind_status = -1;
+        if ( fd >= 0 )
+        {
+                old_umask   = umask (0077);
+                bind_status = bind (fd, (struct sockaddr *)&addr, sizeof (addr));
+                umask (old_umask);
+        }
+
+        if ( (fd < 0) || (bind_status != 0) ||
+             (g_chmod (path, 0600) != 0) ||
+             (listen (fd, 8) != 0) )
+        {
+                fprintf ( stderr, _("cannot listen on socket %s: %s\n"),
+                          path, g_strerror (errno) );
+                if ( fd >= 0 )
+                {
+                        close (fd);
+                }
+                return FALSE;
+        }
+
+        /* A client going away must not end the service. */
+        signal (SIGPIPE, SIG_IGN);
+
+        for (;;)
+        {
+                client_fd = accept (fd, NULL, NULL);
+                if ( client_fd < 0 )
+                {
+                        if ( errno == EINTR )
+                        {
+                                continue;
+                        }
+                        fprintf ( stderr, _("cannot accept connection on socket %s: %s\n"),
+                                  path, g_strerror (errno) );
+                        break;
+                }
+
+                channel = g_io_channel_unix_new (client_fd);
+                g_io_channel_set_encoding (channel, NULL, NULL);
+                g_io_channel_set_close_on_unref (channel, TRUE);
+
+                serve_channel (channel, channel, defaults);
+
+                g_io_channel_unref (channel);
+        }
+
+        close (fd);
+        g_unlink (path);
+
+        return FALSE;
+}
+#endif
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Parse sheet range of the form "N", "N-M", "N-" or "-M".         */
+/*---------------------------------------------------------------------------*/
+static gboolean
+parse_page_range (const gchar *range,
+                  gint        *first_sheet,
+                  gint        *last_sheet)
+{
+        gchar   *end;
+        gint64   n1 = 0, n2 = 0;
+
+        if ( *range != '-' )
+        {
+                n1 = g_ascii_strtoll (range, &end, 10);
+                if ( (end == range) || (n1 < 1) || (n1 > G_MAXINT) )
+                {
+                        return FALSE;
+                }
+                range = end;
+
+                if ( *range == '\0' )
+                {
+                        /* Single sheet. */
+                        *first_sheet = *last_sheet = n1;
+                        return TRUE;
+                }
+        }
+
+        if ( *range++ != '-' )
+        {
+                return FALSE;
+        }
+
+        if ( *range != '\0' )
+        {
+                n2 = g_ascii_strtoll (range, &end, 10);
+                if ( (end == range) || (*end != '\0') || (n2 < MAX (n1, 1)) || (n2 > G_MAXINT) )
+                {
+                        return FALSE;
+                }
+        }
+
+        *first_sheet = n1;
+        *last_sheet  = n2;
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Parse shard of the form "K/N", with 1 <= K <= N.                */
+/*---------------------------------------------------------------------------*/
+static gboolean
+parse_shard (const gchar *spec,
+             gint        *shard_index,
+             gint        *n_shards)
+{
+        gchar   *end;
+        gint64   k, n;
+
+        k = g_ascii_strtoll (spec, &end, 10);
+        if ( (end == spec) || (*end != '/') )
+        {
+                return FALSE;
+        }
+        spec = end + 1;
+
+        n = g_ascii_strtoll (spec, &end, 10);
+        if ( (end == spec) || (*end != '\0') || (k < 1) || (k > n) || (n > G_MAXINT) )
+        {
+                return FALSE;
+        }
+
+        *shard_index = k;
+        *n_shards    = n;
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Export label directly to a PDF, PostScript or SVG file.         */
+/*---------------------------------------------------------------------------*/
+static gboolean
+export_label (glLabel             *label,
+              const gchar         *filename,
+              glPrintExportFormat  format,
+              gint                 first_sheet,
+              gint                 last_sheet,
+              const glPrintState  *state)
+{
+        glPrintExportOptions options;
+        GError              *error = NULL;
+
+        gl_print_export_options_init (&options, label);
+        options.n_sheets        = n_sheets;
+        options.n_copies        = n_copies;
+        options.first           = first;
+        options.first_sheet     = first_sheet;
+        options.last_sheet      = last_sheet;
+        options.outline_flag    = outline_flag;
+        options.reverse_flag    = reverse_flag;
+        options.collate_flag    = collate_flag;
+        options.crop_marks_flag = crop_marks_flag;
+        options.state           = state;
+
+        if ( !gl_print_export (label, filename, format, &options, &error) )
+        {
+                if ( (error->domain == GL_PRINT_EXPORT_ERROR) &&
+                     (error->code == GL_PRINT_EXPORT_ERROR_RANGE) )
+                {
+                        fprintf ( stderr, _("cannot write %s: %s\n"),
+                                  filename, error->message );
+                }
+                else
+                {
+                        /* File and render errors already name the file. */
+                        fprintf ( stderr, "%s\n", error->message );
+                }
+                g_error_free (error);
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Export merged label in parts, from a single read of its merge   */
+/* source.  A part ends after --split-records records, or before the first   */
+/* record whose --split-field value differs from the first of the part.      */
+/* Each file is complete before the next part is rendered.                   */
+/*---------------------------------------------------------------------------*/
+static gboolean
+split_label (glLabel     *label,
+             glMerge     *merge,
+             const gchar *filename,
+             gint         first_sheet,
+             gint         last_sheet,
+             GIOChannel  *reply)
+{
+        glPrintExportFormat  format;
+        glMergeRecord      **records;
+        gint                 n_records, i_start, i, i_part;
+        gchar               *start_value, *value;
+        gboolean             changed;
+        GHashTable          *used_names;
+        gchar               *part_filename;
+        glPrintState         state;
+        gboolean             ok = TRUE;
+
+        if ( !gl_print_export_format_from_filename (filename, &format) )
+        {
+                fprintf ( stderr, _("cannot split %s: output must be a PDF, PostScript or SVG file\n"),
+                          filename );
+                return FALSE;
+        }
+
+        if ( merge == NULL )
+        {
+                fprintf ( stderr, _("cannot split %s: label has no merge source\n"),
+                          filename );
+                return FALSE;
+        }
+
+        records = get_selected_records (merge, &n_records);
+
+        used_names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+        i_part = 0;
+        for ( i_start = 0; ok && (i_start < n_records); i_start = i )
+        {
+                start_value = NULL;
+                if ( split_field != NULL )
+                {
+                        start_value = gl_merge_eval_key (records[i_start], split_field);
+                }
+
+                for ( i = i_start + 1; i < n_records; i++ )
+                {
+                        if ( (split_records > 0) && ((i - i_start) >= split_records) )
+                        {
+                                break;
+                        }
+
+                        if ( split_field != NULL )
+                        {
+                                value   = gl_merge_eval_key (records[i], split_field);
+                                changed = (g_strcmp0 (value, start_value) != 0);
+                                g_free (value);
+
+                                if ( changed )
+                                {
+                                        break;
                                 }
                         }
-                        abs_fn = gl_file_util_make_absolute ( output );
-                        template = gl_label_get_template (label);
-                        frame = (lglTemplateFrame *)template->frames->data;
-
-                        print_op = gl_print_op_new (label);
-                        gl_print_op_set_filename        (print_op, abs_fn);
-                        gl_print_op_set_n_copies        (print_op, n_copies);
-                        gl_print_op_set_first           (print_op, first);
-                        gl_print_op_set_outline_flag    (print_op, outline_flag);
-                        gl_print_op_set_reverse_flag    (print_op, reverse_flag);
-                        gl_print_op_set_collate_flag    (print_op, collate_flag);
-                        gl_print_op_set_crop_marks_flag (print_op, crop_marks_flag);
-                        if (merge)
+                }
+                g_free (start_value);
+
+                /* Part is a window onto records, nothing to free. */
+                state.merge       = NULL;
+                state.records     = &records[i_start];
+                state.n_records   = i - i_start;
+                state.own_records = FALSE;
+
+                part_filename = part_filename_new (filename, records[i_start], ++i_part, used_names);
+
+                ok = export_label (label, part_filename, format,
+                                   first_sheet, last_sheet, &state);
+                if ( ok && (reply == NULL) )
+                {
+                        g_print ("OUTPUT FILE = %s\n", part_filename);
+                }
+
+                g_free (part_filename);
+        }
+
+        g_hash_table_destroy (used_names);
+        g_free (records);
+
+        return ok;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Output filename for a part.  Each "${KEY}" in filename is       */
+/* replaced by the value of KEY in the first record of the part.  Without    */
+/* such a reference, or if the name was already used, the part number is     */
+/* inserted before the extension.  Values that are empty, "." or ".." are    */
+/* replaced by "_".                                                          */
+/*---------------------------------------------------------------------------*/
+static gchar *
+part_filename_new (const gchar   *filename,
+                   glMergeRecord *record,
+                   gint           i_part,
+                   GHashTable    *used_names)
+{
+        GString     *str;
+        const gchar *s, *end;
+        gchar       *key, *value, *v;
+        gboolean     field_flag = FALSE;
+        gchar       *name, *numbered_name;
+
+        str = g_string_new (NULL);
+        for ( s = filename; *s != '\0'; )
+        {
+                if ( (s[0] == '$') && (s[1] == '{') && ((end = strchr (s+2, '}')) != NULL) )
+                {
+                        key   = g_strndup (s+2, end - (s+2));
+                        value = gl_merge_eval_key (record, key);
+
+                        /* Field values must not add or climb directories. */
+                        if ( (value == NULL) || (*value == '\0') ||
+                             g_str_equal (value, ".") || g_str_equal (value, "..") )
                         {
-                                gl_print_op_set_n_sheets (print_op,
-                                                          ceil ((double)(first-1 + n_copies * gl_merge_get_record_count(merge))
-                                                                / lgl_template_frame_get_n_labels (frame)));
+                                g_free (value);
+                                value = g_strdup ("_");
                         }
-                        else
+                        for ( v = value; *v != '\0'; v++ )
                         {
-                                gl_print_op_set_n_sheets (print_op, n_sheets);
-                                gl_print_op_set_last     (print_op,
-                                                          lgl_template_frame_get_n_labels (frame));
+                                if ( (*v == '/') || (*v == G_DIR_SEPARATOR) )
+                                {
+                                        *v = '_';
+                                }
                         }
-                        gtk_print_operation_run (GTK_PRINT_OPERATION (print_op),
-                                                 GTK_PRINT_OPERATION_ACTION_EXPORT,
-                                                 NULL,
-                                                 NULL);
+                        g_string_append (str, value);
 
-                        g_object_unref (label);
+                        g_free (key);
+                        g_free (value);
+                        field_flag = TRUE;
+                        s = end + 1;
                 }
-                else {
-                        fprintf ( stderr, _("cannot open glabels file %s\n"),
-                                  (char *)p->data );
+                else
+                {
+                        g_string_append_c (str, *s++);
                 }
         }
+        name = g_string_free (str, FALSE);
+
+        if ( !field_flag || g_hash_table_contains (used_names, name) )
+        {
+                numbered_name = gl_file_util_insert_number (name, i_part);
+                g_free (name);
+                name = numbered_name;
+        }
 
-        g_list_free (file_list);
+        g_hash_table_add (used_names, g_strdup (name));
+
+        return name;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Export one slice of a merged label, from the layout of the      */
+/* whole job, so that slices produced by separate runs concatenate into the  */
+/* output of a single run.  --shard=K/N takes the K-th of N nearly equal     */
+/* runs of sheets.  --records=A-B takes the sheets holding records A to B,   */
+/* which must start and end on sheet boundaries so that no sheet belongs to  */
+/* two slices.                                                               */
+/*---------------------------------------------------------------------------*/
+static gboolean
+shard_label (glLabel     *label,
+             glMerge     *merge,
+             const gchar *filename)
+{
+        glPrintExportFormat     format;
+        const lglTemplate      *template;
+        const lglTemplateFrame *frame;
+        glPrintState            state;
+        gint                    n_labels, n_total_sheets, c;
+        gint                    k, n, a, b;
+        gint64                  min_item, max_item;
+        gint                    first_sheet, last_sheet;
+        gboolean                ok = TRUE;
+
+        if ( !gl_print_export_format_from_filename (filename, &format) )
+        {
+                fprintf ( stderr, _("cannot shard %s: output must be a PDF, PostScript or SVG file\n"),
+                          filename );
+                return FALSE;
+        }
+
+        if ( merge == NULL )
+        {
+                fprintf ( stderr, _("cannot shard %s: label has no merge source\n"),
+                          filename );
+                return FALSE;
+        }
+
+        template = gl_label_get_template (label);
+        frame    = (lglTemplateFrame *)template->frames->data;
+        n_labels = lgl_template_frame_get_n_labels (frame);
+
+        state.merge       = NULL;
+        state.records     = get_selected_records (merge, &state.n_records);
+        state.own_records = FALSE;
+        n_total_sheets = gl_print_state_get_n_sheets (&state, n_copies, first, n_labels);
+
+        if ( shard != NULL )
+        {
+                parse_shard (shard, &k, &n);
+
+                first_sheet = ((gint64)(k - 1) * n_total_sheets) / n + 1;
+                last_sheet  = ((gint64)k * n_total_sheets) / n;
+        }
+        else
+        {
+                parse_page_range (record_range, &a, &b);
+                a = MAX (a, 1);
+                b = (b > 0) ? MIN (b, state.n_records) : state.n_records;
+
+                /* Uncollated copies spread each record over the whole job. */
+                c = MAX (n_copies, 1);
+                if ( (c > 1) && !collate_flag && (a <= b) &&
+                     ((a > 1) || (b < state.n_records)) )
+                {
+                        fprintf ( stderr, _("cannot slice %s by records: uncollated copies are spread over all sheets, use --shard\n"),
+                                  filename );
+                        g_free (state.records);
+                        return FALSE;
+                }
+
+                /* Same item order as gl_print_state_get_record(). */
+                min_item = (gint64)(a - 1) * c;
+                max_item = (gint64)b * c - 1;
+
+                /* A sheet shared with the next or previous slice would be printed twice. */
+                if ( (a <= b) &&
+                     ( ((a > 1) && ((first - 1 + min_item) % n_labels != 0)) ||
+                       ((b < state.n_records) && ((first + max_item) % n_labels != 0)) ) )
+                {
+                        fprintf ( stderr, _("cannot slice %s by records: records %d-%d do not start and end on sheet boundaries (%d labels per sheet)\n"),
+                                  filename, a, b, n_labels );
+                        g_free (state.records);
+                        return FALSE;
+                }
+
+                first_sheet = (first - 1 + min_item) / n_labels + 1;
+                last_sheet  = (first - 1 + max_item) / n_labels + 1;
+
+                if ( a > b )
+                {
+                        last_sheet = first_sheet - 1;
+                }
+        }
 
-        return 0;
+        if ( first_sheet > last_sheet )
+        {
+                /* Nothing in this slice, so there is nothing to add to the whole. */
+                fprintf ( stderr, _("%s: no sheets in this slice, nothing written\n"),
+                          filename );
+        }
+        else
+        {
+                ok = export_label (label, filename, format,
+                                   first_sheet, last_sheet, &state);
+        }
+
+        g_free (state.records);
+
+        return ok;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Array of the selected records of merge, in order.  The records  */
+/* belong to merge; free the array only.                                     */
+/*---------------------------------------------------------------------------*/
+static glMergeRecord **
+get_selected_records (glMerge *merge,
+                      gint    *n_records)
+{
+        glMergeRecord **records;
+        const GList    *list, *p;
+
+        /* Read the records first, so that the count is of the same records. */
+        list       = gl_merge_get_record_list (merge);
+        records    = g_new (glMergeRecord *, MAX (gl_merge_get_record_count (merge), 1));
+        *n_records = 0;
+        for ( p = list; p != NULL; p = p->next )
+        {
+                if ( ((glMergeRecord *)p->data)->select_flag )
+                {
+                        records[(*n_records)++] = p->data;
+                }
+        }
+
+        return records;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Print label through a GtkPrintOperation, for output formats     */
+/* not handled by export_label().                                            */
+/*---------------------------------------------------------------------------*/
+static gboolean
+print_op_label (glLabel     *label,
+                const gchar *filename,
+                gint         first_sheet,
+                gint         last_sheet)
+{
+        glMerge                *merge;
+        const lglTemplate      *template;
+        const lglTemplateFrame *frame;
+        glPrintOp              *print_op;
+        gint                    n_total_sheets;
+        GtkPrintOperationResult result;
+        GStatBuf                stat_buf;
+
+        merge    = gl_label_get_merge (label);
+        template = gl_label_get_template (label);
+        frame    = (lglTemplateFrame *)template->frames->data;
+
+        print_op = gl_print_op_new (label);
+        gl_print_op_set_filename        (print_op, (gchar *)filename);
+        gl_print_op_set_n_copies        (print_op, n_copies);
+        gl_print_op_set_first           (print_op, first);
+        gl_print_op_set_outline_flag    (print_op, outline_flag);
+        gl_print_op_set_reverse_flag    (print_op, reverse_flag);
+        gl_print_op_set_collate_flag    (print_op, collate_flag);
+        gl_print_op_set_crop_marks_flag (print_op, crop_marks_flag);
+        gl_print_op_set_sheet_range     (print_op, first_sheet, last_sheet);
+        if (merge)
+        {
+                n_total_sheets = ceil ((double)(first-1 + n_copies * gl_merge_get_record_count(merge))
+                                       / lgl_template_frame_get_n_labels (frame));
+                g_object_unref (merge);
+        }
+        else
+        {
+                n_total_sheets = n_sheets;
+                gl_print_op_set_last     (print_op,
+                                          lgl_template_frame_get_n_labels (frame));
+        }
+        gl_print_op_set_n_sheets (print_op, n_total_sheets);
+
+        if ( !check_sheet_range (filename, first_sheet, last_sheet, n_total_sheets) )
+        {
+                g_object_unref (print_op);
+                return FALSE;
+        }
+
+        result = gtk_print_operation_run (GTK_PRINT_OPERATION (print_op),
+                                          GTK_PRINT_OPERATION_ACTION_EXPORT,
+                                          NULL,
+                                          NULL);
+        g_object_unref (print_op);
+
+        if ( result != GTK_PRINT_OPERATION_RESULT_APPLY )
+        {
+                fprintf ( stderr, _("cannot write %s\n"), filename );
+                return FALSE;
+        }
+
+        if ( g_stat (filename, &stat_buf) == 0 )
+        {
+                gl_stats_add (GL_STATS_BYTES_WRITTEN, stat_buf.st_size);
+        }
+
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Check that --pages selects at least one of the n_total_sheets   */
+/* sheets of the document, complaining if not.                               */
+/*---------------------------------------------------------------------------*/
+static gboolean
+check_sheet_range (const gchar *filename,
+                   gint         first_sheet,
+                   gint         last_sheet,
+                   gint         n_total_sheets)
+{
+        if ( pages == NULL )
+        {
+                return TRUE;
+        }
+
+        if ( (MAX (first_sheet, 1) > n_total_sheets) ||
+             ((last_sheet > 0) && (last_sheet < MAX (first_sheet, 1))) )
+        {
+                fprintf ( stderr, _("cannot write %s: pages %s are not among the %d sheets of the document\n"),
+                          filename, pages, n_total_sheets );
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Print statistics for one label file as a line of JSON, to reply */
+/* if given, otherwise to standard error if requested with --stats, so that  */
+/* it stays apart from the other output.                                     */
+/*---------------------------------------------------------------------------*/
+static void
+report_stats (const gchar *filename,
+              const gchar *status,
+              GIOChannel  *reply)
+{
+        gchar *json;
+
+        if ( (reply == NULL) && (stats == NULL) )
+        {
+                return;
+        }
+
+        json = gl_stats_report_json (filename, status);
+        if ( reply != NULL )
+        {
+                /* Messages printed through stdio for this job go out first. */
+                fflush (stdout);
+
+                g_io_channel_write_chars (reply, json, -1, NULL, NULL);
+                g_io_channel_write_chars (reply, "\n", 1, NULL, NULL);
+                g_io_channel_flush (reply, NULL);
+        }
+        else
+        {
+                g_printerr ("%s\n", json);
+        }
+        g_free (json);
 }
 
 
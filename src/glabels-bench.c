@@ -0,0 +1,717 @@
+/*
+ *  glabels-bench.c
+ *  Copyright (C) 2001-2009  Jim Evins <evins@snaught.com>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmark harness for the merge and render pipeline.  A synthetic label
+ * (merged text, 1D and 2D barcodes, an image) is merged with a generated CSV
+ * file and printed into null, recording, image and PDF cairo surfaces.  A
+ * final stage builds one stand-alone 2D symbol per record and keeps them all
+ * alive, so that the heap footprint of barcode shapes can be compared.  For
+ * each stage the elapsed time, throughput, heap growth and peak RSS are
+ * reported, so that runs can be compared from one build to the next.
+ */
+
+#include <config.h>
+
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#include <math.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#ifdef HAVE_MALLOC_H
+#include <malloc.h>
+#endif
+
+#include <cairo/cairo.h>
+#include <cairo/cairo-pdf.h>
+
+#include <libglabels.h>
+#include "merge-init.h"
+#include "template-history.h"
+#include "font-history.h"
+#include "label.h"
+#include "label-text.h"
+#include "label-barcode.h"
+#include "label-image.h"
+#include "bc-backends.h"
+#include "print.h"
+#include "prefs.h"
+#include "debug.h"
+
+
+/*============================================*/
+/* Private types                              */
+/*============================================*/
+typedef enum {
+        SURFACE_NULL,
+        SURFACE_RECORDING,
+        SURFACE_IMAGE,
+        SURFACE_PDF
+} SurfaceType;
+
+typedef struct {
+        const gchar *name;
+        gint64       start_time;
+        gint64       heap_start;
+} BenchStage;
+
+
+/*============================================*/
+/* Private globals                            */
+/*============================================*/
+static gint      n_records       = 1000;
+static gint      n_repeats       = 1;
+static gchar    *template_name   = "Avery 5160";
+static gdouble   dpi             = 300.0;
+
+static GOptionEntry option_entries[] = {
+        {"records", 'n', 0, G_OPTION_ARG_INT, &n_records,
+         N_("number of synthetic merge records (default=1000)"), N_("records")},
+        {"repeat", 'r', 0, G_OPTION_ARG_INT, &n_repeats,
+         N_("number of times to repeat each render stage (default=1)"), N_("n")},
+        {"template", 't', 0, G_OPTION_ARG_STRING, &template_name,
+         N_("template name (default=\"Avery 5160\")"), N_("name")},
+        {"dpi", 'd', 0, G_OPTION_ARG_DOUBLE, &dpi,
+         N_("resolution of image surface stage (default=300)"), N_("dpi")},
+        { NULL }
+};
+
+static const struct {
+        const gchar *name;
+        SurfaceType  type;
+} render_stages[] = {
+        { "null",      SURFACE_NULL },
+        { "recording", SURFACE_RECORDING },
+        { "image",     SURFACE_IMAGE },
+        { "pdf",       SURFACE_PDF }
+};
+
+/* 2D symbologies in order of preference, depending on configured backends. */
+static const struct {
+        const gchar *backend_id;
+        const gchar *id;
+} barcode_2d_styles[] = {
+        { "libqrencode", "IEC18004" },
+        { "zint",        "QR" },
+        { "libiec16022", "IEC16022" }
+};
+
+
+
+/*============================================*/
+/* Local function prototypes                  */
+/*============================================*/
+static gchar          *write_merge_file  (const gchar       *dir,
+                                          gint               n);
+
+static gchar          *write_image_file  (const gchar       *dir);
+
+static gint             find_2d_style     (void);
+
+static glLabel        *build_label       (const lglTemplate *template,
+                                          const gchar       *image_filename);
+
+static GPtrArray      *build_barcodes    (gint               i_style,
+                                          gint               n,
+                                          guint64           *n_shapes);
+
+static void            add_barcode       (glLabel           *label,
+                                          const gchar       *backend_id,
+                                          const gchar       *id,
+                                          const gchar       *data,
+                                          gdouble            x,
+                                          gdouble            y,
+                                          gdouble            w,
+                                          gdouble            h);
+
+static void            render_sheets     (glLabel           *label,
+                                          SurfaceType        type);
+
+static cairo_status_t  count_bytes       (void              *closure,
+                                          const guchar      *data,
+                                          guint              length);
+
+static void            stage_begin       (BenchStage        *stage,
+                                          const gchar       *name);
+
+static void            stage_end         (BenchStage        *stage);
+
+static gint64          get_heap_in_use   (void);
+
+static glong           get_peak_rss      (void);
+
+
+/*****************************************************************************/
+/* Main                                                                      */
+/*****************************************************************************/
+int
+main (int argc, char **argv)
+{
+        GOptionContext    *option_context;
+        lglTemplate       *template;
+        gchar             *tmp_dir;
+        gchar             *merge_filename;
+        gchar             *image_filename;
+        glLabel           *label;
+        glMerge           *merge;
+        BenchStage         stage;
+        GPtrArray         *barcodes;
+        guint64            n_shapes;
+        gint               i_2d;
+        guint              i;
+        GError            *error = NULL;
+
+        bindtextdomain (GETTEXT_PACKAGE, GLABELS_LOCALE_DIR);
+        bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
+        textdomain (GETTEXT_PACKAGE);
+
+        option_context = g_option_context_new (NULL);
+        g_option_context_set_summary (option_context,
+                                      _("Benchmark the gLabels merge and render pipeline."));
+        g_option_context_add_main_entries (option_context, option_entries, GETTEXT_PACKAGE);
+
+        /* Initialize minimal gtk program */
+        gtk_parse_args (&argc, &argv);
+        if (!g_option_context_parse (option_context, &argc, &argv, &error))
+        {
+                g_print(_("%s\nRun '%s --help' to see a full list of available command line options.\n"),
+                        error->message, argv[0]);
+                g_error_free (error);
+                return 1;
+        }
+
+        if ( (n_records < 1) || (n_repeats < 1) || (dpi <= 0) )
+        {
+                g_print(_("Invalid option value\nRun '%s --help' to see a full list of available command line options.\n"),
+                        argv[0]);
+                return 1;
+        }
+
+        /* initialize components */
+        gl_debug_init ();
+        gl_merge_init ();
+        lgl_db_init ();
+        gl_prefs_init_null ();
+        gl_template_history_init_null ();
+        gl_font_history_init_null ();
+        gl_stats_enable ();
+
+        template = lgl_db_lookup_template_from_name (template_name);
+        if ( template == NULL )
+        {
+                g_printerr (_("Unknown template \"%s\"\n"), template_name);
+                return 1;
+        }
+
+        tmp_dir = g_dir_make_tmp ("glabels-bench-XXXXXX", &error);
+        if ( tmp_dir == NULL )
+        {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+                return 1;
+        }
+        merge_filename = write_merge_file (tmp_dir, n_records);
+        image_filename = write_image_file (tmp_dir);
+
+        label = build_label (template, image_filename);
+
+        g_print ("template = %s, records = %d, repeat = %d, dpi = %g\n\n",
+                 template_name, n_records, n_repeats, dpi);
+        g_print ("%-10s %10s %10s %12s %10s %12s %12s %12s\n",
+                 "stage", "seconds", "items", "items/sec",
+                 "barcodes", "bytes", "heap KiB", "peak RSS KiB");
+
+        stage_begin (&stage, "merge");
+        merge = gl_merge_new ("Text/Comma/Line1Keys");
+        gl_merge_set_src (merge, merge_filename);
+        gl_label_set_merge (label, merge, FALSE);
+        g_object_unref (merge);
+        stage_end (&stage);
+
+        for ( i = 0; i < G_N_ELEMENTS (render_stages); i++ )
+        {
+                stage_begin (&stage, render_stages[i].name);
+                render_sheets (label, render_stages[i].type);
+                stage_end (&stage);
+        }
+
+        i_2d = find_2d_style ();
+        if ( i_2d >= 0 )
+        {
+                /* Symbols are freed after stage_end, so heap KiB is what they hold. */
+                stage_begin (&stage, "2d-symbols");
+                barcodes = build_barcodes (i_2d, n_records, &n_shapes);
+                stage_end (&stage);
+
+                g_print ("\n%s/%s: %d symbols, %" G_GUINT64_FORMAT " shapes (%.1f per symbol)\n",
+                         barcode_2d_styles[i_2d].backend_id, barcode_2d_styles[i_2d].id,
+                         n_records, n_shapes, (gdouble)n_shapes / n_records);
+
+                g_ptr_array_free (barcodes, TRUE);
+        }
+
+        g_object_unref (label);
+        lgl_template_free (template);
+
+        g_unlink (merge_filename);
+        g_unlink (image_filename);
+        g_rmdir (tmp_dir);
+        g_free (merge_filename);
+        g_free (image_filename);
+        g_free (tmp_dir);
+
+        return 0;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Generate CSV merge source with keys on first line.              */
+/*---------------------------------------------------------------------------*/
+static gchar *
+write_merge_file (const gchar *dir,
+                  gint         n)
+{
+        gchar   *filename;
+        GString *str;
+        gint     i;
+        GError  *error = NULL;
+
+        filename = g_build_filename (dir, "bench.csv", NULL);
+
+        str = g_string_new ("name,code,qty,city\n");
+        for ( i = 0; i < n; i++ )
+        {
+                g_string_append_printf (str, "\"Customer %d, Ltd.\",A%07d,%d,City %d\n",
+                                        i + 1, i + 1, (i * 37) % 1000, i % 97);
+        }
+
+        if ( !g_file_set_contents (filename, str->str, str->len, &error) )
+        {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+        }
+
+        g_string_free (str, TRUE);
+
+        return filename;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Generate small PNG image.                                       */
+/*---------------------------------------------------------------------------*/
+static gchar *
+write_image_file (const gchar *dir)
+{
+        gchar     *filename;
+        GdkPixbuf *pixbuf;
+        guchar    *pixels, *p;
+        gint       rowstride;
+        gint       x, y;
+        GError    *error = NULL;
+
+        filename = g_build_filename (dir, "bench.png", NULL);
+
+        pixbuf    = gdk_pixbuf_new (GDK_COLORSPACE_RGB, TRUE, 8, 128, 128);
+        pixels    = gdk_pixbuf_get_pixels (pixbuf);
+        rowstride = gdk_pixbuf_get_rowstride (pixbuf);
+
+        for ( y = 0; y < 128; y++ )
+        {
+                p = pixels + y*rowstride;
+                for ( x = 0; x < 128; x++ )
+                {
+                        *p++ = 2*x;
+                        *p++ = 2*y;
+                        *p++ = (x ^ y) & 0xFF;
+                        *p++ = 0xFF;
+                }
+        }
+
+        if ( !gdk_pixbuf_save (pixbuf, filename, "png", &error, NULL) )
+        {
+                g_printerr ("%s\n", error->message);
+                g_error_free (error);
+        }
+
+        g_object_unref (pixbuf);
+
+        return filename;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Index of first usable 2D symbology, -1 if none is configured.   */
+/*---------------------------------------------------------------------------*/
+static gint
+find_2d_style (void)
+{
+        guint i;
+
+        for ( i = 0; i < G_N_ELEMENTS (barcode_2d_styles); i++ )
+        {
+                if ( gl_barcode_backends_is_backend_id_valid (barcode_2d_styles[i].backend_id) )
+                {
+                        return i;
+                }
+        }
+
+        return -1;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Build synthetic label exercising text, barcode and image        */
+/* objects.                                                                  */
+/*---------------------------------------------------------------------------*/
+static glLabel *
+build_label (const lglTemplate *template,
+             const gchar       *image_filename)
+{
+        glLabel      *label;
+        GObject      *object;
+        glTextNode   *filename_node;
+        gdouble       w, h;
+        gint          i_2d;
+
+        label = GL_LABEL (gl_label_new ());
+        gl_label_set_template (label, template, FALSE);
+        gl_label_get_size (label, &w, &h);
+
+        object = gl_label_text_new (label, FALSE);
+        gl_label_text_set_text (GL_LABEL_TEXT (object),
+                                "${name}\n${city}  Qty: ${qty}", FALSE);
+        gl_label_object_set_position (GL_LABEL_OBJECT (object), 0.05*w, 0.05*h, FALSE);
+
+        add_barcode (label, "built-in", "Code39", "${code}",
+                     0.05*w, 0.50*h, 0.55*w, 0.45*h);
+
+        i_2d = find_2d_style ();
+        if ( i_2d >= 0 )
+        {
+                add_barcode (label,
+                             barcode_2d_styles[i_2d].backend_id,
+                             barcode_2d_styles[i_2d].id,
+                             "${code}/${qty}",
+                             0.65*w, 0.05*h, 0.30*h, 0.30*h);
+        }
+        else
+        {
+                g_printerr ("No 2D barcode backend configured, skipping 2D barcode.\n");
+        }
+
+        object = gl_label_image_new (label, FALSE);
+        filename_node = gl_text_node_new_from_text (image_filename);
+        gl_label_image_set_filename (GL_LABEL_IMAGE (object), filename_node, FALSE);
+        gl_text_node_free (&filename_node);
+        gl_label_object_set_position (GL_LABEL_OBJECT (object), 0.65*w, 0.55*h, FALSE);
+        gl_label_object_set_size (GL_LABEL_OBJECT (object), 0.40*h, 0.40*h, FALSE);
+
+        return label;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Add barcode object with merged data.                            */
+/*---------------------------------------------------------------------------*/
+static void
+add_barcode (glLabel     *label,
+             const gchar *backend_id,
+             const gchar *id,
+             const gchar *data,
+             gdouble      x,
+             gdouble      y,
+             gdouble      w,
+             gdouble      h)
+{
+        GObject             *object;
+        glLabelBarcodeStyle *style;
+        glTextNode          *text_node;
+
+        object = gl_label_barcode_new (label, FALSE);
+
+        style = gl_label_barcode_style_new ();
+        gl_label_barcode_style_set_backend_id (style, backend_id);
+        gl_label_barcode_style_set_style_id (style, id);
+        style->text_flag     = TRUE;
+        style->checksum_flag = TRUE;
+        gl_label_barcode_set_style (GL_LABEL_BARCODE (object), style, FALSE);
+        gl_label_barcode_style_free (style);
+
+        text_node = gl_text_node_new_from_text (data);
+        gl_label_barcode_set_data (GL_LABEL_BARCODE (object), text_node, FALSE);
+        gl_text_node_free (&text_node);
+
+        gl_label_object_set_position (GL_LABEL_OBJECT (object), x, y, FALSE);
+        gl_label_object_set_size (GL_LABEL_OBJECT (object), w, h, FALSE);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Build n stand-alone 2D symbols with record-like data.           */
+/*---------------------------------------------------------------------------*/
+static GPtrArray *
+build_barcodes (gint     i_style,
+                gint     n,
+                guint64 *n_shapes)
+{
+        GPtrArray  *barcodes;
+        lglBarcode *bc;
+        gchar      *data;
+        gint        i;
+
+        barcodes  = g_ptr_array_new_full (n, (GDestroyNotify)lgl_barcode_free);
+        *n_shapes = 0;
+
+        for ( i = 0; i < n; i++ )
+        {
+                data = g_strdup_printf ("A%07d/%d", i + 1, (i * 37) % 1000);
+                bc = gl_barcode_backends_new_barcode (barcode_2d_styles[i_style].backend_id,
+                                                      barcode_2d_styles[i_style].id,
+                                                      TRUE, TRUE, 72.0, 72.0, data);
+                g_free (data);
+
+                if ( bc != NULL )
+                {
+                        *n_shapes += lgl_barcode_get_n_shapes (bc);
+                        g_ptr_array_add (barcodes, bc);
+                }
+        }
+
+        return barcodes;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Print all merged sheets into the given type of surface.         */
+/*---------------------------------------------------------------------------*/
+static void
+render_sheets (glLabel     *label,
+               SurfaceType  type)
+{
+        const lglTemplate      *template;
+        const lglTemplateFrame *frame;
+        glPrintState            state;
+        gint                    n_sheets, i_sheet, i_repeat;
+        gdouble                 scale;
+        cairo_surface_t        *surface;
+        cairo_t                *cr;
+        gint64                  n_bytes = 0;
+
+        template = gl_label_get_template (label);
+        frame    = (lglTemplateFrame *)template->frames->data;
+        scale    = dpi / 72.0;
+
+        gl_print_state_init (&state, label);
+        n_sheets = gl_print_state_get_n_sheets (&state, 1, 1,
+                                                lgl_template_frame_get_n_labels (frame));
+
+        for ( i_repeat = 0; i_repeat < n_repeats; i_repeat++ )
+        {
+                switch (type)
+                {
+                case SURFACE_NULL:
+                        surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 1, 1);
+                        break;
+                case SURFACE_IMAGE:
+                        surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                                              ceil (scale * template->page_width),
+                                                              ceil (scale * template->page_height));
+                        break;
+                case SURFACE_PDF:
+                        surface = cairo_pdf_surface_create_for_stream (count_bytes, &n_bytes,
+                                                                       template->page_width,
+                                                                       template->page_height);
+                        break;
+                default:
+                        /* Recording surfaces are created per sheet, below. */
+                        surface = NULL;
+                        break;
+                }
+
+                for ( i_sheet = 0; i_sheet < n_sheets; i_sheet++ )
+                {
+                        if ( type == SURFACE_RECORDING )
+                        {
+                                surface = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
+                        }
+
+                        cr = cairo_create (surface);
+
+                        switch (type)
+                        {
+                        case SURFACE_NULL:
+                                /* Empty clip: everything up to the cairo calls is still done. */
+                                cairo_rectangle (cr, 0, 0, 0, 0);
+                                cairo_clip (cr);
+                                break;
+                        case SURFACE_IMAGE:
+                                cairo_set_source_rgb (cr, 1, 1, 1);
+                                cairo_paint (cr);
+                                cairo_scale (cr, scale, scale);
+                                break;
+                        default:
+                                break;
+                        }
+
+                        gl_print_collated_merge_sheet (label, cr, i_sheet, 1, 1,
+                                                       FALSE, FALSE, FALSE, &state);
+
+                        if ( type == SURFACE_PDF )
+                        {
+                                cairo_show_page (cr);
+                        }
+
+                        cairo_destroy (cr);
+
+                        if ( type == SURFACE_RECORDING )
+                        {
+                                cairo_surface_destroy (surface);
+                        }
+                }
+
+                if ( type != SURFACE_RECORDING )
+                {
+                        cairo_surface_finish (surface);
+                        cairo_surface_destroy (surface);
+                }
+        }
+
+        gl_stats_add (GL_STATS_BYTES_WRITTEN, n_bytes);
+
+        gl_print_state_clear (&state);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Cairo write function, counts and discards output.               */
+/*---------------------------------------------------------------------------*/
+static cairo_status_t
+count_bytes (void         *closure,
+             const guchar *data,
+             guint         length)
+{
+        *(gint64 *)closure += length;
+
+        return CAIRO_STATUS_SUCCESS;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Start measuring stage.                                          */
+/*---------------------------------------------------------------------------*/
+static void
+stage_begin (BenchStage  *stage,
+             const gchar *name)
+{
+        gl_stats_reset ();
+
+        stage->name       = name;
+        stage->heap_start = get_heap_in_use ();
+        stage->start_time = g_get_monotonic_time ();
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Finish measuring stage and print results.                       */
+/*---------------------------------------------------------------------------*/
+static void
+stage_end (BenchStage *stage)
+{
+        gdouble  secs;
+        gint64   n_items;
+        gint64   heap;
+
+        secs = (g_get_monotonic_time () - stage->start_time) / 1.0e6;
+        heap = get_heap_in_use ();
+
+        /* Merge stage counts records, render stages count labels, the
+         * symbol stage counts barcodes. */
+        n_items = gl_stats_counters[GL_STATS_LABELS_DRAWN];
+        if ( n_items == 0 )
+        {
+                n_items = gl_stats_counters[GL_STATS_RECORDS_PARSED];
+        }
+        if ( n_items == 0 )
+        {
+                n_items = gl_stats_counters[GL_STATS_BARCODES_BUILT];
+        }
+
+        g_print ("%-10s %10.3f %10" G_GINT64_FORMAT " %12.1f %10" G_GINT64_FORMAT
+                 " %12" G_GINT64_FORMAT " %12" G_GINT64_FORMAT " %12ld\n",
+                 stage->name,
+                 secs,
+                 n_items,
+                 secs > 0 ? n_items / secs : 0.0,
+                 gl_stats_counters[GL_STATS_BARCODES_BUILT],
+                 gl_stats_counters[GL_STATS_BYTES_WRITTEN],
+                 (heap >= 0) ? (heap - stage->heap_start) / 1024 : -1,
+                 get_peak_rss ());
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Bytes of heap currently allocated, -1 if unknown.               */
+/*---------------------------------------------------------------------------*/
+static gint64
+get_heap_in_use (void)
+{
+#if defined (HAVE_MALLINFO2)
+        struct mallinfo2 info = mallinfo2 ();
+
+        return (gint64)info.uordblks + (gint64)info.hblkhd;
+#elif defined (HAVE_MALLINFO)
+        struct mallinfo info = mallinfo ();
+
+        return (gint64)(guint)info.uordblks + (gint64)(guint)info.hblkhd;
+#else
+        return -1;
+#endif
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Peak resident set size of process (KiB on Linux).               */
+/*---------------------------------------------------------------------------*/
+static glong
+get_peak_rss (void)
+{
+        struct rusage usage;
+
+        if ( getrusage (RUSAGE_SELF, &usage) != 0 )
+        {
+                return -1;
+        }
+
+        return usage.ru_maxrss;
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
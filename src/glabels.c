@@ -21,12 +21,12 @@
 #include <config.h>
 
 #include <glib/gi18n.h>
+#include <time.h>
 
 #include <libglabels.h>
 #include "warning-handler.h"
 #include "critical-error-handler.h"
 #include "merge-init.h"
-#include "recent.h"
 #include "mini-preview-pixbuf-cache.h"
 #include "prefs.h"
 #include "font-history.h"
@@ -40,16 +40,31 @@
 /* Private macros and constants.                          */
 /*========================================================*/
 
+/* Set to print a startup timeline on stderr. */
+#define STARTUP_TRACE_ENV "GLABELS_STARTUP_TRACE"
+
 
 /*========================================================*/
 /* Private globals                                        */
 /*========================================================*/
 
+static gboolean  trace_flag = FALSE;
+static gint64    trace_start_time;
+static gint64    trace_prev_time;
+static clock_t   trace_prev_cpu;
+
 
 /*========================================================*/
 /* Local function prototypes                              */
 /*========================================================*/
 
+static void     startup_trace          (const gchar *phase);
+
+static gboolean first_window_mapped_cb (GtkWidget   *widget,
+                                        GdkEvent    *event,
+                                        gpointer     data);
+static gboolean startup_idle_cb        (gpointer     data);
+
 
 /****************************************************************************/
 /* main program                                                             */
@@ -70,6 +85,9 @@ main (int argc, char **argv)
 	gchar	       *utf8_filename;
         GError         *error = NULL;
 
+	trace_flag = (g_getenv (STARTUP_TRACE_ENV) != NULL);
+	startup_trace (NULL);
+
 	bindtextdomain (GETTEXT_PACKAGE, GLABELS_LOCALE_DIR);
 	bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
 	textdomain (GETTEXT_PACKAGE);
@@ -89,6 +107,7 @@ main (int argc, char **argv)
 		g_error_free (error);
 		return 1;
 	}
+	startup_trace ("gtk_init");
 
 
 	/* Install GUI handlers for critical error and warning messages */
@@ -102,15 +121,18 @@ main (int argc, char **argv)
 	/* Set default icon */
         gtk_window_set_default_icon_name (GLABELS_ICON_NAME);
 	
-	/* Initialize subsystems */
+	/* Initialize subsystems.  Template thumbnails and the recent files
+	 * list are loaded on first use or once the first window is up. */
 	gl_debug_init ();
 	lgl_db_init ();
+	startup_trace ("lgl_db_init");
 	gl_prefs_init ();
+	startup_trace ("gl_prefs_init");
 	gl_mini_preview_pixbuf_cache_init ();
 	gl_merge_init ();
-	gl_recent_init ();
         gl_template_history_init ();
         gl_font_history_init ();
+	startup_trace ("other subsystems");
 	
 
 	/* Parse args and build the list of files to be loaded at startup */
@@ -139,6 +161,11 @@ main (int argc, char **argv)
 		gtk_widget_show_all (win);
 	}
 	g_list_free (file_list);
+	startup_trace ("windows created");
+
+	/* Deferred work starts once the first window is on screen. */
+	g_signal_connect (G_OBJECT (gl_window_get_window_list()->data), "map-event",
+			  G_CALLBACK (first_window_mapped_cb), NULL);
 
 	
 	/* Begin main loop */
@@ -148,6 +175,71 @@ main (int argc, char **argv)
 }
 
 
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Record end of a startup phase.  A NULL phase starts the clock.  */
+/*---------------------------------------------------------------------------*/
+static void
+startup_trace (const gchar *phase)
+{
+	gint64  now;
+	clock_t cpu;
+
+	if (!trace_flag) {
+		return;
+	}
+
+	now = g_get_monotonic_time ();
+	cpu = clock ();
+
+	if (phase == NULL) {
+		trace_start_time = now;
+	} else {
+		g_printerr ("startup: %-24s %8.1f ms  (+%7.1f ms wall, %7.1f ms cpu)\n",
+			    phase,
+			    (now - trace_start_time) / 1000.0,
+			    (now - trace_prev_time) / 1000.0,
+			    1000.0 * (cpu - trace_prev_cpu) / CLOCKS_PER_SEC);
+	}
+
+	trace_prev_time = now;
+	trace_prev_cpu  = cpu;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  First window is on screen.                                      */
+/*---------------------------------------------------------------------------*/
+static gboolean
+first_window_mapped_cb (GtkWidget   *widget,
+			GdkEvent    *event,
+			gpointer     data)
+{
+	startup_trace ("first window mapped");
+
+	g_signal_handlers_disconnect_by_func (G_OBJECT (widget),
+					      G_CALLBACK (first_window_mapped_cb), data);
+
+	/* Runs after pending redraws and the deferred recent files menu. */
+	g_idle_add_full (G_PRIORITY_LOW, startup_idle_cb, NULL, NULL);
+
+	return FALSE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Start deferred initialization.                                  */
+/*---------------------------------------------------------------------------*/
+static gboolean
+startup_idle_cb (gpointer data)
+{
+	startup_trace ("first idle");
+
+	gl_mini_preview_pixbuf_cache_warm ();
+
+	return FALSE;
+}
+
+
 
 /*
  * Local Variables:       -- emacs
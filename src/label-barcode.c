@@ -54,6 +54,10 @@ struct _glLabelBarcodePrivate {
         glLabelBarcodeStyle *style;
         glColorNode         *color_node;
 
+        /* Backend style resolved from style ids.  Only re-resolve when
+         * style changed */
+        const glBarcodeStyleHandle *style_handle;
+
         /* Cached info.  Only regenerate when text_node,
          * style, or raw size changed */
         lglBarcode          *display_gbc;
@@ -191,6 +195,7 @@ gl_label_barcode_new (glLabel *label,
                 style->checksum_flag = gl_barcode_backends_style_can_csum (style->backend_id, style->id);
                 style->format_digits = gl_barcode_backends_style_get_prefered_n (style->backend_id, style->id);
                 lbc->priv->style = style;
+                lbc->priv->style_handle = gl_barcode_backends_resolve_style (style->backend_id, style->id);
                 update_barcode (lbc);
 
                 line_color_node = gl_color_node_new_default ();
@@ -227,9 +232,10 @@ copy (glLabelObject *dst_object,
         style = gl_label_barcode_get_style (lbc);
         color_node = get_line_color (src_object);
 
-        new_lbc->priv->text_node  = text_node;
-        new_lbc->priv->style      = style;
-        new_lbc->priv->color_node = color_node;
+        new_lbc->priv->text_node    = text_node;
+        new_lbc->priv->style        = style;
+        new_lbc->priv->style_handle = lbc->priv->style_handle;
+        new_lbc->priv->color_node   = color_node;
 
         update_barcode (new_lbc);
 
@@ -292,6 +298,7 @@ gl_label_barcode_set_style (glLabelBarcode            *lbc,
 
                 gl_label_barcode_style_free (lbc->priv->style);
                 lbc->priv->style = gl_label_barcode_style_dup (style);
+                lbc->priv->style_handle = gl_barcode_backends_resolve_style (style->backend_id, style->id);
 
                 update_barcode (lbc);
 
@@ -342,22 +349,20 @@ update_barcode (glLabelBarcode *lbc)
 
         if (lbc->priv->text_node->field_flag)
         {
-                data = gl_barcode_backends_style_default_digits (lbc->priv->style->backend_id,
-                                                                 lbc->priv->style->id,
-                                                                 lbc->priv->style->format_digits);
+                data = gl_barcode_backends_handle_default_digits (lbc->priv->style_handle,
+                                                                  lbc->priv->style->format_digits);
         }
         else
         {
                 data = gl_text_node_expand (lbc->priv->text_node, NULL);
         }
 
-        lbc->priv->display_gbc = gl_barcode_backends_new_barcode (lbc->priv->style->backend_id,
-                                                                  lbc->priv->style->id,
-                                                                  lbc->priv->style->text_flag,
-                                                                  lbc->priv->style->checksum_flag,
-                                                                  w_raw,
-                                                                  h_raw,
-                                                                  data);
+        lbc->priv->display_gbc = gl_barcode_backends_handle_new_barcode (lbc->priv->style_handle,
+                                                                         lbc->priv->style->text_flag,
+                                                                         lbc->priv->style->checksum_flag,
+                                                                         w_raw,
+                                                                         h_raw,
+                                                                         data);
         g_free (data);
 
         if ( lbc->priv->display_gbc == NULL )
@@ -365,16 +370,14 @@ update_barcode (glLabelBarcode *lbc)
                 lglBarcode *gbc;
 
                 /* Try again with default digits, but don't save -- just extract size. */
-                data = gl_barcode_backends_style_default_digits (lbc->priv->style->backend_id,
-                                                                 lbc->priv->style->id,
-                                                                 lbc->priv->style->format_digits);
-                gbc = gl_barcode_backends_new_barcode (lbc->priv->style->backend_id,
-                                                       lbc->priv->style->id,
-                                                       lbc->priv->style->text_flag,
-                                                       lbc->priv->style->checksum_flag,
-                                                       w_raw,
-                                                       h_raw,
-                                                       data);
+                data = gl_barcode_backends_handle_default_digits (lbc->priv->style_handle,
+                                                                  lbc->priv->style->format_digits);
+                gbc = gl_barcode_backends_handle_new_barcode (lbc->priv->style_handle,
+                                                              lbc->priv->style->text_flag,
+                                                              lbc->priv->style->checksum_flag,
+                                                              w_raw,
+                                                              h_raw,
+                                                              data);
                 g_free (data);
 
                 if ( gbc != NULL )
@@ -508,7 +511,7 @@ draw_object (glLabelObject *object,
         gl_label_object_get_matrix (object, &matrix);
 
         text_node = gl_label_barcode_get_data (GL_LABEL_BARCODE (object));
-        style = gl_label_barcode_get_style (GL_LABEL_BARCODE (object));
+        style = lbc->priv->style;
 
         color_node = gl_label_object_get_line_color (object);
         color = gl_color_node_expand (color_node, record);
@@ -524,7 +527,9 @@ draw_object (glLabelObject *object,
                 gl_label_object_get_raw_size (object, &w, &h);
 
                 text = gl_text_node_expand (text_node, record);
-                gbc = gl_barcode_backends_new_barcode (style->backend_id, style->id, style->text_flag, style->checksum_flag, w, h, text);
+                gbc = gl_barcode_backends_handle_new_barcode (lbc->priv->style_handle,
+                                                              style->text_flag, style->checksum_flag,
+                                                              w, h, text);
                 g_free (text);
 
                 if ( gbc != NULL )
@@ -550,7 +555,6 @@ draw_object (glLabelObject *object,
         }
 
         gl_text_node_free (&text_node);
-        gl_label_barcode_style_free (style);
         gl_color_node_free (&color_node);
 
         gl_debug (DEBUG_LABEL, "END");
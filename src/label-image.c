@@ -56,6 +56,16 @@ struct _glLabelImagePrivate {
 
         GdkPixbuf        *pixbuf;
         RsvgHandle       *svg_handle;
+
+        /* Last shadow built, and what it was built from. */
+        GdkPixbuf        *shadow_source;
+        cairo_surface_t  *shadow_surface;
+        guint             shadow_color;
+        gdouble           shadow_opacity;
+
+        /* SVG rendering, replayed as the mask for its shadow. */
+        RsvgHandle       *shadow_svg_handle;
+        cairo_surface_t  *shadow_svg_mask;
 };
 
 
@@ -63,7 +73,8 @@ struct _glLabelImagePrivate {
 /* Private globals.                                       */
 /*========================================================*/
 
-static GdkPixbuf *default_pixbuf = NULL;
+static GdkPixbuf       *default_pixbuf  = NULL;
+static cairo_surface_t *default_surface = NULL;
 
 
 /*========================================================*/
@@ -95,6 +106,18 @@ static gboolean object_at                (glLabelObject     *object,
                                           gdouble            x_pixels,
                                           gdouble            y_pixels);
 
+static cairo_surface_t *get_surface     (glLabelImage      *this);
+
+static cairo_surface_t *get_shadow_surface (glLabelImage    *this,
+                                          GdkPixbuf         *pixbuf,
+                                          guint              shadow_color,
+                                          gdouble            shadow_opacity);
+
+static cairo_surface_t *get_svg_mask     (glLabelImage      *this,
+                                          RsvgHandle        *svg_handle);
+
+static void clear_shadow_cache           (glLabelImage      *this);
+
 
 /*****************************************************************************/
 /* Boilerplate object stuff.                                                 */
@@ -124,6 +147,8 @@ gl_label_image_class_init (glLabelImageClass *class)
                 default_pixbuf =
                         gdk_pixbuf_scale_simple (pixbuf, 128, 128, GDK_INTERP_NEAREST);
                 g_object_unref (pixbuf);
+
+                default_surface = gl_pixbuf_util_create_surface (default_pixbuf);
         }
 }
 
@@ -174,6 +199,7 @@ gl_label_image_finalize (GObject *object)
                 }
 
         }
+        clear_shadow_cache (this);
         gl_text_node_free (&this->priv->filename);
         g_free (this->priv);
 
@@ -357,6 +383,7 @@ gl_label_image_set_filename (glLabelImage *this,
         }
 
         gl_text_node_free (&old_filename);
+        clear_shadow_cache (this);
 
 
         /* Now set the new file type and the pixbuf or svg_handle. */
@@ -504,6 +531,7 @@ gl_label_image_set_pixbuf (glLabelImage  *this,
         name = g_strdup_printf ("%s.bitmap", cs);
         this->priv->filename = gl_text_node_new_from_text(name);
         gl_text_node_free (&old_filename);
+        clear_shadow_cache (this);
 
         this->priv->pixbuf = g_object_ref (pixbuf);
         gl_pixbuf_cache_add_pixbuf (pixbuf_cache, name, pixbuf);
@@ -687,6 +715,7 @@ draw_object (glLabelObject *object,
         gdouble            w, h;
         gdouble            image_w, image_h;
         GdkPixbuf         *pixbuf;
+        cairo_surface_t   *surface;
         RsvgHandle        *svg_handle;
         RsvgDimensionData  svg_dim;
 
@@ -700,6 +729,19 @@ draw_object (glLabelObject *object,
         {
 
         case FILE_TYPE_PIXBUF:
+                surface = get_surface (this);
+                if ( surface )
+                {
+                        image_w = cairo_image_surface_get_width (surface);
+                        image_h = cairo_image_surface_get_height (surface);
+                        cairo_rectangle (cr, 0.0, 0.0, w, h);
+                        cairo_scale (cr, w/image_w, h/image_h);
+                        cairo_set_source_surface (cr, surface, 0, 0);
+                        cairo_fill (cr);
+                        break;
+                }
+
+                /* Merged image, a new pixbuf for each record. */
                 pixbuf = gl_label_image_get_pixbuf (this, record);
                 if ( pixbuf )
                 {
@@ -728,7 +770,7 @@ draw_object (glLabelObject *object,
                 image_w = gdk_pixbuf_get_width (default_pixbuf);
                 image_h = gdk_pixbuf_get_height (default_pixbuf);
                 cairo_scale (cr, w/image_w, h/image_h);
-                gdk_cairo_set_source_pixbuf (cr, default_pixbuf, 0, 0);
+                cairo_set_source_surface (cr, default_surface, 0, 0);
                 cairo_fill (cr);
                 break;
 
@@ -752,7 +794,10 @@ draw_shadow (glLabelObject *object,
         glLabelImage    *this = GL_LABEL_IMAGE (object);
         gdouble          w, h;
         GdkPixbuf       *pixbuf;
-        GdkPixbuf       *shadow_pixbuf;
+        cairo_surface_t *shadow_surface;
+        RsvgHandle      *svg_handle;
+        RsvgDimensionData svg_dim;
+        cairo_surface_t *mask;
         gdouble          image_w, image_h;
         glColorNode     *shadow_color_node;
         guint            shadow_color;
@@ -782,20 +827,36 @@ draw_shadow (glLabelObject *object,
                         image_w = gdk_pixbuf_get_width (pixbuf);
                         image_h = gdk_pixbuf_get_height (pixbuf);
 
-                        shadow_pixbuf = gl_pixbuf_util_create_shadow_pixbuf (pixbuf,
-                                                                             shadow_color, shadow_opacity);
-                        cairo_rectangle (cr, 0.0, 0.0, w, h);
-                        cairo_scale (cr, w/image_w, h/image_h);
-                        gdk_cairo_set_source_pixbuf (cr, (GdkPixbuf *)shadow_pixbuf, 0, 0);
-                        cairo_fill (cr);
+                        shadow_surface = get_shadow_surface (this, pixbuf,
+                                                             shadow_color, shadow_opacity);
+                        if ( shadow_surface )
+                        {
+                                cairo_rectangle (cr, 0.0, 0.0, w, h);
+                                cairo_scale (cr, w/image_w, h/image_h);
+                                cairo_set_source_surface (cr, shadow_surface, 0, 0);
+                                cairo_fill (cr);
+                        }
 
-                        g_object_unref (G_OBJECT (shadow_pixbuf));
                         g_object_unref (G_OBJECT (pixbuf));
                 }
                 break;
 
         case FILE_TYPE_SVG:
-                /* FIXME: no shadow support, yet. */
+                svg_handle = gl_label_image_get_svg_handle (this, record);
+                if ( svg_handle )
+                {
+                        /* Shadow is the SVG's own coverage, filled with the shadow color. */
+                        rsvg_handle_get_dimensions (svg_handle, &svg_dim);
+                        mask = get_svg_mask (this, svg_handle);
+
+                        shadow_color = gl_color_set_opacity (shadow_color, shadow_opacity);
+
+                        cairo_scale (cr, w/svg_dim.width, h/svg_dim.height);
+                        cairo_set_source_rgba (cr, GL_COLOR_RGBA_ARGS (shadow_color));
+                        cairo_mask_surface (cr, mask, 0, 0);
+
+                        g_object_unref (G_OBJECT (svg_handle));
+                }
                 break;
 
         default:
@@ -838,6 +899,138 @@ object_at (glLabelObject *object,
 }
 
 
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get persistent surface of a static image, or NULL if the image  */
+/* is merged.  Returned surface is owned by the label's pixbuf cache.        */
+/*---------------------------------------------------------------------------*/
+static cairo_surface_t *
+get_surface (glLabelImage  *this)
+{
+        glLabel    *label;
+        GHashTable *cache;
+
+        if ( this->priv->filename->field_flag || (this->priv->type != FILE_TYPE_PIXBUF) )
+        {
+                return NULL;
+        }
+
+        label = gl_label_object_get_parent (GL_LABEL_OBJECT (this));
+        cache = gl_label_get_pixbuf_cache (label);
+
+        return gl_pixbuf_cache_get_surface (cache, this->priv->filename->data);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get shadow of pixbuf, reusing the previous one if built from    */
+/* the same pixbuf, color and opacity.  Returned surface is owned by this.   */
+/*---------------------------------------------------------------------------*/
+static cairo_surface_t *
+get_shadow_surface (glLabelImage *this,
+                    GdkPixbuf    *pixbuf,
+                    guint         shadow_color,
+                    gdouble       shadow_opacity)
+{
+        GdkPixbuf *shadow_pixbuf;
+
+        if ( (this->priv->shadow_surface == NULL) ||
+             (this->priv->shadow_source != pixbuf) ||
+             (this->priv->shadow_color != shadow_color) ||
+             (this->priv->shadow_opacity != shadow_opacity) )
+        {
+                if ( this->priv->shadow_surface )
+                {
+                        cairo_surface_destroy (this->priv->shadow_surface);
+                        g_object_unref (this->priv->shadow_source);
+                        this->priv->shadow_surface = NULL;
+                        this->priv->shadow_source  = NULL;
+                }
+
+                shadow_pixbuf = gl_pixbuf_util_create_shadow_pixbuf (pixbuf,
+                                                                     shadow_color,
+                                                                     shadow_opacity);
+                if ( shadow_pixbuf == NULL )
+                {
+                        return NULL;
+                }
+
+                /* Hold a reference to the source so its address cannot be reused. */
+                this->priv->shadow_source  = g_object_ref (pixbuf);
+                this->priv->shadow_surface = gl_pixbuf_util_create_surface (shadow_pixbuf);
+                this->priv->shadow_color   = shadow_color;
+                this->priv->shadow_opacity = shadow_opacity;
+
+                g_object_unref (shadow_pixbuf);
+        }
+
+        return this->priv->shadow_surface;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get recording of SVG rendering, for use as a shadow mask.       */
+/* Rendered once per handle; replaying a recording is much cheaper than      */
+/* rendering the SVG again.  Returned surface is owned by this.              */
+/*---------------------------------------------------------------------------*/
+static cairo_surface_t *
+get_svg_mask (glLabelImage *this,
+              RsvgHandle   *svg_handle)
+{
+        RsvgDimensionData  svg_dim;
+        cairo_rectangle_t  extents;
+        cairo_t           *cr;
+
+        if ( (this->priv->shadow_svg_mask == NULL) ||
+             (this->priv->shadow_svg_handle != svg_handle) )
+        {
+                if ( this->priv->shadow_svg_mask )
+                {
+                        cairo_surface_destroy (this->priv->shadow_svg_mask);
+                        g_object_unref (this->priv->shadow_svg_handle);
+                }
+
+                rsvg_handle_get_dimensions (svg_handle, &svg_dim);
+                extents.x      = 0;
+                extents.y      = 0;
+                extents.width  = svg_dim.width;
+                extents.height = svg_dim.height;
+
+                this->priv->shadow_svg_handle = g_object_ref (svg_handle);
+                this->priv->shadow_svg_mask   = cairo_recording_surface_create (CAIRO_CONTENT_ALPHA, &extents);
+
+                cr = cairo_create (this->priv->shadow_svg_mask);
+                rsvg_handle_render_cairo (svg_handle, cr);
+                cairo_destroy (cr);
+        }
+
+        return this->priv->shadow_svg_mask;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Release cached shadows.                                         */
+/*---------------------------------------------------------------------------*/
+static void
+clear_shadow_cache (glLabelImage *this)
+{
+        if ( this->priv->shadow_surface )
+        {
+                cairo_surface_destroy (this->priv->shadow_surface);
+                g_object_unref (this->priv->shadow_source);
+                this->priv->shadow_surface = NULL;
+                this->priv->shadow_source  = NULL;
+        }
+
+        if ( this->priv->shadow_svg_mask )
+        {
+                cairo_surface_destroy (this->priv->shadow_svg_mask);
+                g_object_unref (this->priv->shadow_svg_handle);
+                this->priv->shadow_svg_mask   = NULL;
+                this->priv->shadow_svg_handle = NULL;
+        }
+}
+
+
 
 
 /*
@@ -268,7 +268,37 @@ gl_label_object_emit_changed (glLabelObject *object)
 
         g_return_if_fail (object && GL_IS_LABEL_OBJECT (object));
 
-        g_signal_emit (G_OBJECT(object), signals[CHANGED], 0);
+        if ( object->priv->parent && gl_label_is_batch_update (object->priv->parent) )
+        {
+                gl_label_batch_object_changed (object->priv->parent, object);
+        }
+        else
+        {
+                g_signal_emit (G_OBJECT(object), signals[CHANGED], 0);
+        }
+
+        gl_debug (DEBUG_LABEL, "END");
+}
+
+
+/*****************************************************************************/
+/* Emit "moved" signal.                                                      */
+/*****************************************************************************/
+void
+gl_label_object_emit_moved (glLabelObject *object)
+{
+        gl_debug (DEBUG_LABEL, "START");
+
+        g_return_if_fail (object && GL_IS_LABEL_OBJECT (object));
+
+        if ( object->priv->parent && gl_label_is_batch_update (object->priv->parent) )
+        {
+                gl_label_batch_object_moved (object->priv->parent, object);
+        }
+        else
+        {
+                g_signal_emit (G_OBJECT(object), signals[MOVED], 0);
+        }
 
         gl_debug (DEBUG_LABEL, "END");
 }
@@ -395,7 +425,7 @@ gl_label_object_set_position (glLabelObject *object,
 		object->priv->x = x;
 		object->priv->y = y;
 
-                g_signal_emit (G_OBJECT(object), signals[MOVED], 0);
+                gl_label_object_emit_moved (object);
 
 	}
 
@@ -430,7 +460,7 @@ gl_label_object_set_position_relative (glLabelObject *object,
 			  object->priv->x,
 			  object->priv->y);
 
-                g_signal_emit (G_OBJECT(object), signals[MOVED], 0);
+                gl_label_object_emit_moved (object);
 	}
 
 	gl_debug (DEBUG_LABEL, "END");
@@ -225,6 +225,8 @@ glLabelObject *gl_label_object_dup                   (glLabelObject     *src_obj
 
 void           gl_label_object_emit_changed          (glLabelObject     *object);
 
+void           gl_label_object_emit_moved            (glLabelObject     *object);
+
 void           gl_label_object_set_parent            (glLabelObject     *object,
                                                       glLabel           *label);
 
@@ -65,8 +65,15 @@ struct _glLabelPrivate {
 	GHashTable  *svg_cache;
 
         /* Delay changed signals while operating on selections of multiple objects. */
-        gboolean     selection_op_flag;
+        gint         batch_depth;
+        gboolean     batch_flushing_flag;
         gboolean     delayed_change_flag;
+        GHashTable  *batch_entries;
+        gboolean     batch_region_flag;
+
+        /* Extent of the pending "changed" emission, if known. */
+        glLabelRegion changed_region;
+        gboolean      changed_region_flag;
 
 	/* Default object text properties */
 	gchar             *default_font_family;
@@ -93,7 +100,15 @@ struct _glLabelPrivate {
 };
 
 typedef struct {
-        gchar             *xml_buffer;
+        gboolean           have_extent;
+        glLabelRegion      extent;      /* Extent at start of batch */
+        gboolean           changed_flag;
+        gboolean           moved_flag;
+} BatchEntry;
+
+typedef struct {
+        glLabel           *label;       /* Private copy of selected objects */
+        gchar             *xml_buffer;  /* Created only when requested */
         gchar             *text;
         GdkPixbuf         *pixbuf;
 } ClipboardData;
@@ -132,6 +147,9 @@ static guint signals[LAST_SIGNAL] = {0};
 
 static guint untitled = 0;
 
+/* Our data, while we own the clipboard. */
+static ClipboardData *clipboard_data = NULL;
+
 
 /*========================================================*/
 /* Private function prototypes.                           */
@@ -147,8 +165,14 @@ static void object_moved_cb        (glLabelObject *object,
 
 static void do_modify              (glLabel       *label);
 
-static void begin_selection_op     (glLabel       *label);
-static void end_selection_op       (glLabel       *label);
+static BatchEntry *batch_entry_get (glLabel       *label,
+                                    glLabelObject *object);
+
+static void region_union           (glLabelRegion       *region,
+                                    const glLabelRegion *region2);
+
+static void get_drawn_extent       (glLabelObject       *object,
+                                    glLabelRegion       *region);
 
 static void clipboard_get_cb       (GtkClipboard     *clipboard,
                                     GtkSelectionData *selection_data,
@@ -163,6 +187,9 @@ static void receive_targets_cb     (GtkClipboard     *clipboard,
                                     gint              n_targets,
                                     glLabel          *label);
 
+static void paste_objects          (glLabel          *label,
+                                    glLabel          *label_copy);
+
 static void paste_xml_received_cb  (GtkClipboard     *clipboard,
                                     GtkSelectionData *selection_data,
                                     glLabel          *label);
@@ -362,6 +389,46 @@ gl_label_new (void)
 }
 
 
+/*****************************************************************************/
+/* Duplicate label.                                                          */
+/*                                                                           */
+/* The copy has the same template, objects and merge source, but no file    */
+/* name or undo history.  It shares no mutable state with the original, so  */
+/* it may be rendered from another thread while the original is in use.     */
+/*****************************************************************************/
+glLabel *
+gl_label_dup (glLabel *label)
+{
+	glLabel       *copy;
+	GList         *p;
+	glLabelObject *object;
+
+	gl_debug (DEBUG_LABEL, "START");
+
+	g_return_val_if_fail (label && GL_IS_LABEL (label), NULL);
+
+	copy = GL_LABEL (gl_label_new ());
+
+	copy->priv->template    = lgl_template_dup (label->priv->template);
+	copy->priv->rotate_flag = label->priv->rotate_flag;
+
+	for (p = label->priv->object_list; p != NULL; p = p->next)
+	{
+		object = GL_LABEL_OBJECT (p->data);
+
+		gl_label_add_object (copy, gl_label_object_dup (object, copy));
+	}
+
+	copy->priv->merge = gl_merge_dup (label->priv->merge);
+
+	gl_label_clear_modified (copy);
+
+	gl_debug (DEBUG_LABEL, "END");
+
+	return copy;
+}
+
+
 /****************************************************************************/
 /* Set filename.                                                            */
 /****************************************************************************/
@@ -539,9 +606,15 @@ object_moved_cb (glLabelObject *object,
 static void
 do_modify (glLabel  *label)
 {
-        if ( label->priv->selection_op_flag )
+        if ( (label->priv->batch_depth > 0) || label->priv->batch_flushing_flag )
         {
                 label->priv->delayed_change_flag = TRUE;
+
+                /* Not caused by a tracked object, so extent is unknown. */
+                if ( !label->priv->batch_flushing_flag )
+                {
+                        label->priv->batch_region_flag = FALSE;
+                }
         }
         else
         {
@@ -554,27 +627,236 @@ do_modify (glLabel  *label)
 
 
 /****************************************************************************/
-/* Begin selection operation.                                               */
+/* Begin batch update.                                                      */
+/*                                                                          */
+/* Until the matching gl_label_end_batch_update(), "changed" and "moved"    */
+/* signals of individual objects are held back and the label emits no       */
+/* "changed" signal.  Batches may be nested.                                */
 /****************************************************************************/
-static void
-begin_selection_op (glLabel  *label)
+void
+gl_label_begin_batch_update (glLabel  *label)
 {
-        label->priv->selection_op_flag = TRUE;
+        GList         *selection_list, *p;
+        glLabelObject *object;
+        BatchEntry    *entry;
+
+	g_return_if_fail (label && GL_IS_LABEL (label));
+
+        if ( label->priv->batch_depth++ > 0 )
+        {
+                return;
+        }
+
+        label->priv->batch_entries = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                            NULL, g_free);
+        label->priv->batch_region_flag = TRUE;
+
+        /* Batches operate on the selection; remember where it started. */
+        selection_list = gl_label_get_selection_list (label);
+        for ( p = selection_list; p != NULL; p = p->next )
+        {
+                object = GL_LABEL_OBJECT (p->data);
+
+                entry = batch_entry_get (label, object);
+                get_drawn_extent (object, &entry->extent);
+                entry->have_extent = TRUE;
+        }
+        g_list_free (selection_list);
 }
 
 
 /****************************************************************************/
-/* End selection operation.                                                 */
+/* End batch update.                                                        */
+/*                                                                          */
+/* Each object that changed emits its signals once, then the label emits a  */
+/* single "changed" signal.  During that emission                           */
+/* gl_label_get_changed_region() returns the union of the old and new      */
+/* extents of all changed objects.                                          */
 /****************************************************************************/
-static void
-end_selection_op (glLabel  *label)
+void
+gl_label_end_batch_update (glLabel  *label)
 {
-        label->priv->selection_op_flag = FALSE;
+        GHashTable     *entries;
+        GHashTableIter  iter;
+        glLabelObject  *object;
+        BatchEntry     *entry;
+        glLabelRegion   extent;
+        gboolean        first_flag = TRUE;
+
+	g_return_if_fail (label && GL_IS_LABEL (label));
+	g_return_if_fail (label->priv->batch_depth > 0);
+
+        if ( --label->priv->batch_depth > 0 )
+        {
+                return;
+        }
+
+        entries = label->priv->batch_entries;
+        label->priv->batch_entries = NULL;
+
+        label->priv->changed_region_flag = label->priv->batch_region_flag;
+
+        label->priv->batch_flushing_flag = TRUE;
+
+        g_hash_table_iter_init (&iter, entries);
+        while ( g_hash_table_iter_next (&iter, (gpointer *)&object, (gpointer *)&entry) )
+        {
+                if ( !entry->changed_flag && !entry->moved_flag )
+                {
+                        continue;
+                }
+
+                if ( !entry->have_extent )
+                {
+                        label->priv->changed_region_flag = FALSE;
+                }
+                else if ( label->priv->changed_region_flag )
+                {
+                        get_drawn_extent (object, &extent);
+                        region_union (&extent, &entry->extent);
+                        if ( first_flag )
+                        {
+                                label->priv->changed_region = extent;
+                                first_flag = FALSE;
+                        }
+                        else
+                        {
+                                region_union (&label->priv->changed_region, &extent);
+                        }
+                }
+
+                if ( entry->changed_flag )
+                {
+                        gl_label_object_emit_changed (object);
+                }
+                if ( entry->moved_flag )
+                {
+                        gl_label_object_emit_moved (object);
+                }
+        }
+
+        label->priv->batch_flushing_flag = FALSE;
+
+        g_hash_table_destroy (entries);
+
         if ( label->priv->delayed_change_flag )
         {
                 label->priv->delayed_change_flag = FALSE;
                 do_modify (label);
         }
+
+        label->priv->changed_region_flag = FALSE;
+}
+
+
+/****************************************************************************/
+/* Is label in a batch update?                                              */
+/****************************************************************************/
+gboolean
+gl_label_is_batch_update (glLabel  *label)
+{
+        return (label->priv->batch_depth > 0);
+}
+
+
+/****************************************************************************/
+/* Record that object changed during a batch update.                        */
+/****************************************************************************/
+void
+gl_label_batch_object_changed (glLabel       *label,
+                               glLabelObject *object)
+{
+        g_return_if_fail (label->priv->batch_depth > 0);
+
+        batch_entry_get (label, object)->changed_flag = TRUE;
+}
+
+
+/****************************************************************************/
+/* Record that object moved during a batch update.                          */
+/****************************************************************************/
+void
+gl_label_batch_object_moved (glLabel       *label,
+                             glLabelObject *object)
+{
+        g_return_if_fail (label->priv->batch_depth > 0);
+
+        batch_entry_get (label, object)->moved_flag = TRUE;
+}
+
+
+/****************************************************************************/
+/* Get extent of the "changed" signal currently being emitted.              */
+/****************************************************************************/
+gboolean
+gl_label_get_changed_region (glLabel       *label,
+                             glLabelRegion *region)
+{
+        if ( label->priv->changed_region_flag )
+        {
+                *region = label->priv->changed_region;
+        }
+
+        return label->priv->changed_region_flag;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Lookup or create batch entry for object.                        */
+/*---------------------------------------------------------------------------*/
+static BatchEntry *
+batch_entry_get (glLabel       *label,
+                 glLabelObject *object)
+{
+        BatchEntry *entry;
+
+        entry = g_hash_table_lookup (label->priv->batch_entries, object);
+        if ( entry == NULL )
+        {
+                entry = g_new0 (BatchEntry, 1);
+                g_hash_table_insert (label->priv->batch_entries, object, entry);
+        }
+
+        return entry;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Grow region to include region2.                                 */
+/*---------------------------------------------------------------------------*/
+static void
+region_union (glLabelRegion       *region,
+              const glLabelRegion *region2)
+{
+        region->x1 = MIN (region->x1, region2->x1);
+        region->y1 = MIN (region->y1, region2->y1);
+        region->x2 = MAX (region->x2, region2->x2);
+        region->y2 = MAX (region->y2, region2->y2);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Extent of object, including its shadow.                         */
+/*---------------------------------------------------------------------------*/
+static void
+get_drawn_extent (glLabelObject       *object,
+                  glLabelRegion       *region)
+{
+        glLabelRegion shadow;
+        gdouble       dx, dy;
+
+        gl_label_object_get_extent (object, region);
+
+        if ( gl_label_object_get_shadow_state (object) )
+        {
+                gl_label_object_get_shadow_offset (object, &dx, &dy);
+
+                shadow.x1 = region->x1 + dx;
+                shadow.y1 = region->y1 + dy;
+                shadow.x2 = region->x2 + dx;
+                shadow.y2 = region->y2 + dy;
+                region_union (region, &shadow);
+        }
 }
 
 
@@ -924,6 +1206,11 @@ gl_label_delete_object (glLabel       *label,
 
         label->priv->object_list = g_list_remove (label->priv->object_list, object);
 
+        if ( label->priv->batch_entries != NULL )
+        {
+                g_hash_table_remove (label->priv->batch_entries, object);
+        }
+
         g_signal_handlers_disconnect_by_func (G_OBJECT (object),
                                               G_CALLBACK (object_changed_cb), label);
         g_signal_handlers_disconnect_by_func (G_OBJECT (object),
@@ -1330,7 +1617,7 @@ gl_label_delete_selection (glLabel       *label)
 
         gl_label_checkpoint (label, _("Delete"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1343,7 +1630,7 @@ gl_label_delete_selection (glLabel       *label)
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	g_signal_emit (G_OBJECT(label), signals[SELECTION_CHANGED], 0);
 
@@ -1365,7 +1652,7 @@ gl_label_raise_selection_to_top (glLabel       *label)
 
         gl_label_checkpoint (label, _("Bring to front"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1381,7 +1668,7 @@ gl_label_raise_selection_to_top (glLabel       *label)
 
         do_modify (label);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1401,7 +1688,7 @@ gl_label_lower_selection_to_bottom (glLabel       *label)
 
         gl_label_checkpoint (label, _("Send to back"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1417,7 +1704,7 @@ gl_label_lower_selection_to_bottom (glLabel       *label)
 
         do_modify (label);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1438,7 +1725,7 @@ gl_label_rotate_selection (glLabel *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         gl_label_checkpoint (label, _("Rotate"));
 
@@ -1455,7 +1742,7 @@ gl_label_rotate_selection (glLabel *label,
 
 	do_modify (label);
 
-	end_selection_op (label);
+	gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1475,7 +1762,7 @@ gl_label_rotate_selection_left (glLabel *label)
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         gl_label_checkpoint (label, _("Rotate left"));
 
@@ -1492,7 +1779,7 @@ gl_label_rotate_selection_left (glLabel *label)
 
 	do_modify (label);
 
-	end_selection_op (label);
+	gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1514,7 +1801,7 @@ gl_label_rotate_selection_right (glLabel *label)
 
         gl_label_checkpoint (label, _("Rotate right"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1529,7 +1816,7 @@ gl_label_rotate_selection_right (glLabel *label)
 
 	do_modify (label);
 
-	end_selection_op (label);
+	gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1551,7 +1838,7 @@ gl_label_flip_selection_horiz (glLabel *label)
 
         gl_label_checkpoint (label, _("Flip horizontally"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1566,7 +1853,7 @@ gl_label_flip_selection_horiz (glLabel *label)
 
 	do_modify (label);
 
-	end_selection_op (label);
+	gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1588,7 +1875,7 @@ gl_label_flip_selection_vert (glLabel *label)
 
         gl_label_checkpoint (label, _("Flip vertically"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1603,7 +1890,7 @@ gl_label_flip_selection_vert (glLabel *label)
 
 	do_modify (label);
 
-	end_selection_op (label);
+	gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1630,7 +1917,7 @@ gl_label_align_selection_left (glLabel *label)
 
         gl_label_checkpoint (label, _("Align left"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1660,7 +1947,7 @@ gl_label_align_selection_left (glLabel *label)
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1687,7 +1974,7 @@ gl_label_align_selection_right (glLabel *label)
 
         gl_label_checkpoint (label, _("Align right"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1717,7 +2004,7 @@ gl_label_align_selection_right (glLabel *label)
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1748,7 +2035,7 @@ gl_label_align_selection_hcenter (glLabel *label)
 
         gl_label_checkpoint (label, _("Align horizontal center"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1797,7 +2084,7 @@ gl_label_align_selection_hcenter (glLabel *label)
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1824,7 +2111,7 @@ gl_label_align_selection_top (glLabel *label)
 
         gl_label_checkpoint (label, _("Align tops"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1854,7 +2141,7 @@ gl_label_align_selection_top (glLabel *label)
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1881,7 +2168,7 @@ gl_label_align_selection_bottom (glLabel *label)
 
         gl_label_checkpoint (label, _("Align bottoms"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1911,7 +2198,7 @@ gl_label_align_selection_bottom (glLabel *label)
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -1942,7 +2229,7 @@ gl_label_align_selection_vcenter (glLabel *label)
 
         gl_label_checkpoint (label, _("Align vertical center"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -1991,7 +2278,7 @@ gl_label_align_selection_vcenter (glLabel *label)
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2020,7 +2307,7 @@ gl_label_center_selection_horiz (glLabel *label)
 
         gl_label_checkpoint (label, _("Center horizontally"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
 	gl_label_get_size (label, &w, &h);
 	x_label_center = w / 2.0;
@@ -2038,7 +2325,7 @@ gl_label_center_selection_horiz (glLabel *label)
 	}
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2067,7 +2354,7 @@ gl_label_center_selection_vert (glLabel *label)
 
         gl_label_checkpoint (label, _("Center vertically"));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
 	gl_label_get_size (label, &w, &h);
 	y_label_center = h / 2.0;
@@ -2085,7 +2372,7 @@ gl_label_center_selection_vert (glLabel *label)
 	}
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2107,7 +2394,7 @@ gl_label_move_selection (glLabel  *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2120,7 +2407,7 @@ gl_label_move_selection (glLabel  *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2141,7 +2428,7 @@ gl_label_set_selection_font_family (glLabel      *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2153,7 +2440,7 @@ gl_label_set_selection_font_family (glLabel      *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2174,7 +2461,7 @@ gl_label_set_selection_font_size (glLabel  *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2186,7 +2473,7 @@ gl_label_set_selection_font_size (glLabel  *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2207,7 +2494,7 @@ gl_label_set_selection_font_weight (glLabel      *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2219,7 +2506,7 @@ gl_label_set_selection_font_weight (glLabel      *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2240,7 +2527,7 @@ gl_label_set_selection_font_italic_flag (glLabel   *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2252,7 +2539,7 @@ gl_label_set_selection_font_italic_flag (glLabel   *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2273,7 +2560,7 @@ gl_label_set_selection_text_alignment (glLabel        *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2285,7 +2572,7 @@ gl_label_set_selection_text_alignment (glLabel        *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2306,7 +2593,7 @@ gl_label_set_selection_text_valignment (glLabel        *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2318,7 +2605,7 @@ gl_label_set_selection_text_valignment (glLabel        *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2339,7 +2626,7 @@ gl_label_set_selection_text_line_spacing (glLabel  *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2351,7 +2638,7 @@ gl_label_set_selection_text_line_spacing (glLabel  *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2372,7 +2659,7 @@ gl_label_set_selection_text_color (glLabel      *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2384,7 +2671,7 @@ gl_label_set_selection_text_color (glLabel      *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2405,7 +2692,7 @@ gl_label_set_selection_fill_color (glLabel      *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2417,7 +2704,7 @@ gl_label_set_selection_fill_color (glLabel      *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2438,7 +2725,7 @@ gl_label_set_selection_line_color (glLabel      *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2450,7 +2737,7 @@ gl_label_set_selection_line_color (glLabel      *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2471,7 +2758,7 @@ gl_label_set_selection_line_width (glLabel  *label,
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
-        begin_selection_op (label);
+        gl_label_begin_batch_update (label);
 
         selection_list = gl_label_get_selection_list (label);
 
@@ -2483,7 +2770,7 @@ gl_label_set_selection_line_width (glLabel  *label,
 
         g_list_free (selection_list);
 
-        end_selection_op (label);
+        gl_label_end_batch_update (label);
 
 	gl_debug (DEBUG_LABEL, "END");
 }
@@ -2514,10 +2801,8 @@ gl_label_copy_selection (glLabel       *label)
 {
         GtkClipboard      *clipboard;
 	GList             *selection_list;
-        glLabel           *label_copy;
 	GList             *p;
 	glLabelObject     *object;
-        glXMLLabelStatus   status;
 
         ClipboardData     *data;
 
@@ -2545,24 +2830,22 @@ gl_label_copy_selection (glLabel       *label)
                 target_list = gtk_target_list_new (glabels_targets, G_N_ELEMENTS(glabels_targets));
 
                 /*
-                 * Serialize selection by encoding as an XML label document.
+                 * Keep a private copy of the selection.  Copied objects share
+                 * image data with the originals.  It is only serialized as an
+                 * XML label document if another application asks for it.
                  */
-		label_copy = GL_LABEL(gl_label_new ());
+		data->label = GL_LABEL(gl_label_new ());
 
-		gl_label_set_template (label_copy, label->priv->template, FALSE);
-		gl_label_set_rotate_flag (label_copy, label->priv->rotate_flag, FALSE);
+		gl_label_set_template (data->label, label->priv->template, FALSE);
+		gl_label_set_rotate_flag (data->label, label->priv->rotate_flag, FALSE);
 
 		for (p = selection_list; p != NULL; p = p->next)
                 {
 			object = GL_LABEL_OBJECT (p->data);
 
-			gl_label_add_object (label_copy, gl_label_object_dup (object, label_copy));
+			gl_label_add_object (data->label, gl_label_object_dup (object, data->label));
 		}
 
-                data->xml_buffer = gl_xml_label_save_buffer (label_copy, &status);
-
-                g_object_unref (G_OBJECT (label_copy));
-
 
                 /*
                  * Is it an atomic text selection?  If so, also make available as text.
@@ -2597,11 +2880,18 @@ gl_label_copy_selection (glLabel       *label)
 
                 target_table = gtk_target_table_new_from_list (target_list, &n_targets);
 
-                gtk_clipboard_set_with_data (clipboard,
-                                             target_table, n_targets,
-                                             (GtkClipboardGetFunc)clipboard_get_cb,
-                                             (GtkClipboardClearFunc)clipboard_clear_cb,
-                                             data);
+                if ( gtk_clipboard_set_with_data (clipboard,
+                                                  target_table, n_targets,
+                                                  (GtkClipboardGetFunc)clipboard_get_cb,
+                                                  (GtkClipboardClearFunc)clipboard_clear_cb,
+                                                  data) )
+                {
+                        clipboard_data = data;
+                }
+                else
+                {
+                        clipboard_clear_cb (clipboard, data);
+                }
 
                 gtk_target_table_free (target_table, n_targets);
                 gtk_target_list_unref (target_list);
@@ -2626,6 +2916,19 @@ gl_label_paste (glLabel       *label)
 
 	g_return_if_fail (label && GL_IS_LABEL (label));
 
+        /*
+         * Fast path: we still own the clipboard, so paste directly from our
+         * private copy without a round trip through XML.
+         */
+        if ( clipboard_data != NULL )
+        {
+                gl_label_checkpoint (label, _("Paste"));
+                paste_objects (label, clipboard_data->label);
+
+                gl_debug (DEBUG_LABEL, "END");
+                return;
+        }
+
         clipboard = gtk_clipboard_get (GDK_SELECTION_CLIPBOARD);
 
         gtk_clipboard_request_targets (clipboard,
@@ -2647,6 +2950,12 @@ gl_label_can_paste (glLabel       *label)
 
 	gl_debug (DEBUG_LABEL, "START");
 
+        if ( clipboard_data != NULL )
+        {
+                gl_debug (DEBUG_LABEL, "END");
+                return TRUE;
+        }
+
         clipboard = gtk_clipboard_get (GDK_SELECTION_CLIPBOARD);
 
         can_flag = gtk_clipboard_wait_is_target_available (clipboard,
@@ -2674,6 +2983,12 @@ clipboard_get_cb (GtkClipboard     *clipboard,
         {
 
         case 0:
+                if ( data->xml_buffer == NULL )
+                {
+                        glXMLLabelStatus status;
+
+                        data->xml_buffer = gl_xml_label_save_buffer (data->label, &status);
+                }
                 gtk_selection_data_set (selection_data,
                                         gtk_selection_data_get_target (selection_data),
                                         8,
@@ -2707,6 +3022,12 @@ clipboard_clear_cb (GtkClipboard     *clipboard,
 {
 	gl_debug (DEBUG_LABEL, "START");
 
+        if ( clipboard_data == data )
+        {
+                clipboard_data = NULL;
+        }
+
+        g_object_unref (G_OBJECT (data->label));
         g_free (data->xml_buffer);
         g_free (data->text);
         if (data->pixbuf)
@@ -2770,6 +3091,35 @@ receive_targets_cb (GtkClipboard *clipboard,
 }
 
 
+/****************************************************************************/
+/* Paste copies of all objects in another label.                            */
+/****************************************************************************/
+static void
+paste_objects (glLabel          *label,
+               glLabel          *label_copy)
+{
+        GList            *p;
+        glLabelObject    *object, *newobject;
+
+	gl_debug (DEBUG_LABEL, "START");
+
+        gl_label_unselect_all (label);
+
+        for (p = label_copy->priv->object_list; p != NULL; p = p->next)
+        {
+                object = (glLabelObject *) p->data;
+                newobject = gl_label_object_dup (object, label);
+                gl_label_add_object( label, newobject );
+
+                gl_label_select_object (label, newobject);
+
+                gl_debug (DEBUG_LABEL, "object pasted");
+        }
+
+	gl_debug (DEBUG_LABEL, "END");
+}
+
+
 /****************************************************************************/
 /* Paste received glabels XML callback.                                     */
 /****************************************************************************/
@@ -2781,8 +3131,6 @@ paste_xml_received_cb (GtkClipboard     *clipboard,
         gchar            *xml_buffer;
         glLabel          *label_copy;
         glXMLLabelStatus  status;
-        GList            *p;
-        glLabelObject    *object, *newobject;
 
 	gl_debug (DEBUG_LABEL, "START");
 
@@ -2796,18 +3144,7 @@ paste_xml_received_cb (GtkClipboard     *clipboard,
         label_copy = gl_xml_label_open_buffer (xml_buffer, &status);
         if ( label_copy )
         {
-                gl_label_unselect_all (label);
-
-                for (p = label_copy->priv->object_list; p != NULL; p = p->next)
-                {
-                        object = (glLabelObject *) p->data;
-                        newobject = gl_label_object_dup (object, label);
-                        gl_label_add_object( label, newobject );
-
-                        gl_label_select_object (label, newobject);
-
-                        gl_debug (DEBUG_LABEL, "object pasted");
-                }
+                paste_objects (label, label_copy);
 
                 g_object_unref (G_OBJECT (label_copy));
         }
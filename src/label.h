@@ -84,6 +84,8 @@ GType         gl_label_get_type                (void) G_GNUC_CONST;
 
 GObject      *gl_label_new                     (void);
 
+glLabel      *gl_label_dup                     (glLabel       *label);
+
 
 void          gl_label_set_filename            (glLabel       *label,
 						const gchar   *filename);
@@ -108,6 +110,22 @@ void          gl_label_clear_modified          (glLabel       *label);
 gboolean      gl_label_is_modified             (glLabel       *label);
 
 
+void          gl_label_begin_batch_update      (glLabel       *label);
+
+void          gl_label_end_batch_update        (glLabel       *label);
+
+gboolean      gl_label_is_batch_update         (glLabel       *label);
+
+void          gl_label_batch_object_changed    (glLabel       *label,
+                                                glLabelObject *object);
+
+void          gl_label_batch_object_moved      (glLabel       *label,
+                                                glLabelObject *object);
+
+gboolean      gl_label_get_changed_region      (glLabel       *label,
+                                                glLabelRegion *region);
+
+
 void          gl_label_set_template            (glLabel            *label,
 						const lglTemplate  *template,
                                                 gboolean            checkpoint);
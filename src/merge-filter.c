@@ -0,0 +1,807 @@
+/*
+ *  merge-filter.c
+ *  Copyright (C) 2001-2009  Jim Evins <evins@snaught.com>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "merge-filter.h"
+
+#include <glib/gi18n.h>
+#include <string.h>
+
+#include "debug.h"
+
+
+/*===========================================*/
+/* Private types                             */
+/*===========================================*/
+
+typedef enum {
+        TOKEN_END,
+        TOKEN_LPAREN,
+        TOKEN_RPAREN,
+        TOKEN_AND,
+        TOKEN_OR,
+        TOKEN_NOT,
+        TOKEN_BETWEEN,
+        TOKEN_OP,
+        TOKEN_WORD,
+        TOKEN_STRING,
+        TOKEN_KEY
+} TokenType;
+
+typedef enum {
+        OP_EQ,
+        OP_NE,
+        OP_LT,
+        OP_LE,
+        OP_GT,
+        OP_GE,
+        OP_MATCH,
+        OP_NOT_MATCH,
+        OP_BETWEEN
+} Op;
+
+typedef enum {
+        NODE_AND,
+        NODE_OR,
+        NODE_NOT,
+        NODE_COMPARE
+} NodeType;
+
+/* Comparison value, with its number parsed once if it is one. */
+typedef struct {
+        gchar    *text;
+        gboolean  numeric;
+        gdouble   number;
+} Literal;
+
+typedef struct _Node Node;
+
+struct _Node {
+        NodeType  type;
+
+        Node     *left;         /* AND, OR, NOT */
+        Node     *right;        /* AND, OR */
+
+        gchar    *key;          /* COMPARE */
+        Op        op;
+        Literal   value;
+        Literal   value2;       /* upper bound of OP_BETWEEN */
+        GRegex   *regex;        /* OP_MATCH, OP_NOT_MATCH */
+};
+
+struct _glMergeFilter {
+        gchar    *expression;
+        Node     *root;
+};
+
+typedef struct {
+        const gchar  *expression;
+        const gchar  *p;
+
+        /* Current token. */
+        TokenType     type;
+        Op            op;
+        gchar        *text;
+        gint          pos;
+
+        GError      **error;
+} Parser;
+
+
+/*===========================================*/
+/* Private globals                           */
+/*===========================================*/
+
+/* Characters that end an unquoted word. */
+#define SPECIAL_CHARS "()\"'=!<>~&|"
+
+
+/*===========================================*/
+/* Local function prototypes                 */
+/*===========================================*/
+
+static gboolean     next_token       (Parser              *parser);
+static void         syntax_error     (Parser              *parser);
+
+static Node        *parse_or         (Parser              *parser);
+static Node        *parse_and        (Parser              *parser);
+static Node        *parse_unary      (Parser              *parser);
+static Node        *parse_comparison (Parser              *parser);
+static gboolean     parse_literal    (Parser              *parser,
+                                      Literal             *literal);
+
+static Node        *node_new_binary  (NodeType             type,
+                                      Node                *left,
+                                      Node                *right);
+static void         node_free        (Node                *node);
+
+static gboolean     node_eval        (const Node          *node,
+                                      const glMergeRecord *record);
+
+static gboolean     parse_number     (const gchar         *text,
+                                      gdouble             *number);
+static gint         compare_value    (const gchar         *value,
+                                      const Literal       *literal);
+static const gchar *lookup_value     (const glMergeRecord *record,
+                                      const gchar         *key);
+
+
+/*****************************************************************************/
+/* Error domain of filter parse errors.                                      */
+/*****************************************************************************/
+GQuark
+gl_merge_filter_error_quark (void)
+{
+        return g_quark_from_static_string ("gl-merge-filter-error-quark");
+}
+
+
+/*****************************************************************************/
+/* Parse filter expression.  Returns NULL and sets error if it is invalid.   */
+/*****************************************************************************/
+glMergeFilter *
+gl_merge_filter_new (const gchar  *expression,
+                     GError      **error)
+{
+        Parser         parser;
+        Node          *root = NULL;
+        glMergeFilter *filter;
+
+        gl_debug (DEBUG_MERGE, "START");
+
+        g_return_val_if_fail (expression != NULL, NULL);
+
+        memset (&parser, 0, sizeof (Parser));
+        parser.expression = expression;
+        parser.p          = expression;
+        parser.error      = error;
+
+        if ( next_token (&parser) )
+        {
+                root = parse_or (&parser);
+                if ( (root != NULL) && (parser.type != TOKEN_END) )
+                {
+                        syntax_error (&parser);
+                        node_free (root);
+                        root = NULL;
+                }
+        }
+        g_free (parser.text);
+
+        if ( root == NULL )
+        {
+                gl_debug (DEBUG_MERGE, "END invalid");
+                return NULL;
+        }
+
+        filter = g_new0 (glMergeFilter, 1);
+        filter->expression = g_strdup (expression);
+        filter->root       = root;
+
+        gl_debug (DEBUG_MERGE, "END");
+
+        return filter;
+}
+
+
+/*****************************************************************************/
+/* Free filter.                                                              */
+/*****************************************************************************/
+void
+gl_merge_filter_free (glMergeFilter *filter)
+{
+        if ( filter != NULL )
+        {
+                node_free (filter->root);
+                g_free (filter->expression);
+                g_free (filter);
+        }
+}
+
+
+/*****************************************************************************/
+/* Get expression filter was parsed from.                                    */
+/*****************************************************************************/
+const gchar *
+gl_merge_filter_get_expression (const glMergeFilter *filter)
+{
+        g_return_val_if_fail (filter != NULL, NULL);
+
+        return filter->expression;
+}
+
+
+/*****************************************************************************/
+/* Does record pass filter?                                                  */
+/*****************************************************************************/
+gboolean
+gl_merge_filter_eval (const glMergeFilter *filter,
+                      const glMergeRecord *record)
+{
+        g_return_val_if_fail (filter != NULL, TRUE);
+
+        return node_eval (filter->root, record);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Read next token.  Returns FALSE on a lexical error.            */
+/*--------------------------------------------------------------------------*/
+static gboolean
+next_token (Parser *parser)
+{
+        const gchar *p;
+        const gchar *start;
+        GString     *string;
+        gchar        quote;
+
+        g_free (parser->text);
+        parser->text = NULL;
+
+        for ( p = parser->p; g_ascii_isspace (*p); p++ );
+        parser->pos = p - parser->expression;
+
+        switch (*p)
+        {
+
+        case '\0':
+                parser->type = TOKEN_END;
+                break;
+
+        case '(':
+                parser->type = TOKEN_LPAREN;
+                p++;
+                break;
+
+        case ')':
+                parser->type = TOKEN_RPAREN;
+                p++;
+                break;
+
+        case '&':
+        case '|':
+                if ( p[1] != p[0] )
+                {
+                        syntax_error (parser);
+                        return FALSE;
+                }
+                parser->type = (*p == '&') ? TOKEN_AND : TOKEN_OR;
+                p += 2;
+                break;
+
+        case '!':
+                if ( p[1] == '=' )
+                {
+                        parser->type = TOKEN_OP;
+                        parser->op   = OP_NE;
+                        p += 2;
+                }
+                else if ( p[1] == '~' )
+                {
+                        parser->type = TOKEN_OP;
+                        parser->op   = OP_NOT_MATCH;
+                        p += 2;
+                }
+                else
+                {
+                        parser->type = TOKEN_NOT;
+                        p++;
+                }
+                break;
+
+        case '=':
+                parser->type = TOKEN_OP;
+                parser->op   = OP_EQ;
+                p += (p[1] == '=') ? 2 : 1;
+                break;
+
+        case '<':
+        case '>':
+                parser->type = TOKEN_OP;
+                if ( p[1] == '=' )
+                {
+                        parser->op = (*p == '<') ? OP_LE : OP_GE;
+                        p += 2;
+                }
+                else
+                {
+                        parser->op = (*p == '<') ? OP_LT : OP_GT;
+                        p++;
+                }
+                break;
+
+        case '~':
+                parser->type = TOKEN_OP;
+                parser->op   = OP_MATCH;
+                p++;
+                break;
+
+        case '"':
+        case '\'':
+                /* Quoted string, backslash escapes the next character. */
+                quote  = *p++;
+                string = g_string_new ("");
+                while ( (*p != quote) && (*p != '\0') )
+                {
+                        if ( (*p == '\\') && (p[1] != '\0') )
+                        {
+                                p++;
+                        }
+                        g_string_append_c (string, *p++);
+                }
+                if ( *p == '\0' )
+                {
+                        g_string_free (string, TRUE);
+                        syntax_error (parser);
+                        return FALSE;
+                }
+                p++;
+                parser->type = TOKEN_STRING;
+                parser->text = g_string_free (string, FALSE);
+                break;
+
+        default:
+                if ( (p[0] == '$') && (p[1] == '{') )
+                {
+                        /* Field key in "${...}" form. */
+                        start = p + 2;
+                        p = strchr (start, '}');
+                        if ( p == NULL )
+                        {
+                                syntax_error (parser);
+                                return FALSE;
+                        }
+                        parser->type = TOKEN_KEY;
+                        parser->text = g_strndup (start, p - start);
+                        p++;
+                }
+                else
+                {
+                        /* Plain word, which may be a keyword. */
+                        start = p;
+                        while ( (*p != '\0') && !g_ascii_isspace (*p) &&
+                                (strchr (SPECIAL_CHARS, *p) == NULL) )
+                        {
+                                p++;
+                        }
+                        parser->text = g_strndup (start, p - start);
+
+                        if ( g_ascii_strcasecmp (parser->text, "and") == 0 )
+                        {
+                                parser->type = TOKEN_AND;
+                        }
+                        else if ( g_ascii_strcasecmp (parser->text, "or") == 0 )
+                        {
+                                parser->type = TOKEN_OR;
+                        }
+                        else if ( g_ascii_strcasecmp (parser->text, "not") == 0 )
+                        {
+                                parser->type = TOKEN_NOT;
+                        }
+                        else if ( g_ascii_strcasecmp (parser->text, "between") == 0 )
+                        {
+                                parser->type = TOKEN_BETWEEN;
+                        }
+                        else
+                        {
+                                parser->type = TOKEN_WORD;
+                        }
+                }
+                break;
+
+        }
+
+        parser->p = p;
+
+        return TRUE;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Report syntax error at current token.                          */
+/*--------------------------------------------------------------------------*/
+static void
+syntax_error (Parser *parser)
+{
+        if ( parser->expression[parser->pos] == '\0' )
+        {
+                g_set_error (parser->error, GL_MERGE_FILTER_ERROR, GL_MERGE_FILTER_ERROR_SYNTAX,
+                             _("Unexpected end of filter expression"));
+        }
+        else
+        {
+                g_set_error (parser->error, GL_MERGE_FILTER_ERROR, GL_MERGE_FILTER_ERROR_SYNTAX,
+                             _("Syntax error in filter expression at position %d"),
+                             parser->pos + 1);
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  or_expr := and_expr { "or" and_expr }                          */
+/*--------------------------------------------------------------------------*/
+static Node *
+parse_or (Parser *parser)
+{
+        Node *left, *right;
+
+        left = parse_and (parser);
+        while ( (left != NULL) && (parser->type == TOKEN_OR) )
+        {
+                right = next_token (parser) ? parse_and (parser) : NULL;
+                if ( right == NULL )
+                {
+                        node_free (left);
+                        return NULL;
+                }
+                left = node_new_binary (NODE_OR, left, right);
+        }
+
+        return left;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  and_expr := unary { "and" unary }                              */
+/*--------------------------------------------------------------------------*/
+static Node *
+parse_and (Parser *parser)
+{
+        Node *left, *right;
+
+        left = parse_unary (parser);
+        while ( (left != NULL) && (parser->type == TOKEN_AND) )
+        {
+                right = next_token (parser) ? parse_unary (parser) : NULL;
+                if ( right == NULL )
+                {
+                        node_free (left);
+                        return NULL;
+                }
+                left = node_new_binary (NODE_AND, left, right);
+        }
+
+        return left;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  unary := "not" unary | "(" or_expr ")" | comparison            */
+/*--------------------------------------------------------------------------*/
+static Node *
+parse_unary (Parser *parser)
+{
+        Node *node;
+
+        switch (parser->type)
+        {
+
+        case TOKEN_NOT:
+                node = next_token (parser) ? parse_unary (parser) : NULL;
+                if ( node == NULL )
+                {
+                        return NULL;
+                }
+                return node_new_binary (NODE_NOT, node, NULL);
+
+        case TOKEN_LPAREN:
+                node = next_token (parser) ? parse_or (parser) : NULL;
+                if ( node == NULL )
+                {
+                        return NULL;
+                }
+                if ( parser->type != TOKEN_RPAREN )
+                {
+                        syntax_error (parser);
+                        node_free (node);
+                        return NULL;
+                }
+                if ( !next_token (parser) )
+                {
+                        node_free (node);
+                        return NULL;
+                }
+                return node;
+
+        default:
+                return parse_comparison (parser);
+
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  comparison := key op value | key "between" value "and" value   */
+/*--------------------------------------------------------------------------*/
+static Node *
+parse_comparison (Parser *parser)
+{
+        Node   *node;
+        GError *regex_error = NULL;
+
+        if ( (parser->type != TOKEN_WORD) && (parser->type != TOKEN_KEY) &&
+             (parser->type != TOKEN_STRING) )
+        {
+                syntax_error (parser);
+                return NULL;
+        }
+
+        node = g_new0 (Node, 1);
+        node->type = NODE_COMPARE;
+        node->key  = parser->text;
+        parser->text = NULL;
+
+        if ( !next_token (parser) )
+        {
+                node_free (node);
+                return NULL;
+        }
+
+        if ( parser->type == TOKEN_BETWEEN )
+        {
+                node->op = OP_BETWEEN;
+                if ( !next_token (parser) || !parse_literal (parser, &node->value) )
+                {
+                        node_free (node);
+                        return NULL;
+                }
+                if ( parser->type != TOKEN_AND )
+                {
+                        syntax_error (parser);
+                        node_free (node);
+                        return NULL;
+                }
+                if ( !next_token (parser) || !parse_literal (parser, &node->value2) )
+                {
+                        node_free (node);
+                        return NULL;
+                }
+        }
+        else if ( parser->type == TOKEN_OP )
+        {
+                node->op = parser->op;
+                if ( !next_token (parser) || !parse_literal (parser, &node->value) )
+                {
+                        node_free (node);
+                        return NULL;
+                }
+        }
+        else
+        {
+                syntax_error (parser);
+                node_free (node);
+                return NULL;
+        }
+
+        if ( (node->op == OP_MATCH) || (node->op == OP_NOT_MATCH) )
+        {
+                node->regex = g_regex_new (node->value.text, G_REGEX_OPTIMIZE, 0, &regex_error);
+                if ( node->regex == NULL )
+                {
+                        g_set_error (parser->error, GL_MERGE_FILTER_ERROR, GL_MERGE_FILTER_ERROR_REGEX,
+                                     "%s", regex_error->message);
+                        g_error_free (regex_error);
+                        node_free (node);
+                        return NULL;
+                }
+        }
+
+        return node;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Take current word or string token as a comparison value.       */
+/*--------------------------------------------------------------------------*/
+static gboolean
+parse_literal (Parser  *parser,
+               Literal *literal)
+{
+        if ( (parser->type != TOKEN_WORD) && (parser->type != TOKEN_STRING) )
+        {
+                syntax_error (parser);
+                return FALSE;
+        }
+
+        literal->text    = parser->text;
+        literal->numeric = parse_number (literal->text, &literal->number);
+        parser->text = NULL;
+
+        return next_token (parser);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  New AND, OR or NOT node.                                       */
+/*--------------------------------------------------------------------------*/
+static Node *
+node_new_binary (NodeType  type,
+                 Node     *left,
+                 Node     *right)
+{
+        Node *node;
+
+        node = g_new0 (Node, 1);
+        node->type  = type;
+        node->left  = left;
+        node->right = right;
+
+        return node;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Free node and its children.                                    */
+/*--------------------------------------------------------------------------*/
+static void
+node_free (Node *node)
+{
+        if ( node != NULL )
+        {
+                node_free (node->left);
+                node_free (node->right);
+                g_free (node->key);
+                g_free (node->value.text);
+                g_free (node->value2.text);
+                if ( node->regex != NULL )
+                {
+                        g_regex_unref (node->regex);
+                }
+                g_free (node);
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Evaluate node for record.                                      */
+/*--------------------------------------------------------------------------*/
+static gboolean
+node_eval (const Node          *node,
+           const glMergeRecord *record)
+{
+        const gchar *value;
+
+        switch (node->type)
+        {
+
+        case NODE_AND:
+                return node_eval (node->left, record) && node_eval (node->right, record);
+
+        case NODE_OR:
+                return node_eval (node->left, record) || node_eval (node->right, record);
+
+        case NODE_NOT:
+                return !node_eval (node->left, record);
+
+        default:
+                break;
+
+        }
+
+        value = lookup_value (record, node->key);
+
+        switch (node->op)
+        {
+        case OP_EQ:
+                return compare_value (value, &node->value) == 0;
+        case OP_NE:
+                return compare_value (value, &node->value) != 0;
+        case OP_LT:
+                return compare_value (value, &node->value) < 0;
+        case OP_LE:
+                return compare_value (value, &node->value) <= 0;
+        case OP_GT:
+                return compare_value (value, &node->value) > 0;
+        case OP_GE:
+                return compare_value (value, &node->value) >= 0;
+        case OP_MATCH:
+                return g_regex_match (node->regex, value, 0, NULL);
+        case OP_NOT_MATCH:
+                return !g_regex_match (node->regex, value, 0, NULL);
+        case OP_BETWEEN:
+                return (compare_value (value, &node->value) >= 0) &&
+                        (compare_value (value, &node->value2) <= 0);
+        default:
+                g_assert_not_reached ();
+                return FALSE;
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Parse text as a number, in C locale.  Surrounding white space   */
+/* is allowed, anything else is not.                                        */
+/*--------------------------------------------------------------------------*/
+static gboolean
+parse_number (const gchar *text,
+              gdouble     *number)
+{
+        gchar *end;
+
+        *number = g_ascii_strtod (text, &end);
+        if ( end == text )
+        {
+                return FALSE;
+        }
+        while ( g_ascii_isspace (*end) )
+        {
+                end++;
+        }
+
+        return (*end == '\0');
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Compare field value to literal, as numbers if both are.        */
+/*--------------------------------------------------------------------------*/
+static gint
+compare_value (const gchar   *value,
+               const Literal *literal)
+{
+        gdouble number;
+        gint    result;
+
+        if ( literal->numeric && parse_number (value, &number) )
+        {
+                return (number > literal->number) - (number < literal->number);
+        }
+
+        result = strcmp (value, literal->text);
+
+        return (result > 0) - (result < 0);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Value of field key in record, without copying it.              */
+/*--------------------------------------------------------------------------*/
+static const gchar *
+lookup_value (const glMergeRecord *record,
+              const gchar         *key)
+{
+        GList        *p;
+        glMergeField *field;
+
+        for ( p = record->field_list; p != NULL; p = p->next )
+        {
+                field = (glMergeField *)p->data;
+
+                if ( (field->key != NULL) && (strcmp (key, field->key) == 0) )
+                {
+                        return (field->value != NULL) ? field->value : "";
+                }
+        }
+
+        return "";
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
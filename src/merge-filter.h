@@ -0,0 +1,80 @@
+/*
+ *  merge-filter.h
+ *  Copyright (C) 2001-2009  Jim Evins <evins@snaught.com>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MERGE_FILTER_H__
+#define __MERGE_FILTER_H__
+
+#include <glib.h>
+
+#include "merge.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Record filter expressions, e.g.
+ *
+ *     State = "NY" and (Age between 18 and 65 or Name ~ "^Mc")
+ *
+ * A comparison is a merge field key, an operator and a value.  Operators are
+ * "=", "!=", "<", "<=", ">", ">=", "~" (matches regular expression), "!~"
+ * (does not match) and "between LOW and HIGH" (inclusive).  Comparisons are
+ * numeric when both sides are numbers, otherwise by string.  They combine
+ * with "and", "or", "not" (or "&&", "||", "!") and parentheses.  Keys that
+ * are not plain words are written "${Key}"; values may be quoted with " or '.
+ * A field missing from a record has the empty string as its value.
+ */
+
+#define GL_MERGE_FILTER_ERROR gl_merge_filter_error_quark ()
+
+typedef enum {
+        GL_MERGE_FILTER_ERROR_SYNTAX,
+        GL_MERGE_FILTER_ERROR_REGEX
+} glMergeFilterError;
+
+typedef struct _glMergeFilter glMergeFilter;
+
+
+GQuark          gl_merge_filter_error_quark (void);
+
+glMergeFilter  *gl_merge_filter_new         (const gchar          *expression,
+                                             GError              **error);
+
+void            gl_merge_filter_free        (glMergeFilter        *filter);
+
+const gchar    *gl_merge_filter_get_expression (const glMergeFilter *filter);
+
+gboolean        gl_merge_filter_eval        (const glMergeFilter  *filter,
+                                             const glMergeRecord  *record);
+
+G_END_DECLS
+
+#endif
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
@@ -28,6 +28,7 @@
 
 #include "label.h"
 #include "merge.h"
+#include "merge-record-model.h"
 #include "combo-util.h"
 #include "builder-util.h"
 
@@ -50,11 +51,13 @@ struct _glMergePropertiesDialogPrivate {
 	GtkWidget    *location_vbox;
 	GtkWidget    *src_entry;
 
-	GtkTreeStore *store;
+	glMergeRecordModel *model;
 	GtkWidget    *treeview;
 
 	GtkWidget    *select_all_button;
 	GtkWidget    *unselect_all_button;
+	GtkWidget    *filter_entry;
+	GtkWidget    *select_matching_button;
 
         GtkWidget    *ok_button;
 
@@ -62,20 +65,6 @@ struct _glMergePropertiesDialogPrivate {
 
 };
 
-enum {
-	/* Real columns */
-	SELECT_COLUMN,
-	RECORD_FIELD_COLUMN,
-	VALUE_COLUMN,
-
-	/* Invisible columns */
-	IS_RECORD_COLUMN,
-	DATA_COLUMN, /* points to glMergeRecord */
-
-	N_COLUMNS
-};
-
-
 /*===========================================*/
 /* Private globals                           */
 /*===========================================*/
@@ -100,12 +89,13 @@ static void response_cb                           (glMergePropertiesDialog
 					           gint                          response,
 						   gpointer                      user_data);
 
-static void load_tree                             (GtkTreeStore                 *store,
-					           glMerge                      *merge);
+static void load_tree                             (glMergePropertiesDialog      *dialog);
+
+static void clear_tree                            (glMergePropertiesDialog      *dialog);
 
 static void record_select_toggled_cb              (GtkCellRendererToggle        *cell,
 						   gchar                        *path_str,
-						   GtkTreeStore                 *store);
+						   glMergePropertiesDialog      *dialog);
 
 static void select_all_button_clicked_cb          (GtkWidget                    *widget,
 						   glMergePropertiesDialog      *dialog);
@@ -113,6 +103,9 @@ static void select_all_button_clicked_cb          (GtkWidget
 static void unselect_all_button_clicked_cb        (GtkWidget                    *widget,
 						   glMergePropertiesDialog      *dialog);
 
+static void select_matching_cb                    (GtkWidget                    *widget,
+						   glMergePropertiesDialog      *dialog);
+
 
 /*****************************************************************************/
 /* Boilerplate object stuff.                                                 */
@@ -179,6 +172,8 @@ gl_merge_properties_dialog_init (glMergePropertiesDialog *dialog)
                                      "treeview",              &dialog->priv->treeview,
                                      "select_all_button",     &dialog->priv->select_all_button,
                                      "unselect_all_button",   &dialog->priv->unselect_all_button,
+                                     "filter_entry",          &dialog->priv->filter_entry,
+                                     "select_matching_button", &dialog->priv->select_matching_button,
                                      NULL);
 
 	gtk_container_add (GTK_CONTAINER (vbox), merge_properties_vbox);
@@ -206,6 +201,9 @@ gl_merge_properties_dialog_finalize (GObject *object)
 	g_return_if_fail (GL_IS_MERGE_PROPERTIES_DIALOG (dialog));
 	g_return_if_fail (dialog->priv != NULL);
 
+	if (dialog->priv->model != NULL) {
+		g_object_unref (G_OBJECT (dialog->priv->model));
+	}
 	if (dialog->priv->merge != NULL) {
 		g_object_unref (G_OBJECT (dialog->priv->merge));
 	}
@@ -320,16 +318,7 @@ gl_merge_properties_dialog_construct (glMergePropertiesDialog *dialog,
 			    dialog->priv->src_entry, FALSE, FALSE, 0);
 	gtk_widget_show_all (GTK_WIDGET (dialog->priv->location_vbox));
 
-	dialog->priv->store = gtk_tree_store_new (N_COLUMNS,
-					  G_TYPE_BOOLEAN, /* Record selector */
-					  G_TYPE_STRING,  /* Record/Field name */
-					  G_TYPE_STRING,  /* Field value */
-					  G_TYPE_BOOLEAN, /* Is Record? */
-					  G_TYPE_POINTER  /* Pointer to record */);
-	load_tree (dialog->priv->store, dialog->priv->merge);
-
-	gtk_tree_view_set_model (GTK_TREE_VIEW (dialog->priv->treeview),
-				 GTK_TREE_MODEL (dialog->priv->store));
+	load_tree (dialog);
 
 	gtk_tree_view_set_rules_hint (GTK_TREE_VIEW (dialog->priv->treeview),
 				      TRUE);
@@ -337,16 +326,16 @@ gl_merge_properties_dialog_construct (glMergePropertiesDialog *dialog,
 	gtk_tree_selection_set_mode (selection, GTK_SELECTION_NONE);
 	renderer = gtk_cell_renderer_toggle_new ();
 	g_signal_connect (G_OBJECT (renderer), "toggled",
-			  G_CALLBACK (record_select_toggled_cb), dialog->priv->store);
+			  G_CALLBACK (record_select_toggled_cb), dialog);
 	column = gtk_tree_view_column_new_with_attributes (_("Select"), renderer,
-							   "active", SELECT_COLUMN,
-							   "visible", IS_RECORD_COLUMN,
+							   "active", GL_MERGE_RECORD_MODEL_SELECT_COLUMN,
+							   "visible", GL_MERGE_RECORD_MODEL_IS_RECORD_COLUMN,
 							   NULL);
 	gtk_tree_view_append_column (GTK_TREE_VIEW (dialog->priv->treeview), column);
 	renderer = gtk_cell_renderer_text_new ();
 	g_object_set (G_OBJECT (renderer), "yalign", 0.0, NULL);
 	column = gtk_tree_view_column_new_with_attributes (_("Record/Field"), renderer,
-							   "text", RECORD_FIELD_COLUMN,
+							   "text", GL_MERGE_RECORD_MODEL_RECORD_FIELD_COLUMN,
 							   NULL);
 	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_AUTOSIZE);
 	gtk_tree_view_append_column (GTK_TREE_VIEW (dialog->priv->treeview), column);
@@ -354,7 +343,7 @@ gl_merge_properties_dialog_construct (glMergePropertiesDialog *dialog,
 	renderer = gtk_cell_renderer_text_new ();
 	g_object_set (G_OBJECT (renderer), "yalign", 0.0, NULL);
 	column = gtk_tree_view_column_new_with_attributes (_("Data"), renderer,
-							   "text", VALUE_COLUMN,
+							   "text", GL_MERGE_RECORD_MODEL_VALUE_COLUMN,
 							   NULL);
 	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_AUTOSIZE);
 	gtk_tree_view_append_column (GTK_TREE_VIEW (dialog->priv->treeview), column);
@@ -367,6 +356,14 @@ gl_merge_properties_dialog_construct (glMergePropertiesDialog *dialog,
 			  "clicked",
 			  G_CALLBACK (unselect_all_button_clicked_cb), dialog);
 
+	g_signal_connect (G_OBJECT (dialog->priv->select_matching_button),
+			  "clicked",
+			  G_CALLBACK (select_matching_cb), dialog);
+
+	g_signal_connect (G_OBJECT (dialog->priv->filter_entry),
+			  "activate",
+			  G_CALLBACK (select_matching_cb), dialog);
+
 
 	g_free (src);
 	g_free (description);
@@ -451,7 +448,7 @@ type_changed_cb (GtkWidget               *widget,
 			    dialog->priv->src_entry, FALSE, FALSE, 0);
 	gtk_widget_show_all (dialog->priv->location_vbox);
 
-	load_tree (dialog->priv->store, dialog->priv->merge);
+	load_tree (dialog);
 
 	g_free (description);
 	g_free (name);
@@ -480,8 +477,10 @@ src_changed_cb (GtkWidget               *widget,
 	    ((orig_src != NULL) && (src == NULL)) ||
 	    ((orig_src != NULL) && (src != NULL) && strcmp (src, orig_src)))
 	{
+		/* The model points into the record list about to be replaced. */
+		clear_tree (dialog);
 		gl_merge_set_src (dialog->priv->merge, src);
-		load_tree (dialog->priv->store, dialog->priv->merge);
+		load_tree (dialog);
 	}
 
 	g_free (orig_src);
@@ -524,57 +523,35 @@ response_cb (glMergePropertiesDialog *dialog,
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Load tree store from merge data.                               */
+/* PRIVATE.  Show records of current merge.  Rows come from the records on  */
+/* demand, so this is cheap however many records there are.                 */
 /*--------------------------------------------------------------------------*/
 static void
-load_tree (GtkTreeStore           *store,
-	   glMerge                *merge)
+load_tree (glMergePropertiesDialog *dialog)
 {
-	const GList   *record_list;
-	GList         *p_rec, *p_field;
-	glMergeRecord *record;
-	glMergeField  *field;
-	GtkTreeIter    iter1, iter2;
-	gchar         *primary_key;
-	gchar         *primary_value;
-
 	gl_debug (DEBUG_MERGE, "START");
 
-	gtk_tree_store_clear (store);
-
-	primary_key = gl_merge_get_primary_key (merge);
-	record_list = gl_merge_get_record_list (merge);
-
-	for ( p_rec=(GList *)record_list; p_rec!=NULL; p_rec=p_rec->next ) {
-		record = (glMergeRecord *)p_rec->data;
-		
-		primary_value = gl_merge_eval_key (record, primary_key);
+	clear_tree (dialog);
 
-		gtk_tree_store_append (store, &iter1, NULL);
-		gtk_tree_store_set (store, &iter1,
-				    SELECT_COLUMN,       record->select_flag,
-				    RECORD_FIELD_COLUMN, primary_value,
-				    IS_RECORD_COLUMN,    TRUE,
-				    DATA_COLUMN,         record,
-				    -1);
+	dialog->priv->model = gl_merge_record_model_new (dialog->priv->merge);
+	gtk_tree_view_set_model (GTK_TREE_VIEW (dialog->priv->treeview),
+				 GTK_TREE_MODEL (dialog->priv->model));
 
-		g_free (primary_value);
+	gl_debug (DEBUG_MERGE, "END");
+}
 
-		for ( p_field=record->field_list; p_field!=NULL; p_field=p_field->next ) {
-			field = (glMergeField *)p_field->data;
 
-			gtk_tree_store_append (store, &iter2, &iter1);
-			gtk_tree_store_set (store, &iter2,
-					    RECORD_FIELD_COLUMN, field->key,
-					    VALUE_COLUMN,        field->value,
-					    IS_RECORD_COLUMN,    FALSE,
-					    -1);
-		}
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Drop record model.                                             */
+/*--------------------------------------------------------------------------*/
+static void
+clear_tree (glMergePropertiesDialog *dialog)
+{
+	if (dialog->priv->model != NULL) {
+		gtk_tree_view_set_model (GTK_TREE_VIEW (dialog->priv->treeview), NULL);
+		g_object_unref (G_OBJECT (dialog->priv->model));
+		dialog->priv->model = NULL;
 	}
-
-	g_free (primary_key);
-
-	gl_debug (DEBUG_MERGE, "END");
 }
 
 
@@ -582,34 +559,16 @@ load_tree (GtkTreeStore           *store,
 /* PRIVATE.  Record select toggled.                                         */
 /*--------------------------------------------------------------------------*/
 static void
-record_select_toggled_cb (GtkCellRendererToggle *cell,
-			  gchar                 *path_str,
-			  GtkTreeStore          *store)
+record_select_toggled_cb (GtkCellRendererToggle   *cell,
+			  gchar                   *path_str,
+			  glMergePropertiesDialog *dialog)
 {
 	GtkTreePath   *path;
-	GtkTreeIter    iter;
-	glMergeRecord *record;
 
 	gl_debug (DEBUG_MERGE, "START");
 
-	/* get toggled iter */
 	path = gtk_tree_path_new_from_string (path_str);
-	gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, path);
-
-	/* get current data */
-	gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
-			    DATA_COLUMN,   &record,
-			    -1);
-
-	/* toggle the select flag within the record */
-	record->select_flag ^= 1;
-
-	/* set new value in store */
-	gtk_tree_store_set (store, &iter,
-			    SELECT_COLUMN, record->select_flag,
-			    -1);
-
-	/* clean up */
+	gl_merge_record_model_toggle (dialog->priv->model, path);
 	gtk_tree_path_free (path);
 
 	gl_debug (DEBUG_MERGE, "END");
@@ -623,33 +582,10 @@ static void
 select_all_button_clicked_cb (GtkWidget                    *widget,
 			      glMergePropertiesDialog      *dialog)
 {
-	GtkTreeModel  *store = GTK_TREE_MODEL (dialog->priv->store);
-	GtkTreeIter    iter;
-	glMergeRecord *record;
-	gboolean       good;
-
 	gl_debug (DEBUG_MERGE, "START");
 
-	for ( good = gtk_tree_model_get_iter_first (store, &iter);
-	      good;
-	      good = gtk_tree_model_iter_next (store, &iter) )
-	{
-		
-		/* get current data */
-		gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
-				    DATA_COLUMN,   &record,
-				    -1);
-
-		
-		/* Set select flag within the record */
-		record->select_flag = TRUE;
-
-		/* set new value in store */
-		gtk_tree_store_set (GTK_TREE_STORE (store), &iter,
-				    SELECT_COLUMN, record->select_flag,
-				    -1);
-
-	}
+	gl_merge_record_model_select_all (dialog->priv->model, TRUE);
+	gtk_widget_queue_draw (dialog->priv->treeview);
 
 	gl_debug (DEBUG_MERGE, "END");
 }
@@ -662,33 +598,44 @@ static void
 unselect_all_button_clicked_cb (GtkWidget                    *widget,
 				glMergePropertiesDialog      *dialog)
 {
-	GtkTreeModel  *store = GTK_TREE_MODEL (dialog->priv->store);
-	GtkTreeIter    iter;
-	glMergeRecord *record;
-	gboolean       good;
-
 	gl_debug (DEBUG_MERGE, "START");
 
-	for ( good = gtk_tree_model_get_iter_first (store, &iter);
-	      good;
-	      good = gtk_tree_model_iter_next (store, &iter) )
-	{
-		
-		/* get current data */
-		gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
-				    DATA_COLUMN,   &record,
-				    -1);
+	gl_merge_record_model_select_all (dialog->priv->model, FALSE);
+	gtk_widget_queue_draw (dialog->priv->treeview);
 
-		
-		/* Set select flag within the record */
-		record->select_flag = FALSE;
+	gl_debug (DEBUG_MERGE, "END");
+}
 
-		/* set new value in store */
-		gtk_tree_store_set (GTK_TREE_STORE (store), &iter,
-				    SELECT_COLUMN, record->select_flag,
-				    -1);
 
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  "Select matching" button or filter entry activated callback.   */
+/*--------------------------------------------------------------------------*/
+static void
+select_matching_cb (GtkWidget                    *widget,
+		    glMergePropertiesDialog      *dialog)
+{
+	GtkEntry      *entry = GTK_ENTRY (dialog->priv->filter_entry);
+	glMergeFilter *filter;
+	GError        *error = NULL;
+
+	gl_debug (DEBUG_MERGE, "START");
+
+	filter = gl_merge_filter_new (gtk_entry_get_text (entry), &error);
+	if (filter == NULL) {
+		gtk_entry_set_icon_from_icon_name (entry, GTK_ENTRY_ICON_SECONDARY,
+						   "dialog-error");
+		gtk_entry_set_icon_tooltip_text (entry, GTK_ENTRY_ICON_SECONDARY,
+						 error->message);
+		g_error_free (error);
+		gl_debug (DEBUG_MERGE, "END (invalid)");
+		return;
 	}
+	gtk_entry_set_icon_from_icon_name (entry, GTK_ENTRY_ICON_SECONDARY, NULL);
+
+	gl_merge_record_model_select_filtered (dialog->priv->model, filter);
+	gtk_widget_queue_draw (dialog->priv->treeview);
+
+	gl_merge_filter_free (filter);
 
 	gl_debug (DEBUG_MERGE, "END");
 }
@@ -0,0 +1,590 @@
+/*
+ *  merge-record-model.c
+ *  Copyright (C) 2001-2009  Jim Evins <evins@snaught.com>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "merge-record-model.h"
+
+#include "debug.h"
+
+
+/*
+ * Iters carry the record index in user_data and the field index + 1 in
+ * user_data2; a user_data2 of 0 is the record row itself.
+ */
+#define ITER_RECORD(iter) GPOINTER_TO_INT ((iter)->user_data)
+#define ITER_FIELD(iter)  (GPOINTER_TO_INT ((iter)->user_data2) - 1)
+
+
+/*===========================================*/
+/* Private types                             */
+/*===========================================*/
+
+struct _glMergeRecordModelPrivate {
+
+        gint            stamp;
+
+        glMerge        *merge;
+        gchar          *primary_key;
+
+        glMergeRecord **records;
+        gint            n_records;
+
+        /* Field arrays, filled in for a record when its children are asked for. */
+        GPtrArray     **fields;
+};
+
+
+/*===========================================*/
+/* Private globals                           */
+/*===========================================*/
+
+
+/*===========================================*/
+/* Local function prototypes                 */
+/*===========================================*/
+
+static void              gl_merge_record_model_tree_model_init (GtkTreeModelIface *iface);
+
+static void              gl_merge_record_model_finalize (GObject            *object);
+
+static GtkTreeModelFlags get_flags               (GtkTreeModel       *tree_model);
+static gint              get_n_columns           (GtkTreeModel       *tree_model);
+static GType             get_column_type         (GtkTreeModel       *tree_model,
+                                                  gint                index);
+static gboolean          get_iter                (GtkTreeModel       *tree_model,
+                                                  GtkTreeIter        *iter,
+                                                  GtkTreePath        *path);
+static GtkTreePath      *get_path                (GtkTreeModel       *tree_model,
+                                                  GtkTreeIter        *iter);
+static void              get_value               (GtkTreeModel       *tree_model,
+                                                  GtkTreeIter        *iter,
+                                                  gint                column,
+                                                  GValue             *value);
+static gboolean          iter_next               (GtkTreeModel       *tree_model,
+                                                  GtkTreeIter        *iter);
+static gboolean          iter_children           (GtkTreeModel       *tree_model,
+                                                  GtkTreeIter        *iter,
+                                                  GtkTreeIter        *parent);
+static gboolean          iter_has_child          (GtkTreeModel       *tree_model,
+                                                  GtkTreeIter        *iter);
+static gint              iter_n_children         (GtkTreeModel       *tree_model,
+                                                  GtkTreeIter        *iter);
+static gboolean          iter_nth_child          (GtkTreeModel       *tree_model,
+                                                  GtkTreeIter        *iter,
+                                                  GtkTreeIter        *parent,
+                                                  gint                n);
+static gboolean          iter_parent             (GtkTreeModel       *tree_model,
+                                                  GtkTreeIter        *iter,
+                                                  GtkTreeIter        *child);
+
+static GPtrArray        *get_fields              (glMergeRecordModel *model,
+                                                  gint                i_record);
+static void              set_iter                (glMergeRecordModel *model,
+                                                  GtkTreeIter        *iter,
+                                                  gint                i_record,
+                                                  gint                i_field);
+
+
+/*****************************************************************************/
+/* Boilerplate object stuff.                                                 */
+/*****************************************************************************/
+G_DEFINE_TYPE_WITH_CODE (glMergeRecordModel, gl_merge_record_model, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+                                                gl_merge_record_model_tree_model_init))
+
+
+static void
+gl_merge_record_model_class_init (glMergeRecordModelClass *class)
+{
+        GObjectClass *object_class = G_OBJECT_CLASS (class);
+
+        gl_merge_record_model_parent_class = g_type_class_peek_parent (class);
+
+        object_class->finalize = gl_merge_record_model_finalize;
+}
+
+
+static void
+gl_merge_record_model_tree_model_init (GtkTreeModelIface *iface)
+{
+        iface->get_flags       = get_flags;
+        iface->get_n_columns   = get_n_columns;
+        iface->get_column_type = get_column_type;
+        iface->get_iter        = get_iter;
+        iface->get_path        = get_path;
+        iface->get_value       = get_value;
+        iface->iter_next       = iter_next;
+        iface->iter_children   = iter_children;
+        iface->iter_has_child  = iter_has_child;
+        iface->iter_n_children = iter_n_children;
+        iface->iter_nth_child  = iter_nth_child;
+        iface->iter_parent     = iter_parent;
+}
+
+
+static void
+gl_merge_record_model_init (glMergeRecordModel *model)
+{
+        model->priv = g_new0 (glMergeRecordModelPrivate, 1);
+
+        model->priv->stamp = g_random_int ();
+}
+
+
+static void
+gl_merge_record_model_finalize (GObject *object)
+{
+        glMergeRecordModel *model = GL_MERGE_RECORD_MODEL (object);
+        gint                i;
+
+        g_return_if_fail (object && GL_IS_MERGE_RECORD_MODEL (object));
+
+        for ( i = 0; i < model->priv->n_records; i++ )
+        {
+                if ( model->priv->fields[i] != NULL )
+                {
+                        g_ptr_array_free (model->priv->fields[i], TRUE);
+                }
+        }
+        g_free (model->priv->fields);
+        g_free (model->priv->records);
+        g_free (model->priv->primary_key);
+        if ( model->priv->merge != NULL )
+        {
+                g_object_unref (model->priv->merge);
+        }
+        g_free (model->priv);
+
+        G_OBJECT_CLASS (gl_merge_record_model_parent_class)->finalize (object);
+}
+
+
+/*****************************************************************************/
+/* New model of the records of merge.  The record list of merge must not be */
+/* replaced (i.e. by gl_merge_set_src()) while the model is in use.          */
+/*****************************************************************************/
+glMergeRecordModel *
+gl_merge_record_model_new (glMerge *merge)
+{
+        glMergeRecordModel *model;
+        const GList        *p;
+        gint                i;
+
+        gl_debug (DEBUG_MERGE, "START");
+
+        model = g_object_new (GL_TYPE_MERGE_RECORD_MODEL, NULL);
+
+        if ( merge != NULL )
+        {
+                model->priv->merge       = g_object_ref (merge);
+                model->priv->primary_key = gl_merge_get_primary_key (merge);
+
+                p = gl_merge_get_record_list (merge);
+                model->priv->n_records = g_list_length ((GList *)p);
+                model->priv->records   = g_new (glMergeRecord *, model->priv->n_records);
+                model->priv->fields    = g_new0 (GPtrArray *, model->priv->n_records);
+
+                for ( i = 0; p != NULL; p = p->next, i++ )
+                {
+                        model->priv->records[i] = p->data;
+                }
+        }
+
+        gl_debug (DEBUG_MERGE, "END n_records=%d", model->priv->n_records);
+
+        return model;
+}
+
+
+/*****************************************************************************/
+/* Toggle select flag of record row at path.                                 */
+/*****************************************************************************/
+void
+gl_merge_record_model_toggle (glMergeRecordModel *model,
+                              GtkTreePath        *path)
+{
+        GtkTreeIter    iter;
+        glMergeRecord *record;
+
+        g_return_if_fail (model && GL_IS_MERGE_RECORD_MODEL (model));
+
+        if ( !get_iter (GTK_TREE_MODEL (model), &iter, path) || (ITER_FIELD (&iter) >= 0) )
+        {
+                return;
+        }
+
+        record = model->priv->records[ITER_RECORD (&iter)];
+        record->select_flag ^= 1;
+
+        gtk_tree_model_row_changed (GTK_TREE_MODEL (model), path, &iter);
+}
+
+
+/*****************************************************************************/
+/* Set select flag of all records.  No per-row "row-changed" signals are     */
+/* emitted for this, since only the check boxes change; views of the model  */
+/* just need to be redrawn.                                                  */
+/*****************************************************************************/
+void
+gl_merge_record_model_select_all (glMergeRecordModel *model,
+                                  gboolean            select_flag)
+{
+        gint i;
+
+        g_return_if_fail (model && GL_IS_MERGE_RECORD_MODEL (model));
+
+        for ( i = 0; i < model->priv->n_records; i++ )
+        {
+                model->priv->records[i]->select_flag = select_flag;
+        }
+}
+
+
+/*****************************************************************************/
+/* Select exactly the records passing filter.  As for                        */
+/* gl_merge_record_model_select_all(), views just need to be redrawn.        */
+/*****************************************************************************/
+void
+gl_merge_record_model_select_filtered (glMergeRecordModel  *model,
+                                       const glMergeFilter *filter)
+{
+        gint i;
+
+        g_return_if_fail (model && GL_IS_MERGE_RECORD_MODEL (model));
+        g_return_if_fail (filter != NULL);
+
+        for ( i = 0; i < model->priv->n_records; i++ )
+        {
+                model->priv->records[i]->select_flag =
+                        gl_merge_filter_eval (filter, model->priv->records[i]);
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Fields of a record, as an array.                               */
+/*--------------------------------------------------------------------------*/
+static GPtrArray *
+get_fields (glMergeRecordModel *model,
+            gint                i_record)
+{
+        GPtrArray *fields;
+        GList     *p;
+
+        fields = model->priv->fields[i_record];
+        if ( fields == NULL )
+        {
+                fields = g_ptr_array_new ();
+                for ( p = model->priv->records[i_record]->field_list; p != NULL; p = p->next )
+                {
+                        g_ptr_array_add (fields, p->data);
+                }
+                model->priv->fields[i_record] = fields;
+        }
+
+        return fields;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Fill in iter.  i_field is -1 for a record row.                 */
+/*--------------------------------------------------------------------------*/
+static void
+set_iter (glMergeRecordModel *model,
+          GtkTreeIter        *iter,
+          gint                i_record,
+          gint                i_field)
+{
+        iter->stamp      = model->priv->stamp;
+        iter->user_data  = GINT_TO_POINTER (i_record);
+        iter->user_data2 = GINT_TO_POINTER (i_field + 1);
+        iter->user_data3 = NULL;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  GtkTreeModel methods.                                          */
+/*--------------------------------------------------------------------------*/
+static GtkTreeModelFlags
+get_flags (GtkTreeModel *tree_model)
+{
+        return GTK_TREE_MODEL_ITERS_PERSIST;
+}
+
+
+static gint
+get_n_columns (GtkTreeModel *tree_model)
+{
+        return GL_MERGE_RECORD_MODEL_N_COLUMNS;
+}
+
+
+static GType
+get_column_type (GtkTreeModel *tree_model,
+                 gint          index)
+{
+        switch (index)
+        {
+        case GL_MERGE_RECORD_MODEL_SELECT_COLUMN:
+        case GL_MERGE_RECORD_MODEL_IS_RECORD_COLUMN:
+                return G_TYPE_BOOLEAN;
+        case GL_MERGE_RECORD_MODEL_RECORD_FIELD_COLUMN:
+        case GL_MERGE_RECORD_MODEL_VALUE_COLUMN:
+                return G_TYPE_STRING;
+        case GL_MERGE_RECORD_MODEL_DATA_COLUMN:
+                return G_TYPE_POINTER;
+        default:
+                return G_TYPE_INVALID;
+        }
+}
+
+
+static gboolean
+get_iter (GtkTreeModel *tree_model,
+          GtkTreeIter  *iter,
+          GtkTreePath  *path)
+{
+        glMergeRecordModel *model = GL_MERGE_RECORD_MODEL (tree_model);
+        gint                depth;
+        gint               *indices;
+
+        depth   = gtk_tree_path_get_depth (path);
+        indices = gtk_tree_path_get_indices (path);
+
+        if ( (depth < 1) || (depth > 2) ||
+             (indices[0] < 0) || (indices[0] >= model->priv->n_records) )
+        {
+                return FALSE;
+        }
+
+        if ( depth == 1 )
+        {
+                set_iter (model, iter, indices[0], -1);
+                return TRUE;
+        }
+
+        if ( (indices[1] < 0) || (indices[1] >= get_fields (model, indices[0])->len) )
+        {
+                return FALSE;
+        }
+
+        set_iter (model, iter, indices[0], indices[1]);
+        return TRUE;
+}
+
+
+static GtkTreePath *
+get_path (GtkTreeModel *tree_model,
+          GtkTreeIter  *iter)
+{
+        GtkTreePath *path;
+
+        g_return_val_if_fail (iter->stamp == GL_MERGE_RECORD_MODEL (tree_model)->priv->stamp, NULL);
+
+        path = gtk_tree_path_new ();
+        gtk_tree_path_append_index (path, ITER_RECORD (iter));
+        if ( ITER_FIELD (iter) >= 0 )
+        {
+                gtk_tree_path_append_index (path, ITER_FIELD (iter));
+        }
+
+        return path;
+}
+
+
+static void
+get_value (GtkTreeModel *tree_model,
+           GtkTreeIter  *iter,
+           gint          column,
+           GValue       *value)
+{
+        glMergeRecordModel *model = GL_MERGE_RECORD_MODEL (tree_model);
+        glMergeRecord      *record;
+        glMergeField       *field = NULL;
+
+        g_return_if_fail (iter->stamp == model->priv->stamp);
+
+        record = model->priv->records[ITER_RECORD (iter)];
+        if ( ITER_FIELD (iter) >= 0 )
+        {
+                field = g_ptr_array_index (get_fields (model, ITER_RECORD (iter)), ITER_FIELD (iter));
+        }
+
+        g_value_init (value, get_column_type (tree_model, column));
+
+        switch (column)
+        {
+        case GL_MERGE_RECORD_MODEL_SELECT_COLUMN:
+                g_value_set_boolean (value, (field == NULL) && record->select_flag);
+                break;
+        case GL_MERGE_RECORD_MODEL_RECORD_FIELD_COLUMN:
+                if ( field == NULL )
+                {
+                        g_value_take_string (value, gl_merge_eval_key (record, model->priv->primary_key));
+                }
+                else
+                {
+                        g_value_set_string (value, field->key);
+                }
+                break;
+        case GL_MERGE_RECORD_MODEL_VALUE_COLUMN:
+                g_value_set_string (value, (field != NULL) ? field->value : NULL);
+                break;
+        case GL_MERGE_RECORD_MODEL_IS_RECORD_COLUMN:
+                g_value_set_boolean (value, (field == NULL));
+                break;
+        case GL_MERGE_RECORD_MODEL_DATA_COLUMN:
+                g_value_set_pointer (value, (field == NULL) ? record : NULL);
+                break;
+        default:
+                g_assert_not_reached ();
+        }
+}
+
+
+static gboolean
+iter_next (GtkTreeModel *tree_model,
+           GtkTreeIter  *iter)
+{
+        glMergeRecordModel *model = GL_MERGE_RECORD_MODEL (tree_model);
+        gint                i_record = ITER_RECORD (iter);
+        gint                i_field  = ITER_FIELD (iter);
+
+        if ( i_field < 0 )
+        {
+                if ( i_record + 1 < model->priv->n_records )
+                {
+                        set_iter (model, iter, i_record + 1, -1);
+                        return TRUE;
+                }
+        }
+        else
+        {
+                if ( i_field + 1 < get_fields (model, i_record)->len )
+                {
+                        set_iter (model, iter, i_record, i_field + 1);
+                        return TRUE;
+                }
+        }
+
+        iter->stamp = 0;
+        return FALSE;
+}
+
+
+static gboolean
+iter_children (GtkTreeModel *tree_model,
+               GtkTreeIter  *iter,
+               GtkTreeIter  *parent)
+{
+        return iter_nth_child (tree_model, iter, parent, 0);
+}
+
+
+static gboolean
+iter_has_child (GtkTreeModel *tree_model,
+                GtkTreeIter  *iter)
+{
+        glMergeRecordModel *model = GL_MERGE_RECORD_MODEL (tree_model);
+
+        /* Answered from the record itself, without building its field array. */
+        return (ITER_FIELD (iter) < 0) &&
+                (model->priv->records[ITER_RECORD (iter)]->field_list != NULL);
+}
+
+
+static gint
+iter_n_children (GtkTreeModel *tree_model,
+                 GtkTreeIter  *iter)
+{
+        glMergeRecordModel *model = GL_MERGE_RECORD_MODEL (tree_model);
+
+        if ( iter == NULL )
+        {
+                return model->priv->n_records;
+        }
+        if ( ITER_FIELD (iter) < 0 )
+        {
+                return get_fields (model, ITER_RECORD (iter))->len;
+        }
+
+        return 0;
+}
+
+
+static gboolean
+iter_nth_child (GtkTreeModel *tree_model,
+                GtkTreeIter  *iter,
+                GtkTreeIter  *parent,
+                gint          n)
+{
+        glMergeRecordModel *model = GL_MERGE_RECORD_MODEL (tree_model);
+
+        if ( parent == NULL )
+        {
+                if ( (n >= 0) && (n < model->priv->n_records) )
+                {
+                        set_iter (model, iter, n, -1);
+                        return TRUE;
+                }
+        }
+        else if ( ITER_FIELD (parent) < 0 )
+        {
+                if ( (n >= 0) && (n < get_fields (model, ITER_RECORD (parent))->len) )
+                {
+                        set_iter (model, iter, ITER_RECORD (parent), n);
+                        return TRUE;
+                }
+        }
+
+        iter->stamp = 0;
+        return FALSE;
+}
+
+
+static gboolean
+iter_parent (GtkTreeModel *tree_model,
+             GtkTreeIter  *iter,
+             GtkTreeIter  *child)
+{
+        glMergeRecordModel *model = GL_MERGE_RECORD_MODEL (tree_model);
+
+        if ( ITER_FIELD (child) >= 0 )
+        {
+                set_iter (model, iter, ITER_RECORD (child), -1);
+                return TRUE;
+        }
+
+        iter->stamp = 0;
+        return FALSE;
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
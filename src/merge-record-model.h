@@ -0,0 +1,104 @@
+/*
+ *  merge-record-model.h
+ *  Copyright (C) 2001-2009  Jim Evins <evins@snaught.com>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MERGE_RECORD_MODEL_H__
+#define __MERGE_RECORD_MODEL_H__
+
+#include <gtk/gtk.h>
+
+#include "merge.h"
+#include "merge-filter.h"
+
+G_BEGIN_DECLS
+
+#define GL_TYPE_MERGE_RECORD_MODEL            (gl_merge_record_model_get_type ())
+#define GL_MERGE_RECORD_MODEL(obj) \
+        (G_TYPE_CHECK_INSTANCE_CAST ((obj), GL_TYPE_MERGE_RECORD_MODEL, glMergeRecordModel))
+#define GL_MERGE_RECORD_MODEL_CLASS(klass) \
+        (G_TYPE_CHECK_CLASS_CAST ((klass), GL_TYPE_MERGE_RECORD_MODEL, glMergeRecordModelClass))
+#define GL_IS_MERGE_RECORD_MODEL(obj) \
+        (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GL_TYPE_MERGE_RECORD_MODEL))
+#define GL_IS_MERGE_RECORD_MODEL_CLASS(klass) \
+        (G_TYPE_CHECK_CLASS_TYPE ((klass), GL_TYPE_MERGE_RECORD_MODEL))
+#define GL_MERGE_RECORD_MODEL_GET_CLASS(obj) \
+        (G_TYPE_INSTANCE_GET_CLASS ((obj), GL_TYPE_MERGE_RECORD_MODEL, glMergeRecordModelClass))
+
+
+typedef struct _glMergeRecordModel          glMergeRecordModel;
+typedef struct _glMergeRecordModelClass     glMergeRecordModelClass;
+
+typedef struct _glMergeRecordModelPrivate   glMergeRecordModelPrivate;
+
+
+struct _glMergeRecordModel {
+        GObject                     parent_instance;
+
+        glMergeRecordModelPrivate  *priv;
+};
+
+struct _glMergeRecordModelClass {
+        GObjectClass                parent_class;
+};
+
+
+/*
+ * Top level rows are the records of a merge, their children are the fields
+ * of each record.  Rows are produced on demand from the merge's record list;
+ * the model itself holds one pointer per record.
+ */
+enum {
+        GL_MERGE_RECORD_MODEL_SELECT_COLUMN,       /* gboolean, record rows only */
+        GL_MERGE_RECORD_MODEL_RECORD_FIELD_COLUMN, /* primary value or field key */
+        GL_MERGE_RECORD_MODEL_VALUE_COLUMN,        /* field value */
+        GL_MERGE_RECORD_MODEL_IS_RECORD_COLUMN,    /* gboolean */
+        GL_MERGE_RECORD_MODEL_DATA_COLUMN,         /* glMergeRecord * */
+
+        GL_MERGE_RECORD_MODEL_N_COLUMNS
+};
+
+
+GType               gl_merge_record_model_get_type     (void) G_GNUC_CONST;
+
+glMergeRecordModel *gl_merge_record_model_new          (glMerge            *merge);
+
+void                gl_merge_record_model_toggle       (glMergeRecordModel *model,
+                                                        GtkTreePath        *path);
+
+void                gl_merge_record_model_select_all   (glMergeRecordModel *model,
+                                                        gboolean            select_flag);
+
+void                gl_merge_record_model_select_filtered (glMergeRecordModel  *model,
+                                                        const glMergeFilter *filter);
+
+G_END_DECLS
+
+#endif
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
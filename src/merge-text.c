@@ -22,7 +22,10 @@
 
 #include "merge-text.h"
 
+#include <gio/gio.h>
+#include <glib/gstdio.h>
 #include <stdio.h>
+#include <unistd.h>
 #include <errno.h>
 #include <string.h>
 
@@ -30,6 +33,29 @@
 
 #define LINE_BUF_LEN 1024
 
+/*
+ * Row-offset index.
+ *  While a large regular file is read front to back, the offset of each
+ * record is collected.  On EOF the offsets are saved to the user's cache
+ * directory, stamped with the size and mtime (in microseconds) of the source,
+ * so that a later open of the same unchanged file can count records and seek
+ * to any one of them without tokenizing the file.  The index file is the
+ * header below followed by one native gint64 offset per record, and is memory
+ * mapped when loaded.  Smaller files are quicker to read than to index.
+ */
+#define INDEX_MAGIC        "glmidx2"
+#define INDEX_BYTE_ORDER   0x01020304
+#define INDEX_MIN_SRC_SIZE (1024*1024)
+
+typedef struct {
+        gchar    magic[8];
+        guint32  byte_order;
+        gint32   n_fields_max;
+        gint64   src_size;
+        gint64   src_mtime;
+        gint64   n_records;
+} IndexHeader;
+
 /*
  * Unicode handling.
  *  The default encoding assumption is that files are in the system encoding.
@@ -64,6 +90,19 @@ struct _glMergeTextPrivate {
 
         GPtrArray        *keys;
         gint              n_fields_max;
+
+        /* Row-offset index, see above. */
+        gchar            *index_src;
+        gint64            index_src_size;
+        gint64            index_src_mtime;
+        gint              index_n_fields_max;
+        GMappedFile      *index_file;
+        GArray           *index_array;
+        const gint64     *offsets;
+        gint              n_offsets;
+        gboolean          index_complete;
+        gboolean          indexing;
+        gboolean          seeking;
 };
 
 enum {
@@ -109,6 +148,21 @@ static void           gl_merge_text_close           (glMerge          *merge);
 static glMergeRecord *gl_merge_text_get_record      (glMerge          *merge);
 static void           gl_merge_text_copy            (glMerge          *dst_merge,
                                                      const glMerge    *src_merge);
+static gint           gl_merge_text_get_src_record_count (glMerge     *merge);
+static glMergeRecord *gl_merge_text_get_src_record  (glMerge          *merge,
+                                                     gint              i_record);
+
+static gboolean       stat_src                      (const gchar      *src,
+                                                     gint64           *size,
+                                                     gint64           *mtime);
+static gchar         *index_filename                (glMergeText      *merge_text,
+                                                     const gchar      *src);
+static void           clear_index                   (glMergeText      *merge_text);
+static gboolean       load_index                    (glMergeText      *merge_text,
+                                                     const gchar      *src);
+static void           start_index                   (glMergeText      *merge_text,
+                                                     const gchar      *src);
+static void           save_index                    (glMergeText      *merge_text);
 
 static GList         *parse_line                    (glMergeText       *merge_text,
                                                      gchar             delim);
@@ -158,6 +212,9 @@ gl_merge_text_class_init (glMergeTextClass *class)
         merge_class->get_record      = gl_merge_text_get_record;
         merge_class->copy            = gl_merge_text_copy;
 
+        merge_class->get_src_record_count = gl_merge_text_get_src_record_count;
+        merge_class->get_src_record       = gl_merge_text_get_src_record;
+
         gl_debug (DEBUG_MERGE, "END");
 }
 
@@ -184,8 +241,10 @@ gl_merge_text_finalize (GObject *object)
 
         g_return_if_fail (object && GL_IS_MERGE_TEXT (object));
 
+        gl_merge_text_close (GL_MERGE (merge_text));
         clear_keys (merge_text);
         g_ptr_array_free (merge_text->priv->keys, TRUE);
+        clear_index (merge_text);
         g_free (merge_text->priv);
 
         G_OBJECT_CLASS (gl_merge_text_parent_class)->finalize (object);
@@ -490,6 +549,11 @@ gl_merge_text_open (glMerge *merge)
 
         merge_text = GL_MERGE_TEXT (merge);
 
+        /* Left open by gl_merge_text_get_src_record(). */
+        if (merge_text->priv->seeking) {
+                gl_merge_text_close (merge);
+        }
+
         src = gl_merge_get_src (merge);
 
         if (src != NULL)
@@ -505,7 +569,6 @@ gl_merge_text_open (glMerge *merge)
                                         strerror(errno), src);
                         }
                 }
-                g_free (src);
 
                 gchar* in_codeset = NULL;
                 switch (merge_text->priv->encoding) {
@@ -547,6 +610,24 @@ gl_merge_text_open (glMerge *merge)
                         free_fields (&line1_fields);
                 }
 
+                /*
+                 * Use existing index of source, or collect a new one while
+                 * the records are read.
+                 */
+                merge_text->priv->indexing = FALSE;
+                if ( (merge_text->priv->fp != NULL) && (merge_text->priv->fp != stdin) )
+                {
+                        if ( load_index (merge_text, src) )
+                        {
+                                merge_text->priv->n_fields_max = merge_text->priv->index_n_fields_max;
+                        }
+                        else
+                        {
+                                start_index (merge_text, src);
+                        }
+                }
+
+                g_free (src);
         }
 
 
@@ -573,6 +654,14 @@ gl_merge_text_close (glMerge *merge)
                 g_iconv_close(merge_text->priv->g_iconverter);
                 merge_text->priv->g_iconverter = 0;
         }
+        merge_text->priv->buf_pos = 0;
+        merge_text->priv->buf_len = 0;
+        merge_text->priv->seeking = FALSE;
+
+        /* Closed before EOF, any index collected so far is incomplete. */
+        if (merge_text->priv->indexing) {
+                clear_index (merge_text);
+        }
 }
 
 
@@ -588,16 +677,39 @@ gl_merge_text_get_record (glMerge *merge)
         GList         *fields, *p;
         gint           i_field;
         glMergeField  *field;
+        gint64         offset = 0;
 
         merge_text = GL_MERGE_TEXT (merge);
 
         delim = merge_text->priv->delim;
 
+        if ( merge_text->priv->indexing )
+        {
+                /* Only possible on record boundaries not inside a decoded character. */
+                if ( merge_text->priv->buf_pos < merge_text->priv->buf_len )
+                {
+                        clear_index (merge_text);
+                }
+                else
+                {
+                        offset = ftell (merge_text->priv->fp);
+                }
+        }
+
         fields = parse_line (merge_text, delim);
         if ( fields == NULL ) {
+                if ( merge_text->priv->indexing )
+                {
+                        save_index (merge_text);
+                }
                 return NULL;
         }
 
+        if ( merge_text->priv->indexing )
+        {
+                g_array_append_val (merge_text->priv->index_array, offset);
+        }
+
         record = g_new0 (glMergeRecord, 1);
         record->select_flag = TRUE;
         for (p=fields, i_field=0; p != NULL; p=p->next, i_field++) {
@@ -654,6 +766,352 @@ gl_merge_text_copy (glMerge       *dst_merge,
 }
 
 
+/*--------------------------------------------------------------------------*/
+/* Get number of records in source from its index, -1 if not indexed.      */
+/*--------------------------------------------------------------------------*/
+static gint
+gl_merge_text_get_src_record_count (glMerge *merge)
+{
+        glMergeText *merge_text;
+        gchar       *src;
+        gint         n = -1;
+
+        merge_text = GL_MERGE_TEXT (merge);
+
+        src = gl_merge_get_src (merge);
+        if ( (src != NULL) && load_index (merge_text, src) )
+        {
+                n = merge_text->priv->n_offsets;
+        }
+        g_free (src);
+
+        return n;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* Read one record by seeking to its indexed offset.  The source is left    */
+/* open for the next call, until it is next opened or closed for reading.   */
+/*--------------------------------------------------------------------------*/
+static glMergeRecord *
+gl_merge_text_get_src_record (glMerge *merge,
+                              gint     i_record)
+{
+        glMergeText   *merge_text;
+        glMergeRecord *record = NULL;
+
+        merge_text = GL_MERGE_TEXT (merge);
+
+        g_return_val_if_fail ((merge_text->priv->fp == NULL) || merge_text->priv->seeking, NULL);
+
+        if ( !merge_text->priv->seeking )
+        {
+                if ( gl_merge_text_get_src_record_count (merge) < 0 )
+                {
+                        return NULL;
+                }
+
+                gl_merge_text_open (merge);
+                if ( (merge_text->priv->fp == NULL) || !merge_text->priv->index_complete )
+                {
+                        gl_merge_text_close (merge);
+                        return NULL;
+                }
+                merge_text->priv->seeking = TRUE;
+        }
+
+        if ( (i_record >= 0) && (i_record < merge_text->priv->n_offsets) &&
+             (fseek (merge_text->priv->fp, merge_text->priv->offsets[i_record], SEEK_SET) == 0) )
+        {
+                merge_text->priv->buf_pos = 0;
+                merge_text->priv->buf_len = 0;
+
+                record = gl_merge_text_get_record (merge);
+        }
+
+        return record;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get size and modification time of a regular source file.       */
+/*---------------------------------------------------------------------------*/
+static gboolean
+stat_src (const gchar *src,
+          gint64      *size,
+          gint64      *mtime)
+{
+        GFile     *file;
+        GFileInfo *info;
+        gboolean   ok = FALSE;
+
+        file = g_file_new_for_path (src);
+        info = g_file_query_info (file,
+                                  G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                                  G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                  G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                                  G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                                  G_FILE_QUERY_INFO_NONE, NULL, NULL);
+
+        /* Whole seconds would miss a rewrite in the second the index was made. */
+        if ( (info != NULL) &&
+             (g_file_info_get_file_type (info) == G_FILE_TYPE_REGULAR) &&
+             g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC) )
+        {
+                *size  = g_file_info_get_size (info);
+                *mtime = (gint64)g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC
+                        + g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+                ok = TRUE;
+        }
+
+        if ( info != NULL )
+        {
+                g_object_unref (info);
+        }
+        g_object_unref (file);
+
+        return ok;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Index file name.  Record offsets depend on how the source is   */
+/* parsed, so the parse options are part of the name along with the path.  */
+/*---------------------------------------------------------------------------*/
+static gchar *
+index_filename (glMergeText *merge_text,
+                const gchar *src)
+{
+        gchar *abs_src;
+        gchar *id;
+        gchar *checksum;
+        gchar *basename;
+        gchar *filename;
+
+        if ( g_path_is_absolute (src) )
+        {
+                abs_src = g_strdup (src);
+        }
+        else
+        {
+                gchar *dir = g_get_current_dir ();
+                abs_src = g_build_filename (dir, src, NULL);
+                g_free (dir);
+        }
+
+        id = g_strdup_printf ("%s|%d|%d", abs_src,
+                              merge_text->priv->delim,
+                              merge_text->priv->line1_has_keys);
+        checksum = g_compute_checksum_for_string (G_CHECKSUM_MD5, id, -1);
+        basename = g_strdup_printf ("%s.idx", checksum);
+
+        filename = g_build_filename (g_get_user_cache_dir (), "glabels", "merge-index",
+                                     basename, NULL);
+
+        g_free (abs_src);
+        g_free (id);
+        g_free (checksum);
+        g_free (basename);
+
+        return filename;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Drop current index.                                             */
+/*---------------------------------------------------------------------------*/
+static void
+clear_index (glMergeText *merge_text)
+{
+        glMergeTextPrivate *priv = merge_text->priv;
+
+        if ( priv->index_file != NULL )
+        {
+                g_mapped_file_unref (priv->index_file);
+                priv->index_file = NULL;
+        }
+        if ( priv->index_array != NULL )
+        {
+                g_array_free (priv->index_array, TRUE);
+                priv->index_array = NULL;
+        }
+        g_free (priv->index_src);
+        priv->index_src = NULL;
+
+        priv->offsets        = NULL;
+        priv->n_offsets      = 0;
+        priv->index_complete = FALSE;
+        priv->indexing       = FALSE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Make sure a complete index of an unchanged src is at hand,     */
+/* from memory or from the cache directory.  Returns FALSE if there is none.*/
+/*---------------------------------------------------------------------------*/
+static gboolean
+load_index (glMergeText *merge_text,
+            const gchar *src)
+{
+        glMergeTextPrivate *priv = merge_text->priv;
+        gint64              size, mtime;
+        gchar              *filename;
+        GMappedFile        *file;
+        const IndexHeader  *header;
+        gsize               length;
+
+        if ( !stat_src (src, &size, &mtime) || (size < INDEX_MIN_SRC_SIZE) )
+        {
+                return FALSE;
+        }
+
+        if ( priv->index_complete && (g_strcmp0 (priv->index_src, src) == 0) &&
+             (priv->index_src_size == size) && (priv->index_src_mtime == mtime) )
+        {
+                return TRUE;
+        }
+
+        if ( priv->indexing )
+        {
+                /* A sequential read is collecting the index right now. */
+                return FALSE;
+        }
+
+        clear_index (merge_text);
+
+        filename = index_filename (merge_text, src);
+        file = g_mapped_file_new (filename, FALSE, NULL);
+        g_free (filename);
+
+        if ( file == NULL )
+        {
+                return FALSE;
+        }
+
+        header = (const IndexHeader *)g_mapped_file_get_contents (file);
+        length = g_mapped_file_get_length (file);
+
+        if ( (length < sizeof (IndexHeader)) ||
+             (memcmp (header->magic, INDEX_MAGIC, sizeof (header->magic)) != 0) ||
+             (header->byte_order != INDEX_BYTE_ORDER) ||
+             (header->src_size != size) || (header->src_mtime != mtime) ||
+             (header->n_records < 0) || (header->n_records > G_MAXINT) ||
+             (length != sizeof (IndexHeader) + header->n_records * sizeof (gint64)) )
+        {
+                gl_debug (DEBUG_MERGE, "Stale or invalid index for %s", src);
+                g_mapped_file_unref (file);
+                return FALSE;
+        }
+
+        priv->index_file         = file;
+        priv->index_src          = g_strdup (src);
+        priv->index_src_size     = size;
+        priv->index_src_mtime    = mtime;
+        priv->index_n_fields_max = header->n_fields_max;
+        priv->offsets            = (const gint64 *)(header + 1);
+        priv->n_offsets          = header->n_records;
+        priv->index_complete     = TRUE;
+
+        return TRUE;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Start collecting a new index of src.                            */
+/*---------------------------------------------------------------------------*/
+static void
+start_index (glMergeText *merge_text,
+             const gchar *src)
+{
+        glMergeTextPrivate *priv = merge_text->priv;
+
+        clear_index (merge_text);
+
+        if ( stat_src (src, &priv->index_src_size, &priv->index_src_mtime) &&
+             (priv->index_src_size >= INDEX_MIN_SRC_SIZE) )
+        {
+                priv->index_src   = g_strdup (src);
+                priv->index_array = g_array_new (FALSE, FALSE, sizeof (gint64));
+                priv->indexing    = TRUE;
+        }
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Collected index is complete, keep it and write it to the cache.*/
+/* Only reached when no valid index was found on open, so an index is      */
+/* written once per change of the source.  Written to a temporary file and  */
+/* renamed, so readers never see a partial index.  Failure to write is not  */
+/* an error, the source just stays slow.                                    */
+/*---------------------------------------------------------------------------*/
+static void
+save_index (glMergeText *merge_text)
+{
+        glMergeTextPrivate *priv = merge_text->priv;
+        IndexHeader         header;
+        gchar              *filename;
+        gchar              *dirname;
+        gchar              *tmp_filename;
+        gint64              size, mtime;
+        gint                fd;
+        FILE               *fp;
+        gboolean            ok;
+
+        /* Offsets collected from a file that changed while it was read are useless. */
+        if ( !stat_src (priv->index_src, &size, &mtime) ||
+             (size != priv->index_src_size) || (mtime != priv->index_src_mtime) )
+        {
+                gl_debug (DEBUG_MERGE, "%s changed while indexing", priv->index_src);
+                clear_index (merge_text);
+                return;
+        }
+
+        priv->indexing       = FALSE;
+        priv->index_complete = TRUE;
+        priv->offsets        = (const gint64 *)priv->index_array->data;
+        priv->n_offsets      = priv->index_array->len;
+
+        memset (&header, 0, sizeof (header));
+        memcpy (header.magic, INDEX_MAGIC, sizeof (header.magic));
+        header.byte_order   = INDEX_BYTE_ORDER;
+        header.n_fields_max = priv->n_fields_max;
+        header.src_size     = priv->index_src_size;
+        header.src_mtime    = priv->index_src_mtime;
+        header.n_records    = priv->n_offsets;
+
+        priv->index_n_fields_max = priv->n_fields_max;
+
+        filename = index_filename (merge_text, priv->index_src);
+        dirname  = g_path_get_dirname (filename);
+        tmp_filename = g_strdup_printf ("%s.XXXXXX", filename);
+
+        if ( (g_mkdir_with_parents (dirname, 0700) == 0) &&
+             ((fd = g_mkstemp (tmp_filename)) != -1) )
+        {
+                if ( (fp = fdopen (fd, "wb")) != NULL )
+                {
+                        ok = (fwrite (&header, sizeof (header), 1, fp) == 1);
+                        ok = ok && (fwrite (priv->offsets, sizeof (gint64), priv->n_offsets, fp) == priv->n_offsets);
+                        ok = (fclose (fp) == 0) && ok;
+                }
+                else
+                {
+                        close (fd);
+                        ok = FALSE;
+                }
+
+                if ( !ok || (g_rename (tmp_filename, filename) != 0) )
+                {
+                        g_unlink (tmp_filename);
+                }
+        }
+
+        g_free (filename);
+        g_free (dirname);
+        g_free (tmp_filename);
+}
+
+
 /*---------------------------------------------------------------------------*/
 /* PRIVATE.  Parse line.                                                     */
 /*                                                                           */
@@ -28,6 +28,8 @@
 
 #include <libglabels.h>
 
+#include "merge-filter.h"
+
 #include "debug.h"
 
 /*========================================================*/
@@ -41,6 +43,9 @@ struct _glMergePrivate {
 	glMergeSrcType     src_type;
 
 	GList             *record_list;
+	gboolean           records_pending;  /* Indexed src not read yet */
+
+	glMergeFilter     *filter;
 };
 
 enum {
@@ -75,6 +80,8 @@ static void           merge_open             (glMerge              *merge);
 
 static void           merge_close            (glMerge              *merge);
 
+static void           merge_read_records     (glMerge              *merge);
+
 static glMergeRecord *merge_get_record       (glMerge              *merge);
 
 static void           merge_free_record      (glMergeRecord       **record);
@@ -262,6 +269,7 @@ gl_merge_finalize (GObject *object)
 	g_return_if_fail (object && GL_IS_MERGE (object));
 
 	merge_free_record_list (&merge->priv->record_list);
+	gl_merge_filter_free (merge->priv->filter);
 	g_free (merge->priv->name);
 	g_free (merge->priv->description);
 	g_free (merge->priv->src);
@@ -334,6 +342,12 @@ gl_merge_dup (const glMerge *src_merge)
 	dst_merge->priv->src_type    = src_merge->priv->src_type;
 	dst_merge->priv->record_list 
 		= merge_dup_record_list (src_merge->priv->record_list);
+	dst_merge->priv->records_pending = src_merge->priv->records_pending;
+	if ( src_merge->priv->filter != NULL ) {
+		dst_merge->priv->filter =
+			gl_merge_filter_new (gl_merge_filter_get_expression (src_merge->priv->filter),
+					     NULL);
+	}
 
 	if ( GL_MERGE_GET_CLASS(src_merge)->copy != NULL ) {
 
@@ -399,15 +413,13 @@ gl_merge_get_src_type (const glMerge *merge)
 }
 
 /*****************************************************************************/
-/* Set src of merge.                                                         */
+/* Set src of merge.  Records are read now, unless the backend has an index  */
+/* of src, in which case they are read when first needed.                    */
 /*****************************************************************************/
 void
 gl_merge_set_src (glMerge       *merge,
 		  const gchar   *src)
 {
-	GList         *record_list = NULL;
-	glMergeRecord *record;
-
 	gl_debug (DEBUG_MERGE, "START");
 
 	if (merge == NULL)
@@ -427,6 +439,7 @@ gl_merge_set_src (glMerge       *merge,
 		}
 		merge->priv->src = NULL;
 		merge_free_record_list (&merge->priv->record_list);
+		merge->priv->records_pending = FALSE;
 
 	}
 	else
@@ -439,14 +452,19 @@ gl_merge_set_src (glMerge       *merge,
 		merge->priv->src = g_strdup (src);
 
 		merge_free_record_list (&merge->priv->record_list);
-			
-		merge_open (merge);
-		while ( (record = merge_get_record (merge)) != NULL )
+
+		if ( (merge->priv->filter == NULL) &&
+		     (gl_merge_get_src_record_count (merge) >= 0) )
+		{
+			/* Only the keys are read for now. */
+			merge_open (merge);
+			merge_close (merge);
+			merge->priv->records_pending = TRUE;
+		}
+		else
 		{
-			record_list = g_list_append( record_list, record );
+			merge_read_records (merge);
 		}
-		merge_close (merge);
-		merge->priv->record_list = record_list;
 
 	}
 		     
@@ -471,6 +489,56 @@ gl_merge_get_src (const glMerge *merge)
 	return g_strdup(merge->priv->src);
 }
 
+/*****************************************************************************/
+/* Set record filter expression of merge, see merge-filter.h.  Only records */
+/* passing the filter are kept when the source is next read.  A NULL or     */
+/* empty expression removes the filter.  Returns FALSE and leaves the       */
+/* filter unchanged if the expression is invalid.                           */
+/*****************************************************************************/
+gboolean
+gl_merge_set_filter (glMerge      *merge,
+		     const gchar  *expression,
+		     GError      **error)
+{
+	glMergeFilter *filter = NULL;
+
+	gl_debug (DEBUG_MERGE, "START");
+
+	g_return_val_if_fail (merge && GL_IS_MERGE (merge), FALSE);
+
+	if ( (expression != NULL) && (*expression != '\0') )
+	{
+		filter = gl_merge_filter_new (expression, error);
+		if ( filter == NULL )
+		{
+			gl_debug (DEBUG_MERGE, "END (invalid)");
+			return FALSE;
+		}
+	}
+
+	gl_merge_filter_free (merge->priv->filter);
+	merge->priv->filter = filter;
+
+	gl_debug (DEBUG_MERGE, "END");
+
+	return TRUE;
+}
+
+/*****************************************************************************/
+/* Get record filter expression of merge, NULL if none.                      */
+/*****************************************************************************/
+gchar *
+gl_merge_get_filter (const glMerge *merge)
+{
+	gl_debug (DEBUG_MERGE, "");
+
+	if ( (merge == NULL) || (merge->priv->filter == NULL) ) {
+		return NULL;
+	}
+
+	return g_strdup (gl_merge_filter_get_expression (merge->priv->filter));
+}
+
 /*****************************************************************************/
 /* Get Key List.                                                             */
 /*****************************************************************************/
@@ -584,6 +652,40 @@ merge_close (glMerge *merge)
 	gl_debug (DEBUG_MERGE, "END");
 }
 
+/*---------------------------------------------------------------------------*/
+/* Read all records from merge source into record list.                      */
+/*---------------------------------------------------------------------------*/
+static void
+merge_read_records (glMerge *merge)
+{
+	GList         *record_list = NULL;
+	glMergeRecord *record;
+
+	gl_debug (DEBUG_MERGE, "START");
+
+	merge_open (merge);
+	while ( (record = merge_get_record (merge)) != NULL )
+	{
+		gl_stats_inc (GL_STATS_RECORDS_PARSED);
+
+		/* Records failing the filter are dropped as they are read. */
+		if ( (merge->priv->filter != NULL) &&
+		     !gl_merge_filter_eval (merge->priv->filter, record) )
+		{
+			merge_free_record (&record);
+			continue;
+		}
+
+		record_list = g_list_prepend( record_list, record );
+	}
+	merge_close (merge);
+
+	merge->priv->record_list     = g_list_reverse (record_list);
+	merge->priv->records_pending = FALSE;
+
+	gl_debug (DEBUG_MERGE, "END");
+}
+
 /*---------------------------------------------------------------------------*/
 /* Get next record (list of fields) from opened merge source.                */
 /*---------------------------------------------------------------------------*/
@@ -711,6 +813,10 @@ gl_merge_get_record_list (const glMerge *merge)
 	gl_debug (DEBUG_MERGE, "");
 	      
 	if ( merge != NULL ) {
+		if ( merge->priv->records_pending ) {
+			/* Reading records does not change what the merge is. */
+			merge_read_records ((glMerge *)merge);
+		}
 		return merge->priv->record_list;
 	} else {
 		return NULL;
@@ -756,8 +862,9 @@ merge_dup_record_list (GList *record_list)
 		record = (glMergeRecord *) p->data;
 
 		dest_record = merge_dup_record( record );
-		dest_list = g_list_append (dest_list, dest_record);
+		dest_list = g_list_prepend (dest_list, dest_record);
 	}
+	dest_list = g_list_reverse (dest_list);
 
 
 	gl_debug (DEBUG_MERGE, "END");
@@ -766,7 +873,8 @@ merge_dup_record_list (GList *record_list)
 }
 
 /*****************************************************************************/
-/* Count selected records.                                                   */
+/* Count selected records.  Records not read yet are all selected, and are   */
+/* counted from the index of the source if it is still valid.                */
 /*****************************************************************************/
 gint
 gl_merge_get_record_count (const glMerge *merge)
@@ -777,6 +885,18 @@ gl_merge_get_record_count (const glMerge *merge)
 
 	gl_debug (DEBUG_MERGE, "START");
 
+	if ( merge->priv->records_pending ) {
+
+		count = gl_merge_get_src_record_count ((glMerge *)merge);
+		if ( count >= 0 ) {
+			gl_debug (DEBUG_MERGE, "END (indexed) count=%d", count);
+			return count;
+		}
+
+		/* Source changed since it was set, read it after all. */
+		merge_read_records ((glMerge *)merge);
+	}
+
 	count = 0;
 	for ( p=merge->priv->record_list; p!=NULL; p=p->next ) {
 		record = (glMergeRecord *)p->data;
@@ -789,6 +909,81 @@ gl_merge_get_record_count (const glMerge *merge)
 	return count;
 }
 
+/*****************************************************************************/
+/* Have the records of merge been read into its record list?  If not, they  */
+/* can only be read with gl_merge_get_src_record(), or all at once by        */
+/* gl_merge_get_record_list().                                               */
+/*****************************************************************************/
+gboolean
+gl_merge_has_record_list (const glMerge *merge)
+{
+	gl_debug (DEBUG_MERGE, "");
+
+	g_return_val_if_fail (merge && GL_IS_MERGE (merge), TRUE);
+
+	return !merge->priv->records_pending;
+}
+
+/*****************************************************************************/
+/* Count records in merge source, without reading them.  Only possible for  */
+/* backends that keep an index of their source; returns -1 otherwise.       */
+/*****************************************************************************/
+gint
+gl_merge_get_src_record_count (glMerge *merge)
+{
+	gint n = -1;
+
+	gl_debug (DEBUG_MERGE, "START");
+
+	g_return_val_if_fail (merge && GL_IS_MERGE (merge), -1);
+
+	if ( (merge->priv->src != NULL) &&
+	     (GL_MERGE_GET_CLASS(merge)->get_src_record_count != NULL) ) {
+
+		n = GL_MERGE_GET_CLASS(merge)->get_src_record_count (merge);
+
+	}
+
+	gl_debug (DEBUG_MERGE, "END n=%d", n);
+
+	return n;
+}
+
+/*****************************************************************************/
+/* Read one record (0-based) directly from merge source.  Returns NULL if   */
+/* the backend cannot seek to it.  Free with gl_merge_free_record().        */
+/*****************************************************************************/
+glMergeRecord *
+gl_merge_get_src_record (glMerge *merge,
+			 gint     i_record)
+{
+	glMergeRecord *record = NULL;
+
+	gl_debug (DEBUG_MERGE, "START");
+
+	g_return_val_if_fail (merge && GL_IS_MERGE (merge), NULL);
+
+	if ( (merge->priv->src != NULL) &&
+	     (GL_MERGE_GET_CLASS(merge)->get_src_record != NULL) ) {
+
+		record = GL_MERGE_GET_CLASS(merge)->get_src_record (merge, i_record);
+
+	}
+
+	gl_debug (DEBUG_MERGE, "END");
+
+	return record;
+}
+
+/*****************************************************************************/
+/* Free a record returned by gl_merge_get_src_record().                      */
+/*****************************************************************************/
+void
+gl_merge_free_record (glMergeRecord **record)
+{
+	merge_free_record (record);
+}
+
 
 
 /*
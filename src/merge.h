@@ -76,6 +76,12 @@ struct _glMergeClass {
 
 	void           (*copy)            (glMerge       *dst_merge,
 					   const glMerge *src_merge);
+
+	/* Optional random access to the source, for indexed backends. */
+	gint           (*get_src_record_count) (glMerge  *merge);
+
+	glMergeRecord *(*get_src_record)  (glMerge       *merge,
+					   gint           i_record);
 };
 
 
@@ -109,6 +115,12 @@ void              gl_merge_set_src             (glMerge             *merge,
 
 gchar            *gl_merge_get_src             (const glMerge       *merge);
 
+gboolean          gl_merge_set_filter          (glMerge             *merge,
+						const gchar         *expression,
+						GError             **error);
+
+gchar            *gl_merge_get_filter          (const glMerge       *merge);
+
 GList            *gl_merge_get_key_list        (const glMerge       *merge);
 
 void              gl_merge_free_key_list       (GList              **keys);
@@ -122,6 +134,15 @@ const GList      *gl_merge_get_record_list     (const glMerge       *merge);
 
 gint              gl_merge_get_record_count    (const glMerge       *merge);
 
+gboolean          gl_merge_has_record_list     (const glMerge       *merge);
+
+gint              gl_merge_get_src_record_count (glMerge            *merge);
+
+glMergeRecord    *gl_merge_get_src_record      (glMerge             *merge,
+						gint                 i_record);
+
+void              gl_merge_free_record         (glMergeRecord      **record);
+
 G_END_DECLS
 
 #endif
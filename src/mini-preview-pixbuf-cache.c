@@ -29,6 +29,13 @@
 
 #include "debug.h"
 
+/*========================================================*/
+/* Private macros and constants.                          */
+/*========================================================*/
+
+/* Number of thumbnails rendered per idle callback while warming. */
+#define WARM_CHUNK_SIZE 16
+
 /*========================================================*/
 /* Private types.                                         */
 /*========================================================*/
@@ -39,10 +46,15 @@
 
 static GHashTable *mini_preview_pixbuf_cache = NULL;
 
+static GList      *warm_names = NULL;
+static GList      *warm_next  = NULL;
+
 /*========================================================*/
 /* Private function prototypes.                           */
 /*========================================================*/
 
+static gboolean warm_idle_cb (gpointer data);
+
 
 /*****************************************************************************/
 /* Create a new hash table to keep track of cached mini preview pixbufs.     */
@@ -50,26 +62,34 @@ static GHashTable *mini_preview_pixbuf_cache = NULL;
 void
 gl_mini_preview_pixbuf_cache_init (void)
 {
-        GList       *names = NULL;
-        GList       *p;
-        lglTemplate *template;
-
 	gl_debug (DEBUG_PIXBUF_CACHE, "START");
 
 	mini_preview_pixbuf_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
 
-        names = lgl_db_get_template_name_list_all (NULL, NULL, NULL);
-        for ( p=names; p != NULL; p=p->next )
+	gl_debug (DEBUG_PIXBUF_CACHE, "END pixbuf_cache=%p", mini_preview_pixbuf_cache);
+}
+
+
+/*****************************************************************************/
+/* Fill cache in the background.                                             */
+/*                                                                           */
+/* Pixbufs are otherwise created on first use; this renders the rest a few  */
+/* at a time from a low priority idle handler, once the UI is up.            */
+/*****************************************************************************/
+void
+gl_mini_preview_pixbuf_cache_warm (void)
+{
+	gl_debug (DEBUG_PIXBUF_CACHE, "START");
+
+        if ( warm_names == NULL )
         {
-                gl_debug (DEBUG_PIXBUF_CACHE, "name = \"%s\"", p->data);
+                warm_names = lgl_db_get_template_name_list_all (NULL, NULL, NULL);
+                warm_next  = warm_names;
 
-                template = lgl_db_lookup_template_from_name (p->data);
-                gl_mini_preview_pixbuf_cache_add_by_template (template);
-                lgl_template_free (template);
+                g_idle_add_full (G_PRIORITY_LOW, warm_idle_cb, NULL, NULL);
         }
-        lgl_db_free_template_name_list (names);
 
-	gl_debug (DEBUG_PIXBUF_CACHE, "END pixbuf_cache=%p", mini_preview_pixbuf_cache);
+	gl_debug (DEBUG_PIXBUF_CACHE, "END");
 }
 
 
@@ -154,6 +174,37 @@ gl_mini_preview_pixbuf_cache_get_pixbuf (gchar      *name)
 }
 
 
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Render next chunk of thumbnails not yet in cache.               */
+/*---------------------------------------------------------------------------*/
+static gboolean
+warm_idle_cb (gpointer data)
+{
+        gint i;
+
+        for ( i = 0; (i < WARM_CHUNK_SIZE) && (warm_next != NULL); warm_next = warm_next->next )
+        {
+                if ( !g_hash_table_lookup (mini_preview_pixbuf_cache, warm_next->data) )
+                {
+                        gl_debug (DEBUG_PIXBUF_CACHE, "name = \"%s\"", warm_next->data);
+
+                        gl_mini_preview_pixbuf_cache_add_by_name (warm_next->data);
+                        i++;
+                }
+        }
+
+        if ( warm_next == NULL )
+        {
+                lgl_db_free_template_name_list (warm_names);
+                warm_names = NULL;
+
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+
 
 /*
  * Local Variables:       -- emacs
@@ -28,6 +28,8 @@ G_BEGIN_DECLS
 
 void        gl_mini_preview_pixbuf_cache_init            (void);
 
+void        gl_mini_preview_pixbuf_cache_warm            (void);
+
 void        gl_mini_preview_pixbuf_cache_add_by_name     (gchar       *name);
 void        gl_mini_preview_pixbuf_cache_add_by_template (lglTemplate *template);
 
@@ -165,7 +165,7 @@ draw_label_outlines (cairo_t           *cr,
 {
 	const lglTemplateFrame *frame;
 	gint                    i, n_labels;
-	lglTemplateOrigin      *origins;
+	const lglTemplateOrigin *origins;
 
 	gl_debug (DEBUG_MINI_PREVIEW, "START");
 
@@ -176,7 +176,7 @@ draw_label_outlines (cairo_t           *cr,
         frame = (lglTemplateFrame *)template->frames->data;
 
 	n_labels = lgl_template_frame_get_n_labels (frame);
-	origins  = lgl_template_frame_get_origins (frame);
+	origins  = lgl_template_frame_get_origins_const (frame);
 
 	for ( i=0; i < n_labels; i++ ) {
 
@@ -184,8 +184,6 @@ draw_label_outlines (cairo_t           *cr,
 
 	}
 
-	g_free (origins);
-
 	cairo_restore (cr);
 
 	gl_debug (DEBUG_MINI_PREVIEW, "END");
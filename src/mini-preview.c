@@ -45,6 +45,8 @@
 #define UP_FONT_FAMILY "Sans"
 #define UP_SCALE 0.15
 
+#define MAX_CACHED_PAGES 8
+
 /*===========================================*/
 /* Private types                             */
 /*===========================================*/
@@ -56,18 +58,12 @@ enum {
         LAST_SIGNAL
 };
 
-typedef struct {
-        gdouble x;
-        gdouble y;
-} LabelCenter;
-
 struct _glMiniPreviewPrivate {
 
         GtkWidget      *canvas;
 
         lglTemplate    *template;
         gint            labels_per_sheet;
-        LabelCenter    *centers;
 
         gint            highlight_first;
         gint            highlight_last;
@@ -92,8 +88,38 @@ struct _glMiniPreviewPrivate {
         gboolean        outline_flag;
         gboolean        reverse_flag;
         gboolean        crop_marks_flag;
+
+        /* Rich preview pages, rendered off the main thread. */
+        glLabel        *render_label;         /* Snapshot of label, or NULL */
+        guint           render_serial;        /* Bumped when cached pages go stale */
+        gboolean        render_pending_flag;
+        GHashTable     *page_cache;           /* page -> cairo_surface_t */
+        gint            cache_width;
+        gint            cache_height;
 };
 
+typedef struct {
+        glMiniPreview  *this;
+        glLabel        *label;
+        guint           serial;
+
+        gint            page;
+        gint            n_sheets;
+        gint            n_copies;
+        gint            first;
+        gint            last;
+        gboolean        collate_flag;
+        gboolean        outline_flag;
+        gboolean        reverse_flag;
+        gboolean        crop_marks_flag;
+
+        gint            width;
+        gint            height;
+        gdouble         scale;
+        gdouble         offset_x;
+        gdouble         offset_y;
+} RenderJob;
+
 
 /*===========================================*/
 /* Private globals                           */
@@ -151,12 +177,31 @@ static void     draw_arrow                     (glMiniPreview          *this,
 
 static void     draw_rich_preview              (glMiniPreview          *this,
                                                 cairo_t                *cr);
+static void     draw_placeholder               (glMiniPreview          *this,
+                                                cairo_t                *cr);
+
+static void     invalidate_pages               (glMiniPreview          *this);
+static void     label_changed_cb               (glLabel                *label,
+                                                glMiniPreview          *this);
+static void     queue_render                   (glMiniPreview          *this);
+static void     render_thread_func             (GTask                  *task,
+                                                gpointer                source_object,
+                                                gpointer                task_data,
+                                                GCancellable           *cancellable);
+static void     render_done_cb                 (GObject                *source_object,
+                                                GAsyncResult           *result,
+                                                RenderJob              *job);
+static void     render_sheet                   (const RenderJob        *job,
+                                                cairo_t                *cr);
 
 
 static gint     find_closest_label             (glMiniPreview          *this,
                                                 gdouble                 x,
                                                 gdouble                 y);
 
+static gdouble  get_scale_and_offset           (glMiniPreview          *this,
+                                                gdouble                *offset_x,
+                                                gdouble                *offset_y);
 static gdouble  set_transform_and_get_scale    (glMiniPreview          *this,
                                                 cairo_t                *cr);
 
@@ -227,6 +272,9 @@ gl_mini_preview_init (glMiniPreview *this)
 
         this->priv = g_new0 (glMiniPreviewPrivate, 1);
 
+        this->priv->page_cache = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                        NULL, (GDestroyNotify)cairo_surface_destroy);
+
         gtk_widget_add_events (GTK_WIDGET (this),
                                GDK_BUTTON_PRESS_MASK | GDK_BUTTON_RELEASE_MASK |
                                GDK_POINTER_MOTION_MASK);
@@ -261,10 +309,16 @@ gl_mini_preview_finalize (GObject *object)
 
         if (this->priv->label)
         {
+                g_signal_handlers_disconnect_by_func (this->priv->label,
+                                                      G_CALLBACK (label_changed_cb), this);
                 g_object_unref (this->priv->label);
         }
+        if (this->priv->render_label)
+        {
+                g_object_unref (this->priv->render_label);
+        }
+        g_hash_table_destroy (this->priv->page_cache);
         lgl_template_free (this->priv->template);
-        g_free (this->priv->centers);
         g_free (this->priv);
 
         G_OBJECT_CLASS (gl_mini_preview_parent_class)->finalize (object);
@@ -340,9 +394,6 @@ gl_mini_preview_set_template (glMiniPreview     *this,
                               const lglTemplate *template)
 {
         const lglTemplateFrame    *frame;
-        lglTemplateOrigin         *origins;
-        gdouble                    w, h;
-        gint                       i;
 
         gl_debug (DEBUG_MINI_PREVIEW, "START");
 
@@ -359,23 +410,10 @@ gl_mini_preview_set_template (glMiniPreview     *this,
          */
         this->priv->labels_per_sheet = lgl_template_frame_get_n_labels (frame);
 
-        /*
-         * Initialize centers
-         */
-        g_free (this->priv->centers);
-        this->priv->centers = g_new0 (LabelCenter, this->priv->labels_per_sheet);
-        origins = lgl_template_frame_get_origins (frame);
-        lgl_template_frame_get_size (frame, &w, &h);
-        for ( i=0; i<this->priv->labels_per_sheet; i++ )
-        {
-                this->priv->centers[i].x = origins[i].x + w/2.0;
-                this->priv->centers[i].y = origins[i].y + h/2.0;
-        }
-        g_free (origins);
-
         /*
          * Redraw modified preview
          */
+        invalidate_pages (this);
         redraw (this);
 
         gl_debug (DEBUG_MINI_PREVIEW, "END");
@@ -446,9 +484,22 @@ gl_mini_preview_set_label (glMiniPreview     *this,
 {
         if ( this->priv->label )
         {
+                g_signal_handlers_disconnect_by_func (this->priv->label,
+                                                      G_CALLBACK (label_changed_cb), this);
                 g_object_unref (this->priv->label);
         }
         this->priv->label = g_object_ref (label);
+        if ( this->priv->render_label )
+        {
+                g_object_unref (this->priv->render_label);
+                this->priv->render_label = NULL;
+        }
+        g_signal_connect (G_OBJECT (label), "changed",
+                          G_CALLBACK (label_changed_cb), this);
+        g_signal_connect (G_OBJECT (label), "merge_changed",
+                          G_CALLBACK (label_changed_cb), this);
+
+        invalidate_pages (this);
         redraw (this);
 }
 
@@ -478,6 +529,7 @@ gl_mini_preview_set_n_sheets (glMiniPreview     *this,
         if ( n_sheets != this->priv->n_sheets )
         {
                 this->priv->n_sheets = n_sheets;
+                invalidate_pages (this);
                 redraw (this);
         }
 }
@@ -493,6 +545,7 @@ gl_mini_preview_set_n_copies (glMiniPreview     *this,
         if ( n_copies != this->priv->n_copies )
         {
                 this->priv->n_copies = n_copies;
+                invalidate_pages (this);
                 redraw (this);
         }
 }
@@ -508,6 +561,7 @@ gl_mini_preview_set_first (glMiniPreview     *this,
         if ( first != this->priv->first )
         {
                 this->priv->first = first;
+                invalidate_pages (this);
                 redraw (this);
         }
 }
@@ -523,6 +577,7 @@ gl_mini_preview_set_last (glMiniPreview     *this,
         if ( last != this->priv->last )
         {
                 this->priv->last = last;
+                invalidate_pages (this);
                 redraw (this);
         }
 }
@@ -538,6 +593,7 @@ gl_mini_preview_set_collate_flag (glMiniPreview     *this,
         if ( collate_flag != this->priv->collate_flag )
         {
                 this->priv->collate_flag = collate_flag;
+                invalidate_pages (this);
                 redraw (this);
         }
 }
@@ -553,6 +609,7 @@ gl_mini_preview_set_outline_flag (glMiniPreview     *this,
         if ( outline_flag != this->priv->outline_flag )
         {
                 this->priv->outline_flag = outline_flag;
+                invalidate_pages (this);
                 redraw (this);
         }
 }
@@ -568,6 +625,7 @@ gl_mini_preview_set_reverse_flag (glMiniPreview     *this,
         if ( reverse_flag != this->priv->reverse_flag )
         {
                 this->priv->reverse_flag = reverse_flag;
+                invalidate_pages (this);
                 redraw (this);
         }
 }
@@ -583,6 +641,7 @@ gl_mini_preview_set_crop_marks_flag (glMiniPreview     *this,
         if ( crop_marks_flag != this->priv->crop_marks_flag )
         {
                 this->priv->crop_marks_flag = crop_marks_flag;
+                invalidate_pages (this);
                 redraw (this);
         }
 }
@@ -594,12 +653,32 @@ gl_mini_preview_set_crop_marks_flag (glMiniPreview     *this,
 static gdouble
 set_transform_and_get_scale (glMiniPreview *this,
                              cairo_t       *cr)
+{
+        gdouble        scale;
+        gdouble        offset_x, offset_y;
+
+        scale = get_scale_and_offset (this, &offset_x, &offset_y);
+
+        /* Set transformation. */
+        cairo_scale (cr, scale, scale);
+        cairo_translate (cr, offset_x, offset_y);
+
+        return scale;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* Get scale and offset of paper within widget.                             */
+/*--------------------------------------------------------------------------*/
+static gdouble
+get_scale_and_offset (glMiniPreview *this,
+                      gdouble       *offset_x,
+                      gdouble       *offset_y)
 {
         lglTemplate   *template = this->priv->template;
         GtkAllocation  allocation;
         gdouble        w, h;
         gdouble        scale;
-        gdouble        offset_x, offset_y;
 
         /* Establish scale and origin. */
         gtk_widget_get_allocation (GTK_WIDGET (this), &allocation);
@@ -611,12 +690,8 @@ set_transform_and_get_scale (glMiniPreview *this,
                      (h - 2*MARGIN - 2*SHADOW_OFFSET)/template->page_height );
 
         /* Find offset to center preview. */
-        offset_x = (w/scale - template->page_width) / 2.0;
-        offset_y = (h/scale - template->page_height) / 2.0;
-
-        /* Set transformation. */
-        cairo_scale (cr, scale, scale);
-        cairo_translate (cr, offset_x, offset_y);
+        *offset_x = (w/scale - template->page_width) / 2.0;
+        *offset_y = (h/scale - template->page_height) / 2.0;
 
         return scale;
 }
@@ -756,29 +831,11 @@ find_closest_label (glMiniPreview      *this,
                     gdouble             x,
                     gdouble             y)
 {
-        gint    i;
-        gint    min_i;
-        gdouble dx, dy, d2, min_d2;
-
-        dx = x - this->priv->centers[0].x;
-        dy = y - this->priv->centers[0].y;
-        min_d2 = dx*dx + dy*dy;
-        min_i = 0;
+        const lglTemplateFrame *frame;
 
-        for ( i=1; i<this->priv->labels_per_sheet; i++ )
-        {
-                dx = x - this->priv->centers[i].x;
-                dy = y - this->priv->centers[i].y;
-                d2 = dx*dx + dy*dy;
-
-                if ( d2 < min_d2 )
-                {
-                        min_d2 = d2;
-                        min_i  = i;
-                }
-        }
+        frame = (lglTemplateFrame *)this->priv->template->frames->data;
 
-        return min_i + 1;
+        return lgl_template_frame_find_nearest_label (frame, x, y) + 1;
 }
 
 
@@ -974,7 +1031,7 @@ draw_labels (glMiniPreview *this,
 {
         const lglTemplateFrame    *frame;
         gint                       i, n_labels;
-        lglTemplateOrigin         *origins;
+        const lglTemplateOrigin   *origins;
         GtkStyle                  *style;
         guint                      base_color;
         guint                      highlight_color, outline_color;
@@ -984,7 +1041,7 @@ draw_labels (glMiniPreview *this,
         frame = (lglTemplateFrame *)template->frames->data;
 
         n_labels = lgl_template_frame_get_n_labels (frame);
-        origins  = lgl_template_frame_get_origins (frame);
+        origins  = lgl_template_frame_get_origins_const (frame);
 
         style = gtk_widget_get_style (GTK_WIDGET(this));
         base_color      = gl_color_from_gdk_color (&style->base[GTK_STATE_SELECTED]);
@@ -1023,8 +1080,6 @@ draw_labels (glMiniPreview *this,
 
         }
 
-        g_free (origins);
-
         gl_debug (DEBUG_MINI_PREVIEW, "END");
 }
 
@@ -1037,7 +1092,7 @@ draw_arrow  (glMiniPreview      *this,
              cairo_t            *cr)
 {
         lglTemplateFrame  *frame;
-        lglTemplateOrigin *origins;
+        const lglTemplateOrigin *origins;
         gdouble            width, height, min;
         gdouble            x0, y0;
         GtkStyle          *style;
@@ -1057,11 +1112,10 @@ draw_arrow  (glMiniPreview      *this,
         if ( width != height )
         {
 
-                origins = lgl_template_frame_get_origins (frame);
+                origins = lgl_template_frame_get_origins_const (frame);
                 x0 = origins[0].x;
                 y0 = origins[0].y;
                 min = MIN (width, height);
-                g_free (origins);
 
                 cairo_save (cr);
 
@@ -1116,66 +1170,297 @@ draw_arrow  (glMiniPreview      *this,
 
 /*--------------------------------------------------------------------------*/
 /* Draw rich preview using print renderers.                                 */
+/*                                                                          */
+/* Full fidelity pages are rendered on a worker thread and cached at the    */
+/* widget's resolution.  Until the current page is ready a placeholder is   */
+/* drawn instead.                                                           */
 /*--------------------------------------------------------------------------*/
 static void
 draw_rich_preview (glMiniPreview          *this,
                    cairo_t                *cr)
 {
-        glMerge      *merge;
+        GtkAllocation    allocation;
+        cairo_surface_t *surface;
+        gdouble          scale, offset_x, offset_y;
+
+        gtk_widget_get_allocation (GTK_WIDGET (this), &allocation);
+        if ( (allocation.width  != this->priv->cache_width) ||
+             (allocation.height != this->priv->cache_height) )
+        {
+                invalidate_pages (this);
+                this->priv->cache_width  = allocation.width;
+                this->priv->cache_height = allocation.height;
+        }
+
+        surface = g_hash_table_lookup (this->priv->page_cache,
+                                       GINT_TO_POINTER (this->priv->page));
+        if ( surface )
+        {
+                /* Surface covers the whole widget, in device units. */
+                scale = get_scale_and_offset (this, &offset_x, &offset_y);
+
+                cairo_save (cr);
+                cairo_translate (cr, -offset_x, -offset_y);
+                cairo_scale (cr, 1.0/scale, 1.0/scale);
+                cairo_set_source_surface (cr, surface, 0, 0);
+                cairo_paint (cr);
+                cairo_restore (cr);
+        }
+        else
+        {
+                draw_placeholder (this, cr);
+                queue_render (this);
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* Draw low fidelity placeholder for a page that is still being rendered.   */
+/*--------------------------------------------------------------------------*/
+static void
+draw_placeholder (glMiniPreview          *this,
+                  cairo_t                *cr)
+{
+        const lglTemplateFrame  *frame;
+        const lglTemplateOrigin *origins;
+        GtkStyle                *style;
+        guint                    fill_color;
+        gint                     i, n_labels;
+
+        frame = (lglTemplateFrame *)this->priv->template->frames->data;
+
+        n_labels = lgl_template_frame_get_n_labels (frame);
+        origins  = lgl_template_frame_get_origins_const (frame);
+
+        style      = gtk_widget_get_style (GTK_WIDGET(this));
+        fill_color = gl_color_from_gdk_color (&style->fg[GTK_STATE_INSENSITIVE]);
+        fill_color = gl_color_set_opacity (fill_color, 0.15);
+
+        cairo_save (cr);
+        cairo_set_source_rgba (cr, GL_COLOR_RGBA_ARGS (fill_color));
+        cairo_set_fill_rule (cr, CAIRO_FILL_RULE_EVEN_ODD);
+
+        for ( i=0; i < n_labels; i++ )
+        {
+                cairo_save (cr);
+                cairo_translate (cr, origins[i].x, origins[i].y);
+                gl_cairo_label_path (cr, this->priv->template, FALSE, FALSE);
+                cairo_fill (cr);
+                cairo_restore (cr);
+        }
+
+        cairo_restore (cr);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* Forget rendered pages; called whenever the label or print options change.*/
+/*--------------------------------------------------------------------------*/
+static void
+invalidate_pages (glMiniPreview          *this)
+{
+        this->priv->render_serial++;
+        g_hash_table_remove_all (this->priv->page_cache);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* Label or its merge source changed.                                       */
+/*--------------------------------------------------------------------------*/
+static void
+label_changed_cb (glLabel                *label,
+                  glMiniPreview          *this)
+{
+        if ( this->priv->render_label )
+        {
+                g_object_unref (this->priv->render_label);
+                this->priv->render_label = NULL;
+        }
+
+        invalidate_pages (this);
+        redraw (this);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* Start rendering the current page, unless a render is already running.   */
+/* Only one page is rendered at a time; when it completes the preview is    */
+/* redrawn, which queues the next page needed, if any.                      */
+/*--------------------------------------------------------------------------*/
+static void
+queue_render (glMiniPreview          *this)
+{
+        RenderJob    *job;
+        GTask        *task;
+
+        if ( this->priv->render_pending_flag )
+        {
+                return;
+        }
+
+        if ( (this->priv->cache_width <= 0) || (this->priv->cache_height <= 0) )
+        {
+                return;
+        }
+
+        /* Worker renders a private copy, so it never touches the live label. */
+        if ( this->priv->render_label == NULL )
+        {
+                this->priv->render_label = gl_label_dup (this->priv->label);
+        }
+
+        job = g_new0 (RenderJob, 1);
+
+        job->this            = g_object_ref (this);
+        job->label           = g_object_ref (this->priv->render_label);
+        job->serial          = this->priv->render_serial;
+
+        job->page            = this->priv->page;
+        job->n_sheets        = this->priv->n_sheets;
+        job->n_copies        = this->priv->n_copies;
+        job->first           = this->priv->first;
+        job->last            = this->priv->last;
+        job->collate_flag    = this->priv->collate_flag;
+        job->outline_flag    = this->priv->outline_flag;
+        job->reverse_flag    = this->priv->reverse_flag;
+        job->crop_marks_flag = this->priv->crop_marks_flag;
+
+        job->width           = this->priv->cache_width;
+        job->height          = this->priv->cache_height;
+        job->scale           = get_scale_and_offset (this, &job->offset_x, &job->offset_y);
+
+        this->priv->render_pending_flag = TRUE;
+
+        task = g_task_new (NULL, NULL, (GAsyncReadyCallback)render_done_cb, job);
+        g_task_set_task_data (task, job, NULL);
+        g_task_run_in_thread (task, render_thread_func);
+        g_object_unref (task);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* Worker thread body for queue_render().                                   */
+/*--------------------------------------------------------------------------*/
+static void
+render_thread_func (GTask                  *task,
+                    gpointer                source_object,
+                    gpointer                task_data,
+                    GCancellable           *cancellable)
+{
+        RenderJob       *job = task_data;
+        cairo_surface_t *surface;
+        cairo_t         *cr;
+
+        gl_debug (DEBUG_MINI_PREVIEW, "START page=%d", job->page);
+
+        surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, job->width, job->height);
+
+        cr = cairo_create (surface);
+        cairo_scale (cr, job->scale, job->scale);
+        cairo_translate (cr, job->offset_x, job->offset_y);
+
+        render_sheet (job, cr);
+
+        cairo_destroy (cr);
+
+        g_task_return_pointer (task, surface, (GDestroyNotify)cairo_surface_destroy);
+
+        gl_debug (DEBUG_MINI_PREVIEW, "END");
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* Back on main thread after queue_render().                                */
+/*--------------------------------------------------------------------------*/
+static void
+render_done_cb (GObject                *source_object,
+                GAsyncResult           *result,
+                RenderJob              *job)
+{
+        glMiniPreview   *this = job->this;
+        cairo_surface_t *surface;
+
+        surface = g_task_propagate_pointer (G_TASK (result), NULL);
+
+        this->priv->render_pending_flag = FALSE;
+
+        if ( job->serial == this->priv->render_serial )
+        {
+                if ( g_hash_table_size (this->priv->page_cache) >= MAX_CACHED_PAGES )
+                {
+                        g_hash_table_remove_all (this->priv->page_cache);
+                }
+                g_hash_table_insert (this->priv->page_cache,
+                                     GINT_TO_POINTER (job->page), surface);
+        }
+        else
+        {
+                /* Label or options changed while rendering. */
+                cairo_surface_destroy (surface);
+        }
+
+        redraw (this);
+
+        g_object_unref (job->label);
+        g_object_unref (job->this);
+        g_free (job);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* Render one sheet of a render job using print renderers.                  */
+/*--------------------------------------------------------------------------*/
+static void
+render_sheet (const RenderJob        *job,
+              cairo_t                *cr)
+{
         glPrintState  state;
 
-        merge = gl_label_get_merge (this->priv->label);
+        /* The state holds the only copy of the merge taken for this sheet. */
+        gl_print_state_init (&state, job->label);
 
-        if (!merge)
+        if (!state.merge)
         {
-                gl_print_simple_sheet (this->priv->label,
+                gl_print_simple_sheet (job->label,
                                        cr,
-                                       this->priv->page,
-                                       this->priv->n_sheets,
-                                       this->priv->first,
-                                       this->priv->last,
-                                       this->priv->outline_flag,
-                                       this->priv->reverse_flag,
-                                       this->priv->crop_marks_flag);
+                                       job->page,
+                                       job->n_sheets,
+                                       job->first,
+                                       job->last,
+                                       job->outline_flag,
+                                       job->reverse_flag,
+                                       job->crop_marks_flag);
         }
         else
         {
-                /* FIXME: maybe the renderers should be more self contained.
-                 *        This will only work for the first page, since
-                 *        previous pages must be rendered to establish
-                 *        state.
-                 */
-                state.i_copy = 0;
-                state.p_record = (GList *)gl_merge_get_record_list (merge);
-
-                if (this->priv->collate_flag)
+                if (job->collate_flag)
                 {
-                        gl_print_collated_merge_sheet (this->priv->label,
+                        gl_print_collated_merge_sheet (job->label,
                                                        cr,
-                                                       this->priv->page,
-                                                       this->priv->n_copies,
-                                                       this->priv->first,
-                                                       this->priv->outline_flag,
-                                                       this->priv->reverse_flag,
-                                                       this->priv->crop_marks_flag,
+                                                       job->page,
+                                                       job->n_copies,
+                                                       job->first,
+                                                       job->outline_flag,
+                                                       job->reverse_flag,
+                                                       job->crop_marks_flag,
                                                        &state);
                 }
                 else
                 {
-                        gl_print_uncollated_merge_sheet (this->priv->label,
+                        gl_print_uncollated_merge_sheet (job->label,
                                                          cr,
-                                                         this->priv->page,
-                                                         this->priv->n_copies,
-                                                         this->priv->first,
-                                                         this->priv->outline_flag,
-                                                         this->priv->reverse_flag,
-                                                         this->priv->crop_marks_flag,
+                                                         job->page,
+                                                         job->n_copies,
+                                                         job->first,
+                                                         job->outline_flag,
+                                                         job->reverse_flag,
+                                                         job->crop_marks_flag,
                                                          &state);
                 }
         }
-}
-
 
+        gl_print_state_clear (&state);
+}
 
 /*
  * Local Variables:       -- emacs
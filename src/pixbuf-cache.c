@@ -22,6 +22,10 @@
 
 #include "pixbuf-cache.h"
 
+#include <string.h>
+
+#include "pixbuf-util.h"
+
 #include "debug.h"
 
 
@@ -30,9 +34,16 @@
 /*========================================================*/
 
 typedef struct {
-	gchar     *key;
-	guint      references;
-	GdkPixbuf *pixbuf;
+	gchar           *key;
+	guint            references;
+	GdkPixbuf       *pixbuf;
+
+	/* Original JPEG or PNG file contents, until handed to surface. */
+	const gchar     *mime_type;
+	gchar           *data;
+	gsize            length;
+
+	cairo_surface_t *surface;
 } CacheRecord;
 
 
@@ -45,7 +56,10 @@ typedef struct {
 /* Private function prototypes.                           */
 /*========================================================*/
 
-static void  record_destroy   (gpointer val);
+static void       record_destroy   (gpointer     val);
+
+static GdkPixbuf *load_pixbuf      (CacheRecord *record,
+				    gchar       *name);
 
 static void  add_name_to_list (gpointer key,
 			       gpointer val,
@@ -64,6 +78,10 @@ record_destroy (gpointer val)
 
 	g_free (record->key);
 	g_object_unref (record->pixbuf);
+	g_free (record->data);
+	if (record->surface != NULL) {
+		cairo_surface_destroy (record->surface);
+	}
 	g_free (record);
 }
 
@@ -149,20 +167,25 @@ gl_pixbuf_cache_get_pixbuf (GHashTable *pixbuf_cache,
 
 	if (record != NULL) {
 		record->references++;
+		gl_stats_inc (GL_STATS_CACHE_HITS);
 		gl_debug (DEBUG_PIXBUF_CACHE, "references=%d", record->references);
 		gl_debug (DEBUG_PIXBUF_CACHE, "END cached");
 		return record->pixbuf;
 	}
 
 
-	pixbuf = gdk_pixbuf_new_from_file (name, NULL);
+	gl_stats_inc (GL_STATS_CACHE_MISSES);
+
+	record = g_new0 (CacheRecord, 1);
+	pixbuf = load_pixbuf (record, name);
 	if ( pixbuf != NULL) {
-		record = g_new0 (CacheRecord, 1);
 		record->key        = g_strdup (name);
 		record->references = 1;
 		record->pixbuf     = pixbuf;
 
 		g_hash_table_insert (pixbuf_cache, record->key, record);
+	} else {
+		g_free (record);
 	}
 
 	gl_debug (DEBUG_PIXBUF_CACHE, "END");
@@ -171,6 +194,98 @@ gl_pixbuf_cache_get_pixbuf (GHashTable *pixbuf_cache,
 }
 
 
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Read pixbuf from file.  JPEG and PNG files are decoded from     */
+/* memory, so that their original contents can be kept in the record.       */
+/*---------------------------------------------------------------------------*/
+static GdkPixbuf *
+load_pixbuf (CacheRecord *record,
+	     gchar       *name)
+{
+	GdkPixbufFormat *format;
+	gchar           *format_name;
+	GdkPixbufLoader *loader;
+	GdkPixbuf       *pixbuf = NULL;
+
+	format = gdk_pixbuf_get_file_info (name, NULL, NULL);
+	if (format == NULL) {
+		return NULL;
+	}
+
+	format_name = gdk_pixbuf_format_get_name (format);
+	if (strcmp (format_name, "jpeg") == 0) {
+		record->mime_type = CAIRO_MIME_TYPE_JPEG;
+	} else if (strcmp (format_name, "png") == 0) {
+		record->mime_type = CAIRO_MIME_TYPE_PNG;
+	}
+	g_free (format_name);
+
+	if ( (record->mime_type == NULL) ||
+	     !g_file_get_contents (name, &record->data, &record->length, NULL) ) {
+		record->mime_type = NULL;
+		return gdk_pixbuf_new_from_file (name, NULL);
+	}
+
+	loader = gdk_pixbuf_loader_new ();
+	if ( gdk_pixbuf_loader_write (loader, (guchar *)record->data, record->length, NULL) &&
+	     gdk_pixbuf_loader_close (loader, NULL) ) {
+		pixbuf = gdk_pixbuf_loader_get_pixbuf (loader);
+		if (pixbuf != NULL) {
+			g_object_ref (pixbuf);
+		}
+	} else {
+		gdk_pixbuf_loader_close (loader, NULL);
+	}
+	g_object_unref (loader);
+
+	if (pixbuf == NULL) {
+		g_free (record->data);
+		record->data      = NULL;
+		record->mime_type = NULL;
+	}
+
+	return pixbuf;
+}
+
+
+/*****************************************************************************/
+/* Get persistent cairo surface of a pixbuf already in cache, or NULL.       */
+/* Drawing the same surface each time lets vector backends embed the image   */
+/* only once.  Files read as JPEG or PNG carry their original data, which    */
+/* backends that understand it embed instead of re-encoding the pixels.      */
+/* The surface is owned by the cache.                                        */
+/*****************************************************************************/
+cairo_surface_t *
+gl_pixbuf_cache_get_surface (GHashTable *pixbuf_cache,
+			     gchar      *name)
+{
+	CacheRecord *record;
+
+	gl_debug (DEBUG_PIXBUF_CACHE, "START");
+
+	record = g_hash_table_lookup (pixbuf_cache, name);
+	if (record == NULL) {
+		gl_debug (DEBUG_PIXBUF_CACHE, "END not in cache");
+		return NULL;
+	}
+
+	if (record->surface == NULL) {
+		record->surface = gl_pixbuf_util_create_surface (record->pixbuf);
+
+		if (record->data != NULL) {
+			cairo_surface_set_mime_data (record->surface, record->mime_type,
+						     (guchar *)record->data, record->length,
+						     g_free, record->data);
+			record->data = NULL;
+		}
+	}
+
+	gl_debug (DEBUG_PIXBUF_CACHE, "END");
+
+	return record->surface;
+}
+
+
 /*****************************************************************************/
 /* Remove pixbuf, but only if no references left.                            */
 /*****************************************************************************/
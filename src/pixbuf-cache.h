@@ -23,6 +23,7 @@
 
 #include <glib.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
+#include <cairo.h>
 
 G_BEGIN_DECLS
 
@@ -37,6 +38,9 @@ void        gl_pixbuf_cache_add_pixbuf     (GHashTable *pixbuf_cache,
 GdkPixbuf  *gl_pixbuf_cache_get_pixbuf     (GHashTable *pixbuf_cache,
 					    gchar      *name);
 
+cairo_surface_t *gl_pixbuf_cache_get_surface (GHashTable *pixbuf_cache,
+					      gchar      *name);
+
 void        gl_pixbuf_cache_remove_pixbuf  (GHashTable *pixbuf_cache,
 					    gchar      *name);
 
@@ -22,6 +22,8 @@
 
 #include "pixbuf-util.h"
 
+#include <string.h>
+
 #include "color.h"
 
 #include "debug.h"
@@ -31,6 +33,9 @@
 /* Private macros and constants.                          */
 /*========================================================*/
 
+/* Premultiply 8-bit color component c by alpha a, rounded. */
+#define PREMULTIPLY(c,a,t) ((t) = (c)*(a) + 0x80, (((t) >> 8) + (t)) >> 8)
+
 
 /*========================================================*/
 /* Private types.                                         */
@@ -41,6 +46,8 @@
 /* Private globals.                                       */
 /*========================================================*/
 
+static gint surface_id = 0;
+
 
 /*========================================================*/
 /* Private function prototypes.                           */
@@ -49,6 +56,11 @@
 
 /****************************************************************************/
 /* Create shadow version of given pixbuf.                                   */
+/*                                                                          */
+/* Every shadow pixel has the same RGB, so a template row of shadow pixels  */
+/* is built once and copied to each destination row.  Only the alpha bytes  */
+/* then depend on the source, and are mapped through a lookup table rather  */
+/* than scaled in floating point per pixel.                                 */
 /****************************************************************************/
 GdkPixbuf *
 gl_pixbuf_util_create_shadow_pixbuf (const GdkPixbuf *pixbuf,
@@ -62,14 +74,13 @@ gl_pixbuf_util_create_shadow_pixbuf (const GdkPixbuf *pixbuf,
         guchar          *buf_src, *buf_dest;
         guchar          *p_src, *p_dest;
         gint             ix, iy;
-        guchar           shadow_r, shadow_g, shadow_b;
+        guchar          *template_row;
+        guchar           alpha_lut[256];
+        guchar           shadow_alpha;
+        gint             i;
 
         g_return_val_if_fail (pixbuf && GDK_IS_PIXBUF (pixbuf), NULL);
 
-        shadow_r = GL_COLOR_F_RED   (shadow_color) * 255.0;
-        shadow_g = GL_COLOR_F_GREEN (shadow_color) * 255.0;
-        shadow_b = GL_COLOR_F_BLUE  (shadow_color) * 255.0;
-
         /* extract pixels and parameters from source pixbuf. */
         buf_src         = gdk_pixbuf_get_pixels (pixbuf);
         bits_per_sample = gdk_pixbuf_get_bits_per_sample (pixbuf);
@@ -95,41 +106,121 @@ gl_pixbuf_util_create_shadow_pixbuf (const GdkPixbuf *pixbuf,
                 return NULL;
         }
 
-        /* Process pixels: set rgb components and composite alpha with shadow_opacity. */
-        p_src  = buf_src;
-        p_dest = buf_dest;
-        for ( iy=0; iy < height; iy++ )
+        /* Alpha of a shadow pixel is source alpha composited with shadow_opacity. */
+        for ( i = 0; i < 256; i++ )
+        {
+                alpha_lut[i] = i * shadow_opacity;
+        }
+        shadow_alpha = alpha_lut[255];
+
+        /* Template row: shadow color, with opaque-source alpha. */
+        template_row = g_malloc (4*width);
+        for ( ix = 0, p_dest = template_row; ix < width; ix++ )
+        {
+                *p_dest++ = GL_COLOR_F_RED   (shadow_color) * 255.0;
+                *p_dest++ = GL_COLOR_F_GREEN (shadow_color) * 255.0;
+                *p_dest++ = GL_COLOR_F_BLUE  (shadow_color) * 255.0;
+                *p_dest++ = shadow_alpha;
+        }
+
+        for ( iy = 0; iy < height; iy++ )
         {
-        
-                p_src  = buf_src + iy*src_rowstride;
                 p_dest = buf_dest + iy*dest_rowstride;
 
-                for ( ix=0; ix < width; ix++ )
+                memcpy (p_dest, template_row, 4*width);
+
+                if ( src_has_alpha )
                 {
+                        p_src = buf_src + iy*src_rowstride + 3;
+
+                        for ( ix = 0; ix < width; ix++ )
+                        {
+                                p_dest[4*ix + 3] = alpha_lut[p_src[4*ix]];
+                        }
+                }
+        }
+
+        g_free (template_row);
+
+        return dest_pixbuf;
+}
 
-                        p_src += 3; /* skip RGB */
 
-                        *p_dest++ = shadow_r;
-                        *p_dest++ = shadow_g;
-                        *p_dest++ = shadow_b;
 
-                        if ( src_has_alpha )
+/****************************************************************************/
+/* Create cairo image surface with the contents of given pixbuf.            */
+/*                                                                          */
+/* Each surface is tagged with its own unique ID, so that vector backends   */
+/* embed the image once no matter how many times it is drawn, as long as    */
+/* the caller keeps reusing the same surface.                               */
+/****************************************************************************/
+cairo_surface_t *
+gl_pixbuf_util_create_surface (const GdkPixbuf *pixbuf)
+{
+        gint             channels;
+        gint             width, height, src_rowstride, dest_rowstride;
+        cairo_surface_t *surface;
+        guchar          *buf_src, *buf_dest;
+        guchar          *p_src;
+        guint32         *p_dest;
+        gint             ix, iy;
+        guint            a, t;
+        gchar           *id;
+
+        g_return_val_if_fail (pixbuf && GDK_IS_PIXBUF (pixbuf), NULL);
+        g_return_val_if_fail (gdk_pixbuf_get_bits_per_sample (pixbuf) == 8, NULL);
+
+        buf_src         = gdk_pixbuf_get_pixels (pixbuf);
+        channels        = gdk_pixbuf_get_n_channels (pixbuf);
+        width           = gdk_pixbuf_get_width (pixbuf);
+        height          = gdk_pixbuf_get_height (pixbuf);
+        src_rowstride   = gdk_pixbuf_get_rowstride (pixbuf);
+
+        surface = cairo_image_surface_create ((channels == 4) ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_RGB24,
+                                              width, height);
+        if ( cairo_surface_status (surface) != CAIRO_STATUS_SUCCESS )
+        {
+                return surface;
+        }
+
+        cairo_surface_flush (surface);
+        buf_dest       = cairo_image_surface_get_data (surface);
+        dest_rowstride = cairo_image_surface_get_stride (surface);
+
+        for ( iy = 0; iy < height; iy++ )
+        {
+                p_src  = buf_src + iy*src_rowstride;
+                p_dest = (guint32 *)(buf_dest + iy*dest_rowstride);
+
+                if ( channels == 4 )
+                {
+                        for ( ix = 0; ix < width; ix++, p_src += 4 )
                         {
-                                *p_dest++ = *p_src++ * shadow_opacity;
+                                a = p_src[3];
+                                p_dest[ix] = (a << 24)                            |
+                                             (PREMULTIPLY (p_src[0], a, t) << 16) |
+                                             (PREMULTIPLY (p_src[1], a, t) << 8)  |
+                                              PREMULTIPLY (p_src[2], a, t);
                         }
-                        else
+                }
+                else
+                {
+                        for ( ix = 0; ix < width; ix++, p_src += channels )
                         {
-                                *p_dest++ = shadow_opacity * 255.0;
+                                p_dest[ix] = 0xff000000 | (p_src[0] << 16) | (p_src[1] << 8) | p_src[2];
                         }
-
-
                 }
-
         }
 
-        return dest_pixbuf;
-}
+        cairo_surface_mark_dirty (surface);
+
+        id = g_strdup_printf ("glabels-image-%d", g_atomic_int_add (&surface_id, 1));
+        cairo_surface_set_mime_data (surface, CAIRO_MIME_TYPE_UNIQUE_ID,
+                                     (guchar *)id, strlen (id),
+                                     g_free, id);
 
+        return surface;
+}
 
 
 
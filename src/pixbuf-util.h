@@ -23,6 +23,7 @@
 
 #include <glib.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
+#include <cairo.h>
 
 G_BEGIN_DECLS
 
@@ -31,6 +32,8 @@ GdkPixbuf *gl_pixbuf_util_create_shadow_pixbuf (const GdkPixbuf *pixbuf,
                                                 guint            shadow_color,
                                                 gdouble          shadow_opacity);
 
+cairo_surface_t *gl_pixbuf_util_create_surface (const GdkPixbuf *pixbuf);
+
 
 G_END_DECLS
 
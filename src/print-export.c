@@ -0,0 +1,429 @@
+/*
+ *  print-export.c
+ *  Copyright (C) 2001-2009  Jim Evins <evins@snaught.com>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include "print-export.h"
+
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <cairo/cairo-pdf.h>
+#include <cairo/cairo-ps.h>
+#include <cairo/cairo-svg.h>
+
+#include <libglabels.h>
+#include "print.h"
+#include "file-util.h"
+
+#include "debug.h"
+
+
+/*===========================================*/
+/* Private data types                        */
+/*===========================================*/
+
+typedef struct {
+        glLabel                    *label;
+        const glPrintExportOptions *options;
+
+        gboolean                    merge_flag;
+        glPrintState                state;
+        gint                        n_sheets;
+
+        glPrintExportFormat         format;
+        gdouble                     page_width;
+        gdouble                     page_height;
+} ExportJob;
+
+typedef struct {
+        FILE                       *fp;
+        gint                        errsv;     /* errno of a failed write, or 0 */
+} ExportStream;
+
+
+/*===========================================*/
+/* Local function prototypes                 */
+/*===========================================*/
+
+static gboolean         export_file        (ExportJob           *job,
+                                            const gchar         *filename,
+                                            gint                 first_sheet,
+                                            gint                 last_sheet,
+                                            GError             **error);
+
+static void             draw_sheet         (ExportJob           *job,
+                                            cairo_t             *cr,
+                                            gint                 i_sheet);
+
+static cairo_surface_t *create_surface     (glPrintExportFormat  format,
+                                            ExportStream        *stream,
+                                            gdouble              w,
+                                            gdouble              h);
+
+static cairo_status_t   write_cb           (void                *closure,
+                                            const guchar        *data,
+                                            guint                length);
+
+
+/*****************************************************************************/
+/* Error domain of export errors.                                            */
+/*****************************************************************************/
+GQuark
+gl_print_export_error_quark (void)
+{
+        return g_quark_from_static_string ("gl-print-export-error-quark");
+}
+
+
+/*****************************************************************************/
+/* Initialize options to the defaults of a new glPrintOp for label.          */
+/*****************************************************************************/
+void
+gl_print_export_options_init (glPrintExportOptions *options,
+                              glLabel              *label)
+{
+        const lglTemplate      *template;
+        const lglTemplateFrame *frame;
+
+        template = gl_label_get_template (label);
+        frame    = (lglTemplateFrame *)template->frames->data;
+
+        memset (options, 0, sizeof (glPrintExportOptions));
+
+        options->n_sheets = 1;
+        options->n_copies = 1;
+        options->first    = 1;
+        options->last     = lgl_template_frame_get_n_labels (frame);
+}
+
+
+/*****************************************************************************/
+/* Choose export format from filename extension.  Returns FALSE if the       */
+/* extension is not one of ".pdf", ".ps" or ".svg".                          */
+/*****************************************************************************/
+gboolean
+gl_print_export_format_from_filename (const gchar         *filename,
+                                      glPrintExportFormat *format)
+{
+        if ( gl_file_util_is_extension (filename, ".pdf") )
+        {
+                *format = GL_PRINT_EXPORT_PDF;
+        }
+        else if ( gl_file_util_is_extension (filename, ".ps") )
+        {
+                *format = GL_PRINT_EXPORT_PS;
+        }
+        else if ( gl_file_util_is_extension (filename, ".svg") )
+        {
+                *format = GL_PRINT_EXPORT_SVG;
+        }
+        else
+        {
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+
+/*****************************************************************************/
+/* Print label directly to a PDF, PostScript or SVG file, without a          */
+/* GtkPrintOperation.  SVG has no notion of pages, so a multi-sheet SVG job  */
+/* is written as one file per sheet, numbered "name-N.svg".  Returns FALSE   */
+/* and sets error if the sheet range selects no sheet or a file cannot be    */
+/* written; a file left incomplete is removed.                               */
+/*****************************************************************************/
+gboolean
+gl_print_export (glLabel                    *label,
+                 const gchar                *filename,
+                 glPrintExportFormat         format,
+                 const glPrintExportOptions *options,
+                 GError                    **error)
+{
+        ExportJob               job;
+        const lglTemplate      *template;
+        const lglTemplateFrame *frame;
+        gint                    first_sheet, last_sheet, i_sheet;
+        gchar                  *sheet_filename;
+        gboolean                ok;
+
+        gl_debug (DEBUG_PRINT, "START");
+
+        template = gl_label_get_template (label);
+        frame    = (lglTemplateFrame *)template->frames->data;
+
+        job.label       = label;
+        job.options     = options;
+        job.format      = format;
+        job.page_width  = template->page_width;
+        job.page_height = template->page_height;
+
+        /* The state's copy of the merge, if any, is the only one fetched. */
+        if ( options->state != NULL )
+        {
+                job.state      = *options->state;
+                job.merge_flag = TRUE;
+        }
+        else
+        {
+                gl_print_state_init (&job.state, label);
+                job.merge_flag = (job.state.merge != NULL);
+        }
+
+        if ( job.merge_flag )
+        {
+                job.n_sheets = gl_print_state_get_n_sheets (&job.state,
+                                                            options->n_copies,
+                                                            options->first,
+                                                            lgl_template_frame_get_n_labels (frame));
+        }
+        else
+        {
+                job.n_sheets = options->n_sheets;
+        }
+
+        /* Same range rules as a glPrintOp. */
+        first_sheet = MAX (options->first_sheet, 1);
+        last_sheet  = job.n_sheets;
+        if ( (options->last_sheet > 0) && (options->last_sheet < last_sheet) )
+        {
+                last_sheet = options->last_sheet;
+        }
+
+        if ( first_sheet > last_sheet )
+        {
+                g_set_error (error, GL_PRINT_EXPORT_ERROR, GL_PRINT_EXPORT_ERROR_RANGE,
+                             _("no sheet in range %d-%d, the document has %d sheets"),
+                             first_sheet, MAX (options->last_sheet, first_sheet), job.n_sheets);
+                ok = FALSE;
+        }
+        else if ( (format == GL_PRINT_EXPORT_SVG) && (last_sheet > first_sheet) )
+        {
+                ok = TRUE;
+                for ( i_sheet = first_sheet; (i_sheet <= last_sheet) && ok; i_sheet++ )
+                {
+                        sheet_filename = gl_file_util_insert_number (filename, i_sheet);
+                        ok = export_file (&job, sheet_filename, i_sheet, i_sheet, error);
+                        g_free (sheet_filename);
+                }
+        }
+        else
+        {
+                ok = export_file (&job, filename, first_sheet, last_sheet, error);
+        }
+
+        if ( options->state == NULL )
+        {
+                gl_print_state_clear (&job.state);
+        }
+
+        gl_debug (DEBUG_PRINT, "END ok=%d", ok);
+
+        return ok;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Write sheets first_sheet..last_sheet (1-based) to one file.    */
+/* On error the file is removed.                                            */
+/*--------------------------------------------------------------------------*/
+static gboolean
+export_file (ExportJob   *job,
+             const gchar *filename,
+             gint         first_sheet,
+             gint         last_sheet,
+             GError     **error)
+{
+        ExportStream     stream;
+        cairo_surface_t *surface;
+        cairo_t         *cr;
+        gint             i_sheet;
+        cairo_status_t   status = CAIRO_STATUS_SUCCESS;
+        gint             errsv;
+
+        stream.fp    = g_fopen (filename, "wb");
+        stream.errsv = 0;
+        if ( stream.fp == NULL )
+        {
+                errsv = errno;
+                g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+                             _("cannot create %s: %s"), filename, g_strerror (errsv));
+                return FALSE;
+        }
+
+        surface = create_surface (job->format, &stream, job->page_width, job->page_height);
+
+        for ( i_sheet = first_sheet; i_sheet <= last_sheet; i_sheet++ )
+        {
+                cr = cairo_create (surface);
+
+                draw_sheet (job, cr, i_sheet - 1);
+                cairo_show_page (cr);
+
+                status = cairo_status (cr);
+                cairo_destroy (cr);
+
+                if ( status != CAIRO_STATUS_SUCCESS )
+                {
+                        break;
+                }
+        }
+
+        cairo_surface_finish (surface);
+        if ( status == CAIRO_STATUS_SUCCESS )
+        {
+                status = cairo_surface_status (surface);
+        }
+        cairo_surface_destroy (surface);
+
+        if ( (fclose (stream.fp) != 0) && (stream.errsv == 0) )
+        {
+                stream.errsv = errno;
+        }
+
+        if ( stream.errsv != 0 )
+        {
+                g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (stream.errsv),
+                             _("cannot write %s: %s"), filename, g_strerror (stream.errsv));
+        }
+        else if ( status != CAIRO_STATUS_SUCCESS )
+        {
+                g_set_error (error, GL_PRINT_EXPORT_ERROR, GL_PRINT_EXPORT_ERROR_RENDER,
+                             _("cannot render %s: %s"), filename, cairo_status_to_string (status));
+        }
+        else
+        {
+                return TRUE;
+        }
+
+        g_unlink (filename);
+
+        return FALSE;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Draw one sheet (0-based), as the glPrintOp draw-page callback. */
+/*--------------------------------------------------------------------------*/
+static void
+draw_sheet (ExportJob *job,
+            cairo_t   *cr,
+            gint       i_sheet)
+{
+        const glPrintExportOptions *options = job->options;
+
+        if (!job->merge_flag)
+        {
+                gl_print_simple_sheet (job->label,
+                                       cr,
+                                       i_sheet,
+                                       job->n_sheets,
+                                       options->first,
+                                       options->last,
+                                       options->outline_flag,
+                                       options->reverse_flag,
+                                       options->crop_marks_flag);
+        }
+        else if (options->collate_flag)
+        {
+                gl_print_collated_merge_sheet (job->label,
+                                               cr,
+                                               i_sheet,
+                                               options->n_copies,
+                                               options->first,
+                                               options->outline_flag,
+                                               options->reverse_flag,
+                                               options->crop_marks_flag,
+                                               &job->state);
+        }
+        else
+        {
+                gl_print_uncollated_merge_sheet (job->label,
+                                                 cr,
+                                                 i_sheet,
+                                                 options->n_copies,
+                                                 options->first,
+                                                 options->outline_flag,
+                                                 options->reverse_flag,
+                                                 options->crop_marks_flag,
+                                                 &job->state);
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Create vector surface of given format writing to stream.       */
+/*--------------------------------------------------------------------------*/
+static cairo_surface_t *
+create_surface (glPrintExportFormat  format,
+                ExportStream        *stream,
+                gdouble              w,
+                gdouble              h)
+{
+        switch (format)
+        {
+        case GL_PRINT_EXPORT_PS:
+                return cairo_ps_surface_create_for_stream (write_cb, stream, w, h);
+        case GL_PRINT_EXPORT_SVG:
+                return cairo_svg_surface_create_for_stream (write_cb, stream, w, h);
+        default:
+                return cairo_pdf_surface_create_for_stream (write_cb, stream, w, h);
+        }
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Cairo write function.                                          */
+/*--------------------------------------------------------------------------*/
+static cairo_status_t
+write_cb (void         *closure,
+          const guchar *data,
+          guint         length)
+{
+        ExportStream *stream = closure;
+
+        if ( fwrite (data, 1, length, stream->fp) != length )
+        {
+                if ( stream->errsv == 0 )
+                {
+                        stream->errsv = errno;
+                }
+                return CAIRO_STATUS_WRITE_ERROR;
+        }
+
+        gl_stats_add (GL_STATS_BYTES_WRITTEN, length);
+
+        return CAIRO_STATUS_SUCCESS;
+}
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
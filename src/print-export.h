@@ -0,0 +1,103 @@
+/*
+ *  print-export.h
+ *  Copyright (C) 2001-2009  Jim Evins <evins@snaught.com>.
+ *
+ *  This file is part of gLabels.
+ *
+ *  gLabels is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PRINT_EXPORT_H__
+#define __PRINT_EXPORT_H__
+
+#include <cairo/cairo.h>
+
+#include "label.h"
+#include "print.h"
+
+G_BEGIN_DECLS
+
+#define GL_PRINT_EXPORT_ERROR gl_print_export_error_quark ()
+
+/*
+ * Export errors.  Failures to create or write a file are reported in the
+ * G_FILE_ERROR domain instead.
+ */
+typedef enum {
+        GL_PRINT_EXPORT_ERROR_RANGE,    /* No sheet in the requested range */
+        GL_PRINT_EXPORT_ERROR_RENDER    /* Cairo failed to render the output */
+} glPrintExportError;
+
+typedef enum {
+        GL_PRINT_EXPORT_PDF,
+        GL_PRINT_EXPORT_PS,
+        GL_PRINT_EXPORT_SVG
+} glPrintExportFormat;
+
+
+/*
+ * Job parameters, with the same meaning as the corresponding glPrintOp
+ * parameters.  n_sheets and last only apply to labels without a merge source;
+ * merged labels print as many sheets as the selected records need.  If state
+ * is set, the label prints as a merged label with only the records it
+ * indexes, rather than all selected records of its merge; it remains owned
+ * by the caller.
+ */
+typedef struct {
+        gint      n_sheets;
+        gint      n_copies;
+        gint      first;
+        gint      last;
+
+        gint      first_sheet;
+        gint      last_sheet;
+
+        gboolean  outline_flag;
+        gboolean  reverse_flag;
+        gboolean  crop_marks_flag;
+        gboolean  collate_flag;
+
+        const glPrintState *state;
+} glPrintExportOptions;
+
+
+GQuark          gl_print_export_error_quark          (void);
+
+void            gl_print_export_options_init         (glPrintExportOptions       *options,
+                                                      glLabel                    *label);
+
+gboolean        gl_print_export_format_from_filename (const gchar                *filename,
+                                                      glPrintExportFormat        *format);
+
+gboolean        gl_print_export                      (glLabel                    *label,
+                                                      const gchar                *filename,
+                                                      glPrintExportFormat         format,
+                                                      const glPrintExportOptions *options,
+                                                      GError                    **error);
+
+G_END_DECLS
+
+#endif
+
+
+
+
+/*
+ * Local Variables:       -- emacs
+ * mode: C                -- emacs
+ * c-basic-offset: 8      -- emacs
+ * tab-width: 8           -- emacs
+ * indent-tabs-mode: nil  -- emacs
+ * End:                   -- emacs
+ */
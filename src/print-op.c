@@ -58,6 +58,9 @@ struct _glPrintOpPrivate {
         gint       n_sheets;
         gint       n_copies;
 
+        gint       first_sheet;
+        gint       last_sheet;
+
         glPrintState state;
 };
 
@@ -149,6 +152,7 @@ gl_print_op_finalize (GObject *object)
 
         g_object_unref (G_OBJECT(op->priv->label));
         g_free (op->priv->filename);
+        gl_print_state_clear (&op->priv->state);
 	g_free (op->priv);
 
 	G_OBJECT_CLASS (gl_print_op_parent_class)->finalize (object);
@@ -194,6 +198,10 @@ gl_print_op_construct (glPrintOp      *op,
         frame    = (lglTemplateFrame *)template->frames->data;
 
         op->priv->merge_flag         = (merge != NULL);
+        if ( merge != NULL )
+        {
+                g_object_unref (merge);
+        }
         op->priv->n_sheets           = 1;
         op->priv->first              = 1;
         op->priv->last               = lgl_template_frame_get_n_labels (frame);
@@ -260,6 +268,21 @@ gl_print_op_set_n_copies (glPrintOp *op,
 }
 
 
+/*****************************************************************************/
+/* Restrict job to sheets first_sheet..last_sheet (1-based, inclusive).      */
+/* A value of 0 leaves that end of the range open.  The job is cancelled if  */
+/* no sheet of the document is in range.                                     */
+/*****************************************************************************/
+void
+gl_print_op_set_sheet_range (glPrintOp *op,
+                             gint       first_sheet,
+                             gint       last_sheet)
+{
+        op->priv->first_sheet = first_sheet;
+        op->priv->last_sheet  = last_sheet;
+}
+
+
 void
 gl_print_op_set_first (glPrintOp *op,
                        gint       first)
@@ -521,8 +544,29 @@ begin_print_cb (GtkPrintOperation *operation,
 		gpointer           user_data)
 {
         glPrintOp *op = GL_PRINT_OP (operation);
+        gint       first_sheet, last_sheet;
 
-        gtk_print_operation_set_n_pages (operation, op->priv->n_sheets);
+        first_sheet = MAX (op->priv->first_sheet, 1);
+        last_sheet  = op->priv->n_sheets;
+        if ( (op->priv->last_sheet > 0) && (op->priv->last_sheet < last_sheet) )
+        {
+                last_sheet = op->priv->last_sheet;
+        }
+        if ( first_sheet > last_sheet )
+        {
+                /* Nothing in range; print nothing rather than another sheet. */
+                gtk_print_operation_cancel (operation);
+                return;
+        }
+        op->priv->first_sheet = first_sheet;
+
+        gtk_print_operation_set_n_pages (operation, last_sheet - first_sheet + 1);
+
+        if (op->priv->merge_flag)
+        {
+                gl_print_state_clear (&op->priv->state);
+                gl_print_state_init (&op->priv->state, op->priv->label);
+        }
 
 }
 
@@ -541,6 +585,9 @@ draw_page_cb (GtkPrintOperation *operation,
 
         cr = gtk_print_context_get_cairo_context (context);
 
+        /* Sheets are independent, so a sub-range just offsets the sheet number. */
+        page_nr += op->priv->first_sheet - 1;
+
         if (!op->priv->merge_flag)
         {
                 gl_print_simple_sheet (op->priv->label,
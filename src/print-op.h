@@ -75,6 +75,9 @@ void               gl_print_op_set_n_sheets        (glPrintOp         *print_op,
                                                     gint               n_sheets);
 void               gl_print_op_set_n_copies        (glPrintOp         *print_op,
                                                     gint               n_copies);
+void               gl_print_op_set_sheet_range     (glPrintOp         *print_op,
+                                                    gint               first_sheet,
+                                                    gint               last_sheet);
 void               gl_print_op_set_first           (glPrintOp         *print_op,
                                                     gint               first);
 void               gl_print_op_set_last            (glPrintOp         *print_op,
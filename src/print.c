@@ -72,6 +72,17 @@ static PrintInfo *print_info_new              (cairo_t          *cr,
 
 static void       print_info_free             (PrintInfo       **pi);
 
+static void       print_merge_sheet           (glLabel          *label,
+                                               cairo_t          *cr,
+                                               gint              page,
+                                               gint              n_copies,
+                                               gint              first,
+                                               gboolean          collate_flag,
+                                               gboolean          outline_flag,
+                                               gboolean          reverse_flag,
+                                               gboolean          crop_marks_flag,
+                                               const glPrintState *state);
+
 static void       print_crop_marks            (PrintInfo        *pi);
 
 static void       print_label                 (PrintInfo        *pi,
@@ -107,14 +118,14 @@ gl_print_simple_sheet (glLabel          *label,
 	PrintInfo              *pi;
 	const lglTemplateFrame *frame;
 	gint                    i_label;
-	lglTemplateOrigin      *origins;
+	const lglTemplateOrigin *origins;
 
 	gl_debug (DEBUG_PRINT, "START");
 
 	pi         = print_info_new (cr, label);
 
         frame = (lglTemplateFrame *)pi->template->frames->data;
-	origins = lgl_template_frame_get_origins (frame);
+	origins = lgl_template_frame_get_origins_const (frame);
 
         if (crop_marks_flag) {
                 print_crop_marks (pi);
@@ -128,8 +139,6 @@ gl_print_simple_sheet (glLabel          *label,
 
         }
 
-	g_free (origins);
-
 	print_info_free (&pi);
 
 	gl_debug (DEBUG_PRINT, "END");
@@ -150,79 +159,10 @@ gl_print_collated_merge_sheet   (glLabel          *label,
                                  gboolean          crop_marks_flag,
                                  glPrintState     *state)
 {
-	glMerge                   *merge;
-	const GList               *record_list;
-	PrintInfo                 *pi;
-	const lglTemplateFrame    *frame;
-	gint                       i_label, n_labels_per_page, i_copy;
-	glMergeRecord             *record;
-	GList                     *p;
-	lglTemplateOrigin         *origins;
-
 	gl_debug (DEBUG_PRINT, "START");
 
-	merge = gl_label_get_merge (label);
-	record_list = gl_merge_get_record_list (merge);
-
-	pi = print_info_new (cr, label);
-        frame = (lglTemplateFrame *)pi->template->frames->data;
-
-	n_labels_per_page = lgl_template_frame_get_n_labels (frame);
-	origins = lgl_template_frame_get_origins (frame);
-
-        if (crop_marks_flag) {
-                print_crop_marks (pi);
-        }
-
-        if (page == 0)
-        {
-                state->i_copy  = 0;
-                state->p_record = (GList *)record_list;
-
-                i_label = first - 1;
-        }
-        else
-        {
-                i_label = 0;
-        }
-
-
-	for ( p=(GList *)state->p_record; p!=NULL; p=p->next ) {
-		record = (glMergeRecord *)p->data;
-			
-		if ( record->select_flag ) {
-			for (i_copy = state->i_copy; i_copy < n_copies; i_copy++) {
-
-				print_label (pi, label,
-					     origins[i_label].x,
-					     origins[i_label].y,
-					     record,
-					     outline_flag, reverse_flag);
-
-				i_label++;
-                                if (i_label == n_labels_per_page)
-                                {
-                                        g_free (origins);
-                                        print_info_free (&pi);
-
-                                        state->i_copy = (i_copy+1) % n_copies;
-                                        if (state->i_copy == 0)
-                                        {
-                                                state->p_record = p->next;
-                                        }
-                                        else
-                                        {
-                                                state->p_record = p;
-                                        }
-                                        return;
-                                }
-			}
-                        state->i_copy = 0;
-		}
-	}
-
-        g_free (origins);
-        print_info_free (&pi);
+        print_merge_sheet (label, cr, page, n_copies, first, TRUE,
+                           outline_flag, reverse_flag, crop_marks_flag, state);
 
 	gl_debug (DEBUG_PRINT, "END");
 }
@@ -241,84 +181,223 @@ gl_print_uncollated_merge_sheet (glLabel          *label,
                                  gboolean          reverse_flag,
                                  gboolean          crop_marks_flag,
                                  glPrintState     *state)
+{
+	gl_debug (DEBUG_PRINT, "START");
+
+        print_merge_sheet (label, cr, page, n_copies, first, FALSE,
+                           outline_flag, reverse_flag, crop_marks_flag, state);
+
+	gl_debug (DEBUG_PRINT, "END");
+}
+
+
+/*****************************************************************************/
+/* Build index of selected merge records.                                    */
+/*****************************************************************************/
+void
+gl_print_state_init (glPrintState     *state,
+                     glLabel          *label)
 {
 	glMerge                   *merge;
-	const GList               *record_list;
-	PrintInfo                 *pi;
-	const lglTemplateFrame    *frame;
-	gint                       i_label, n_labels_per_page, i_copy;
+	const GList               *p;
 	glMergeRecord             *record;
-	GList                     *p;
-	lglTemplateOrigin         *origins;
+        gint                       n;
 
 	gl_debug (DEBUG_PRINT, "START");
 
+        state->records     = NULL;
+        state->n_records   = 0;
+        state->own_records = FALSE;
+
 	merge = gl_label_get_merge (label);
-	record_list = gl_merge_get_record_list (merge);
+        state->merge = merge;
+        if ( merge == NULL )
+        {
+                gl_debug (DEBUG_PRINT, "END (no merge)");
+                return;
+        }
 
-	pi = print_info_new (cr, label);
-        frame = (lglTemplateFrame *)pi->template->frames->data;
+        n = gl_merge_get_record_count (merge);
+        state->records = g_new0 (glMergeRecord *, MAX (n, 1));
 
-	n_labels_per_page = lgl_template_frame_get_n_labels (frame);
-	origins = lgl_template_frame_get_origins (frame);
+        if ( !gl_merge_has_record_list (merge) )
+        {
+                /* Indexed source: all records selected, read as they are printed. */
+                state->n_records   = n;
+                state->own_records = TRUE;
+                gl_debug (DEBUG_PRINT, "END (indexed)");
+                return;
+        }
 
-        if (crop_marks_flag) {
-                print_crop_marks (pi);
+	for ( p = gl_merge_get_record_list (merge); p != NULL; p = p->next )
+        {
+		record = (glMergeRecord *)p->data;
+
+		if ( record->select_flag )
+                {
+                        state->records[state->n_records++] = record;
+                }
+	}
+
+	gl_debug (DEBUG_PRINT, "END");
+}
+
+
+/*****************************************************************************/
+/* Free index of selected merge records.                                     */
+/*****************************************************************************/
+void
+gl_print_state_clear (glPrintState     *state)
+{
+        gint i;
+
+        if ( state->own_records )
+        {
+                for ( i = 0; i < state->n_records; i++ )
+                {
+                        if ( state->records[i] != NULL )
+                        {
+                                gl_merge_free_record (&state->records[i]);
+                        }
+                }
         }
 
-        if (page == 0)
+        g_free (state->records);
+        if ( state->merge != NULL )
         {
-                state->i_copy  = 0;
-                state->p_record = (GList *)record_list;
+                g_object_unref (state->merge);
+        }
+
+        state->merge       = NULL;
+        state->records     = NULL;
+        state->n_records   = 0;
+        state->own_records = FALSE;
+}
+
+
+/*****************************************************************************/
+/* Number of sheets needed to print all copies of all selected records.      */
+/*****************************************************************************/
+gint
+gl_print_state_get_n_sheets (const glPrintState *state,
+                             gint                n_copies,
+                             gint                first,
+                             gint                n_labels_per_page)
+{
+        gint n_slots;
+
+        g_return_val_if_fail (n_labels_per_page > 0, 1);
+
+        n_slots = (first - 1) + MAX (n_copies, 1) * state->n_records;
+
+        return MAX (1, (n_slots + n_labels_per_page - 1) / n_labels_per_page);
+}
+
+
+/*****************************************************************************/
+/* Locate the record (and copy number) printed in the given label slot of    */
+/* the given sheet.  Slots are numbered continuously across sheets, with the */
+/* first (first-1) slots of sheet 0 left blank.  Collated copies of a record */
+/* are adjacent; uncollated copies repeat the whole record sequence.         */
+/* Returns NULL if the slot is blank.                                        */
+/*****************************************************************************/
+glMergeRecord *
+gl_print_state_get_record (const glPrintState *state,
+                           gboolean            collate_flag,
+                           gint                n_copies,
+                           gint                first,
+                           gint                n_labels_per_page,
+                           gint                page,
+                           gint                i_label,
+                           gint               *i_copy)
+{
+        gint i_item;
+        gint i_record;
+
+        if ( (state->n_records == 0) || (n_copies < 1) )
+        {
+                return NULL;
+        }
+
+        i_item = page*n_labels_per_page + i_label - (first - 1);
+        if ( (i_item < 0) || (i_item >= n_copies * state->n_records) )
+        {
+                return NULL;
+        }
 
-                i_label = first - 1;
+        if ( collate_flag )
+        {
+                i_record = i_item / n_copies;
+                if ( i_copy )
+                {
+                        *i_copy = i_item % n_copies;
+                }
         }
         else
         {
-                i_label = 0;
+                i_record = i_item % state->n_records;
+                if ( i_copy )
+                {
+                        *i_copy = i_item / state->n_records;
+                }
         }
 
-	for (i_copy = state->i_copy; i_copy < n_copies; i_copy++) {
-
-		for ( p=state->p_record; p!=NULL; p=p->next ) {
-			record = (glMergeRecord *)p->data;
-			
-			if ( record->select_flag ) {
-
-                                print_label (pi, label,
-					     origins[i_label].x,
-					     origins[i_label].y,
-					     record,
-					     outline_flag, reverse_flag);
-
-				i_label++;
-                                if (i_label == n_labels_per_page)
-                                {
-                                        g_free (origins);
-                                        print_info_free (&pi);
-
-                                        state->p_record = p->next;
-                                        if (state->p_record == NULL)
-                                        {
-                                                state->p_record = (GList *)record_list;
-                                                state->i_copy = i_copy + 1;
-                                        }
-                                        else
-                                        {
-                                                state->i_copy = i_copy;
-                                        }
-                                        return;
-                                }
-			}
-		}
-                state->p_record = (GList *)record_list;
+        if ( state->own_records && (state->records[i_record] == NULL) )
+        {
+                state->records[i_record] = gl_merge_get_src_record (state->merge, i_record);
+        }
 
-	}
+        return state->records[i_record];
+}
 
-	g_free (origins);
-	print_info_free (&pi);
 
-	gl_debug (DEBUG_PRINT, "END");
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Print one sheet of a merge.                                     */
+/*---------------------------------------------------------------------------*/
+static void
+print_merge_sheet (glLabel            *label,
+                   cairo_t            *cr,
+                   gint                page,
+                   gint                n_copies,
+                   gint                first,
+                   gboolean            collate_flag,
+                   gboolean            outline_flag,
+                   gboolean            reverse_flag,
+                   gboolean            crop_marks_flag,
+                   const glPrintState *state)
+{
+	PrintInfo                 *pi;
+	const lglTemplateFrame    *frame;
+	gint                       i_label, n_labels_per_page;
+	glMergeRecord             *record;
+	const lglTemplateOrigin   *origins;
+
+	pi = print_info_new (cr, label);
+        frame = (lglTemplateFrame *)pi->template->frames->data;
+
+	n_labels_per_page = lgl_template_frame_get_n_labels (frame);
+	origins = lgl_template_frame_get_origins_const (frame);
+
+        if (crop_marks_flag) {
+                print_crop_marks (pi);
+        }
+
+        for (i_label = 0; i_label < n_labels_per_page; i_label++) {
+
+                record = gl_print_state_get_record (state, collate_flag, n_copies, first,
+                                                    n_labels_per_page, page, i_label, NULL);
+                if ( record != NULL ) {
+
+                        print_label (pi, label,
+                                     origins[i_label].x,
+                                     origins[i_label].y,
+                                     record,
+                                     outline_flag, reverse_flag);
+
+                }
+        }
+
+        print_info_free (&pi);
 }
 
 
@@ -529,6 +608,7 @@ print_label (PrintInfo     *pi,
 	}
 
         gl_label_draw (label, pi->cr, FALSE, record);
+        gl_stats_inc (GL_STATS_LABELS_DRAWN);
 
 	cairo_restore (pi->cr); /* From special transformations. */
 
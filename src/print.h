@@ -27,11 +27,42 @@
 
 G_BEGIN_DECLS
 
+/*
+ * Selected merge records, indexed so that the records on any sheet can be
+ * located directly rather than by walking the list from the first sheet.
+ * The records belong to merge, the state's own copy of the label's merge
+ * (NULL if the label has none), released by gl_print_state_clear().  If the
+ * records of merge have not been read (see gl_merge_has_record_list()),
+ * records starts out empty and is filled from the source as records are
+ * needed; these records belong to the state (own_records).
+ */
 typedef struct {
-	gint   i_copy;
-	GList *p_record;
+	glMerge        *merge;
+	glMergeRecord **records;
+	gint            n_records;
+	gboolean        own_records;
 } glPrintState;
 
+
+void           gl_print_state_init           (glPrintState       *state,
+                                              glLabel            *label);
+
+void           gl_print_state_clear          (glPrintState       *state);
+
+gint           gl_print_state_get_n_sheets   (const glPrintState *state,
+                                              gint                n_copies,
+                                              gint                first,
+                                              gint                n_labels_per_page);
+
+glMergeRecord *gl_print_state_get_record     (const glPrintState *state,
+                                              gboolean            collate_flag,
+                                              gint                n_copies,
+                                              gint                first,
+                                              gint                n_labels_per_page,
+                                              gint                page,
+                                              gint                i_label,
+                                              gint               *i_copy);
+
 void gl_print_simple_sheet           (glLabel          *label,
 				      cairo_t          *cr,
 				      gint              page,
@@ -31,20 +31,25 @@
 
 #define GLABELS_MIME_TYPE "application/x-glabels"
 
-static GtkRecentManager *model;
+static GtkRecentManager *model = NULL;
 
+static GtkRecentManager *get_model (void);
 
-/*****************************************************************************/
-/* Initialize recent files model.                                            */
-/*****************************************************************************/
-void
-gl_recent_init (void)
-{
-        gl_debug (DEBUG_RECENT, "START");
 
-        model = gtk_recent_manager_get_default ();
+/*---------------------------------------------------------------------------*/
+/* PRIVATE.  Get recent files model, creating it on first use.  The default  */
+/* manager reads the recent files list when created, so this is kept off     */
+/* the startup path.                                                         */
+/*---------------------------------------------------------------------------*/
+static GtkRecentManager *
+get_model (void)
+{
+        if ( model == NULL )
+        {
+                model = gtk_recent_manager_get_default ();
+        }
 
-        gl_debug (DEBUG_RECENT, "END");
+        return model;
 }
 
 
@@ -109,7 +114,7 @@ gl_recent_add_utf8_filename (gchar *utf8_filename)
                 if ( uri != NULL )
                 {
 
-                        gtk_recent_manager_add_full (model, uri, recent_data);
+                        gtk_recent_manager_add_full (get_model (), uri, recent_data);
                         g_free (uri);
 
                 }
@@ -136,7 +141,7 @@ gl_recent_create_menu (void)
         gl_debug (DEBUG_RECENT, "START");
 
         recent_menu  =
-                gtk_recent_chooser_menu_new_for_manager (model);
+                gtk_recent_chooser_menu_new_for_manager (get_model ());
         gtk_recent_chooser_menu_set_show_numbers (GTK_RECENT_CHOOSER_MENU (recent_menu), FALSE);
         gtk_recent_chooser_set_show_icons (GTK_RECENT_CHOOSER (recent_menu), TRUE);
         gtk_recent_chooser_set_limit (GTK_RECENT_CHOOSER (recent_menu),
@@ -25,8 +25,6 @@
 
 G_BEGIN_DECLS
 
-void       gl_recent_init              (void);
-
 gchar     *gl_recent_get_utf8_filename (GtkRecentInfo *item);
 
 void       gl_recent_add_utf8_filename (gchar         *utf8_filename);
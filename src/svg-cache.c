@@ -158,11 +158,13 @@ gl_svg_cache_get_handle (GHashTable *svg_cache,
         if (record != NULL)
         {
                 record->references++;
+                gl_stats_inc (GL_STATS_CACHE_HITS);
                 gl_debug (DEBUG_SVG_CACHE, "references=%d", record->references);
                 gl_debug (DEBUG_SVG_CACHE, "END cached");
                 return record->svg_handle;
         }
 
+        gl_stats_inc (GL_STATS_CACHE_MISSES);
 
         file = g_file_new_for_path (name);
         if ( g_file_load_contents (file, NULL, &buffer, &length, NULL, NULL) )
@@ -45,6 +45,11 @@
 /* Private types.                                                           */
 /*==========================================================================*/
 
+typedef struct {
+	GtkUIManager *ui;
+	glWindow     *window;	/* Weak pointer */
+} RecentMenuData;
+
 
 /*==========================================================================*/
 /* Local function prototypes                                                */
@@ -80,6 +85,8 @@ static void menu_item_select_cb            (GtkMenuItem     *proxy,
 static void menu_item_deselect_cb          (GtkMenuItem     *proxy,
 					    glWindow        *window);
 
+static gboolean add_recent_menu_idle_cb    (RecentMenuData  *data);
+
 
 /*==========================================================================*/
 /* Private globals                                                          */
@@ -758,7 +765,7 @@ gl_ui_new (glWindow *window)
 	GtkUIManager            *ui;
 	GtkActionGroup          *actions;
 	GError                  *error = NULL;
-	GtkWidget               *recent_menu;
+	RecentMenuData          *recent_data;
 
 	gl_debug (DEBUG_UI, "START");
 
@@ -799,12 +806,12 @@ gl_ui_new (glWindow *window)
 	/* Set view grid and markup visibility according to prefs */
 	set_view_style (ui);
 		
-	/* add an Open Recents Submenu */
-        recent_menu  = gl_recent_create_menu ();
-	g_signal_connect (G_OBJECT (recent_menu), "item-activated",
-			  G_CALLBACK (gl_ui_cmd_file_open_recent), window);
-	gtk_menu_item_set_submenu (GTK_MENU_ITEM (gtk_ui_manager_get_widget (ui, "/MenuBar/FileMenu/FileRecentsMenu")),
-				   recent_menu);
+	/* add an Open Recents Submenu, once the window is up */
+	recent_data = g_new0 (RecentMenuData, 1);
+	recent_data->ui     = g_object_ref (ui);
+	recent_data->window = window;
+	g_object_add_weak_pointer (G_OBJECT (window), (gpointer *)&recent_data->window);
+	g_idle_add_full (G_PRIORITY_LOW, (GSourceFunc)add_recent_menu_idle_cb, recent_data, NULL);
 
 
         set_additional_properties (ui);
@@ -1255,6 +1262,39 @@ menu_item_deselect_cb (GtkMenuItem *proxy,
 }
 
 
+/*---------------------------------------------------------------------------*/
+/** PRIVATE.  Add Open Recents submenu.                                      */
+/*                                                                           */
+/* Building the menu loads the recent files list, so it is deferred until   */
+/* the window has been drawn.                                                */
+/*---------------------------------------------------------------------------*/
+static gboolean
+add_recent_menu_idle_cb (RecentMenuData *data)
+{
+	GtkWidget *recent_menu;
+
+	gl_debug (DEBUG_UI, "START");
+
+	if (data->window) {
+
+		recent_menu  = gl_recent_create_menu ();
+		g_signal_connect (G_OBJECT (recent_menu), "item-activated",
+				  G_CALLBACK (gl_ui_cmd_file_open_recent), data->window);
+		gtk_menu_item_set_submenu (GTK_MENU_ITEM (gtk_ui_manager_get_widget (data->ui, "/MenuBar/FileMenu/FileRecentsMenu")),
+					   recent_menu);
+
+		g_object_remove_weak_pointer (G_OBJECT (data->window), (gpointer *)&data->window);
+	}
+
+	g_object_unref (data->ui);
+	g_free (data);
+
+	gl_debug (DEBUG_UI, "END");
+
+	return FALSE;
+}
+
+
 
 /*
  * Local Variables:       -- emacs
@@ -65,6 +65,9 @@
 #define OUTLINE_WIDTH_PIXELS      1.0
 #define SELECT_LINE_WIDTH_PIXELS  3.0
 
+/* Room around an updated region for outlines and selection handles. */
+#define UPDATE_MARGIN_PIXELS      6
+
 #define ZOOMTOFIT_PAD   16
 
 #define SHADOW_OFFSET_PIXELS (ZOOMTOFIT_PAD/4)
@@ -517,15 +520,16 @@ gl_view_update_region (glView        *view,
                        cairo_t       *cr,
                        glLabelRegion *region)
 {
-        GdkWindow    *window;
+        GdkWindow    *bin_window;
 	GdkRectangle  rect;
         gdouble       x, y, w, h;
 
 	gl_debug (DEBUG_VIEW, "START");
 
-	window = gtk_widget_get_window (GTK_WIDGET (view->canvas));
+	if (!gtk_widget_get_realized (view->canvas)) return;
 
-	if (!window) return;
+        /* cr draws on the bin window, so its device space is the bin window's. */
+	bin_window = gtk_layout_get_bin_window (GTK_LAYOUT (view->canvas));
 
         x = MIN (region->x1, region->x2);
         y = MIN (region->y1, region->y2);
@@ -535,12 +539,12 @@ gl_view_update_region (glView        *view,
         cairo_user_to_device (cr, &x, &y);
         cairo_user_to_device_distance (cr, &w, &h);
 
-        rect.x      = x - 3;
-        rect.y      = y - 3;
-        rect.width  = w + 6;
-        rect.height = h + 6;
+        rect.x      = x - UPDATE_MARGIN_PIXELS;
+        rect.y      = y - UPDATE_MARGIN_PIXELS;
+        rect.width  = w + 2*UPDATE_MARGIN_PIXELS;
+        rect.height = h + 2*UPDATE_MARGIN_PIXELS;
 
-        gdk_window_invalidate_rect (window, &rect, TRUE);
+        gdk_window_invalidate_rect (bin_window, &rect, TRUE);
 
 	gl_debug (DEBUG_VIEW, "END");
 }
@@ -664,10 +668,34 @@ screen_changed_cb (glView *view)
 static void
 label_changed_cb (glView  *view)
 {
+        glLabelRegion  region;
+        GdkWindow     *bin_window;
+        cairo_t       *cr;
+        gdouble        scale;
+
 	g_return_if_fail (view && GL_IS_VIEW (view));
 
 	gl_debug (DEBUG_VIEW, "START");
 
+        /* Batch updates tell us exactly which part of the label changed. */
+        if ( gl_label_get_changed_region (view->label, &region) &&
+             gtk_widget_get_realized (view->canvas) )
+        {
+                bin_window = gtk_layout_get_bin_window (GTK_LAYOUT (view->canvas));
+                cr = gdk_cairo_create (bin_window);
+
+                scale = view->zoom * view->home_scale;
+                cairo_scale (cr, scale, scale);
+                cairo_translate (cr, view->x0, view->y0);
+
+                gl_view_update_region (view, cr, &region);
+
+                cairo_destroy (cr);
+
+                gl_debug (DEBUG_VIEW, "END");
+                return;
+        }
+
         gl_view_update (view);
 
 	gl_debug (DEBUG_VIEW, "END");
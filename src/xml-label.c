@@ -24,9 +24,11 @@
 
 #include <glib/gi18n.h>
 #include <glib.h>
+#include <string.h>
 #include <libxml/tree.h>
 #include <libxml/parser.h>
 #include <libxml/xinclude.h>
+#include <libxml/xmlwriter.h>
 #include <gdk-pixbuf/gdk-pixdata.h>
 
 #include <libglabels.h>
@@ -59,6 +61,27 @@
 /* Private types.                                         */
 /*========================================================*/
 
+typedef struct {
+	glLabel                *label;        /* Label actually serialized */
+	glLabel                *live_label;   /* Label being saved */
+
+	lglUnits                units;
+	gint                    compression;
+	gboolean                rotate_flag;
+	xmlDocPtr               template_doc;
+	gchar                  *merge_type;
+	gchar                  *merge_src;
+
+	gchar                  *utf8_filename;
+	gchar                  *filename;
+
+	gulong                  changed_handler_id;
+	gboolean                live_changed_flag;
+
+	glXMLLabelSaveCallback  callback;
+	gpointer                user_data;
+} SaveData;
+
 
 /*========================================================*/
 /* Private globals.                                       */
@@ -117,67 +140,111 @@ static void           xml_parse_affine_attrs   (xmlNodePtr        node,
 static void           xml_parse_shadow_attrs   (xmlNodePtr        node,
 						glLabelObject    *object);
 
-static xmlDocPtr      xml_label_to_doc         (glLabel          *label,
-						glXMLLabelStatus *status);
+static SaveData      *save_data_new            (glLabel          *label,
+						const gchar      *utf8_filename,
+						gboolean          snapshot_flag);
 
-static void           xml_create_objects       (xmlNodePtr        parent,
-						xmlNsPtr          ns,
-						glLabel          *label);
+static void           save_data_free           (SaveData         *data);
+
+static void           save_label_changed_cb    (glLabel          *label,
+						SaveData         *data);
 
-static void           xml_create_object_text   (xmlNodePtr        parent,
-						xmlNsPtr          ns,
+static void           save_async_thread_func   (GTask            *task,
+						gpointer          source_object,
+						gpointer          task_data,
+						GCancellable     *cancellable);
+
+static void           save_async_done_cb       (GObject          *source_object,
+						GAsyncResult     *result,
+						SaveData         *data);
+
+static glXMLLabelStatus xml_label_write_file   (SaveData         *data);
+
+static glXMLLabelStatus xml_label_write        (xmlTextWriterPtr  writer,
+						SaveData         *data);
+
+static void           xml_write_node           (xmlTextWriterPtr  writer,
+						xmlNodePtr        node);
+
+static void           xml_write_objects        (xmlTextWriterPtr  writer,
+						SaveData         *data);
+
+static void           xml_write_object_text    (xmlTextWriterPtr  writer,
+						SaveData         *data,
 						glLabelObject    *object);
 
-static void           xml_create_object_box    (xmlNodePtr        parent,
-						xmlNsPtr          ns,
+static void           xml_write_object_box     (xmlTextWriterPtr  writer,
+						SaveData         *data,
 						glLabelObject    *object);
 
-static void           xml_create_object_line   (xmlNodePtr        parent,
-						xmlNsPtr          ns,
+static void           xml_write_object_line    (xmlTextWriterPtr  writer,
+						SaveData         *data,
 						glLabelObject    *object);
 
-static void           xml_create_object_ellipse(xmlNodePtr        parent,
-						xmlNsPtr          ns,
+static void           xml_write_object_ellipse (xmlTextWriterPtr  writer,
+						SaveData         *data,
 						glLabelObject    *object);
 
-static void           xml_create_object_image  (xmlNodePtr        parent,
-						xmlNsPtr          ns,
+static void           xml_write_object_image   (xmlTextWriterPtr  writer,
+						SaveData         *data,
 						glLabelObject    *object);
 
-static void           xml_create_object_barcode(xmlNodePtr        parent,
-						xmlNsPtr          ns,
+static void           xml_write_object_barcode (xmlTextWriterPtr  writer,
+						SaveData         *data,
 						glLabelObject    *object);
 
-static void           xml_create_merge_fields  (xmlNodePtr        parent,
-						xmlNsPtr          ns,
-						glLabel          *label);
+static void           xml_write_merge_fields   (xmlTextWriterPtr  writer,
+						SaveData         *data);
 
-static void           xml_create_data          (xmlDocPtr         doc,
-                                                xmlNodePtr        parent,
-						xmlNsPtr          ns,
-						glLabel          *label);
+static void           xml_write_data           (xmlTextWriterPtr  writer,
+						SaveData         *data);
 
-static void           xml_create_pixdata       (xmlNodePtr        parent,
-						xmlNsPtr          ns,
-						glLabel          *label,
+static void           xml_write_pixdata        (xmlTextWriterPtr  writer,
+						SaveData         *data,
 						gchar            *name);
 
-static void           xml_create_file_svg      (xmlDocPtr         doc,
-                                                xmlNodePtr        parent,
-						xmlNsPtr          ns,
-						glLabel          *label,
+static void           xml_write_pixdata_base64 (xmlTextWriterPtr  writer,
+						GdkPixbuf        *pixbuf);
+
+static void           xml_write_file_svg       (xmlTextWriterPtr  writer,
+						SaveData         *data,
 						gchar            *name);
 
-static void           xml_create_toplevel_span (xmlNodePtr        node,
-						xmlNsPtr          ns,
+static void           xml_write_toplevel_span  (xmlTextWriterPtr  writer,
 						glLabelText      *object_text);
 
-static void           xml_create_affine_attrs  (xmlNodePtr        node,
+static void           xml_write_affine_attrs   (xmlTextWriterPtr  writer,
 						glLabelObject    *object);
 
-static void           xml_create_shadow_attrs  (xmlNodePtr        node,
+static void           xml_write_shadow_attrs   (xmlTextWriterPtr  writer,
+						SaveData         *data,
 						glLabelObject    *object);
 
+static void           xml_write_prop_string    (xmlTextWriterPtr  writer,
+						const gchar      *property,
+						const gchar      *val);
+
+static void           xml_write_prop_double    (xmlTextWriterPtr  writer,
+						const gchar      *property,
+						gdouble           val);
+
+static void           xml_write_prop_boolean   (xmlTextWriterPtr  writer,
+						const gchar      *property,
+						gboolean          val);
+
+static void           xml_write_prop_int       (xmlTextWriterPtr  writer,
+						const gchar      *property,
+						gint              val);
+
+static void           xml_write_prop_uint_hex  (xmlTextWriterPtr  writer,
+						const gchar      *property,
+						guint             val);
+
+static void           xml_write_prop_length    (xmlTextWriterPtr  writer,
+						SaveData         *data,
+						const gchar      *property,
+						gdouble           val);
+
 
 /****************************************************************************/
 /* Open and read label from xml file.                                       */
@@ -1154,42 +1221,39 @@ xml_parse_shadow_attrs (xmlNodePtr        node,
 
 
 /****************************************************************************/
-/* Save label to xml label file.                                            */
+/* Save label to xml label file from a worker thread.                       */
+/*                                                                          */
+/* The label is copied on the calling (main) thread, so it may continue to  */
+/* be edited while the copy is written.  The callback is invoked on the     */
+/* main thread once the file is complete.                                   */
 /****************************************************************************/
 void
-gl_xml_label_save (glLabel          *label,
-		   const gchar      *utf8_filename,
-		   glXMLLabelStatus *status)
+gl_xml_label_save_async (glLabel                *label,
+			 const gchar            *utf8_filename,
+			 glXMLLabelSaveCallback  callback,
+			 gpointer                user_data)
 {
-	xmlDocPtr doc;
-	gint      xml_ret;
-	gchar 	  *filename;
+	SaveData *data;
+	GTask    *task;
 
 	gl_debug (DEBUG_XML, "START");
 
-	doc = xml_label_to_doc (label, status);
-
-	filename = g_filename_from_utf8 (utf8_filename, -1, NULL, NULL, NULL);
-	if (!filename)
-		g_message ("Utf8 conversion error.");
-	else {
-		xmlSetDocCompressMode (doc, gl_label_get_compression (label));
-		xml_ret = xmlSaveFormatFile (filename, doc, TRUE);
-		xmlFreeDoc (doc);
-		if (xml_ret == -1) {
-
-			g_message ("Problem saving xml file.");
-			*status = XML_LABEL_ERROR_SAVE_FILE;
-
-		} else {
+	data = save_data_new (label, utf8_filename, TRUE);
+	data->callback  = callback;
+	data->user_data = user_data;
 
-			gl_label_set_filename (label, utf8_filename);
-			gl_label_clear_modified (label);
+	task = g_task_new (NULL, NULL, (GAsyncReadyCallback)save_async_done_cb, data);
+	g_task_set_task_data (task, data, NULL);
 
-		}
-		g_free (filename);
+	if (!data->filename) {
+		g_message ("Utf8 conversion error.");
+		g_task_return_int (task, XML_LABEL_ERROR_SAVE_FILE);
+	} else {
+		g_task_run_in_thread (task, save_async_thread_func);
 	}
 
+	g_object_unref (task);
+
 	gl_debug (DEBUG_XML, "END");
 }
 
@@ -1201,130 +1265,351 @@ gchar *
 gl_xml_label_save_buffer (glLabel          *label,
 			  glXMLLabelStatus *status)
 {
-	xmlDocPtr  doc;
-	gint       size;
-	guchar    *buffer;
+	SaveData         *data;
+	xmlBufferPtr      buffer;
+	xmlTextWriterPtr  writer;
+	gchar            *string = NULL;
 
 	gl_debug (DEBUG_XML, "START");
 
-	doc = xml_label_to_doc (label, status);
+	data = save_data_new (label, NULL, FALSE);
 
-	xmlDocDumpMemory (doc, &buffer, &size);
-	xmlFreeDoc (doc);
+	buffer = xmlBufferCreate ();
+	writer = xmlNewTextWriterMemory (buffer, 0);
+
+	*status = xml_label_write (writer, data);
+	xmlFreeTextWriter (writer);
+
+	if (*status == XML_LABEL_OK) {
+		string = g_strndup ((gchar *)xmlBufferContent (buffer),
+				    xmlBufferLength (buffer));
+	}
+	xmlBufferFree (buffer);
+
+	save_data_free (data);
 
 	gl_label_clear_modified (label);
 
 	gl_debug (DEBUG_XML, "END");
 
-	return (gchar *)buffer;
+	return string;
 }
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Convert label to xml doc structure.                            */
+/* PRIVATE.  Gather what is needed to serialize label.                      */
+/*                                                                          */
+/* Everything that depends on global state (preferences, default units,     */
+/* merge and template) is resolved here, on the calling thread.  If         */
+/* snapshot_flag is set, the objects are duplicated into a private label    */
+/* so that the writer never touches the live document.                     */
 /*--------------------------------------------------------------------------*/
-static xmlDocPtr
-xml_label_to_doc (glLabel          *label,
-		  glXMLLabelStatus *status)
+static SaveData *
+save_data_new (glLabel     *label,
+	       const gchar *utf8_filename,
+	       gboolean     snapshot_flag)
 {
-        lglUnits           units;
-	xmlDocPtr          doc;
-	xmlNsPtr           ns;
+	SaveData          *data;
         const lglTemplate *template;
 	glMerge           *merge;
-
-	gl_debug (DEBUG_XML, "START");
+	xmlNsPtr           ns;
+	const GList       *p;
+	glLabelObject     *object;
 
 	LIBXML_TEST_VERSION;
 
-        units = gl_prefs_model_get_units (gl_prefs);
-        lgl_xml_set_default_units (units);
+	data = g_new0 (SaveData, 1);
 
-	doc = xmlNewDoc ((xmlChar *)"1.0");
-	doc->xmlRootNode = xmlNewDocNode (doc, NULL, (xmlChar *)"Glabels-document", NULL);
+	data->live_label  = g_object_ref (label);
+	data->units       = gl_prefs_model_get_units (gl_prefs);
+	data->compression = gl_label_get_compression (label);
+	data->rotate_flag = gl_label_get_rotate_flag (label);
 
-	ns = xmlNewNs (doc->xmlRootNode, (xmlChar *)LGL_XML_NAME_SPACE, NULL);
-	xmlSetNs (doc->xmlRootNode, ns);
+	if (utf8_filename) {
+		data->utf8_filename = g_strdup (utf8_filename);
+		data->filename = g_filename_from_utf8 (utf8_filename, -1, NULL, NULL, NULL);
+	}
 
+	/* The template is small; build its node with the common template
+	 * writer and copy it to the output stream later. */
+        lgl_xml_set_default_units (data->units);
+	data->template_doc = xmlNewDoc ((xmlChar *)"1.0");
+	data->template_doc->xmlRootNode = xmlNewDocNode (data->template_doc, NULL,
+							 (xmlChar *)"Glabels-document", NULL);
+	ns = xmlNewNs (data->template_doc->xmlRootNode, (xmlChar *)LGL_XML_NAME_SPACE, NULL);
+	xmlSetNs (data->template_doc->xmlRootNode, ns);
         template = gl_label_get_template (label);
-	lgl_xml_template_create_template_node (template, doc->xmlRootNode, ns);
-
-	xml_create_objects (doc->xmlRootNode, ns, label);
+	lgl_xml_template_create_template_node (template, data->template_doc->xmlRootNode, ns);
 
 	merge = gl_label_get_merge (label);
 	gl_debug (DEBUG_XML, "merge=%p", merge);
 	if (merge != NULL) {
-		xml_create_merge_fields (doc->xmlRootNode, ns, label);
+		data->merge_type = gl_merge_get_name (merge);
+		data->merge_src  = gl_merge_get_src (merge);
 		g_object_unref (G_OBJECT(merge));
 	}
 
-	xml_create_data (doc, doc->xmlRootNode, ns, label);
+	if (snapshot_flag) {
+
+		data->label = GL_LABEL (gl_label_new ());
+
+		for (p = gl_label_get_object_list (label); p != NULL; p = p->next) {
+			object = GL_LABEL_OBJECT (p->data);
+			gl_label_add_object (data->label, gl_label_object_dup (object, data->label));
+		}
+
+		data->changed_handler_id =
+			g_signal_connect (G_OBJECT (label), "changed",
+					  G_CALLBACK (save_label_changed_cb), data);
+
+	} else {
+
+		data->label = g_object_ref (label);
+
+	}
+
+	return data;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Free save data.  Must be called from main thread.              */
+/*--------------------------------------------------------------------------*/
+static void
+save_data_free (SaveData *data)
+{
+	if (data->changed_handler_id) {
+		g_signal_handler_disconnect (G_OBJECT (data->live_label),
+					     data->changed_handler_id);
+	}
+
+	g_object_unref (G_OBJECT (data->label));
+	g_object_unref (G_OBJECT (data->live_label));
+
+	xmlFreeDoc (data->template_doc);
+	g_free (data->merge_type);
+	g_free (data->merge_src);
+	g_free (data->utf8_filename);
+	g_free (data->filename);
+
+	g_free (data);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Live label changed while its snapshot is being saved.          */
+/*--------------------------------------------------------------------------*/
+static void
+save_label_changed_cb (glLabel  *label,
+		       SaveData *data)
+{
+	data->live_changed_flag = TRUE;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Worker thread body for gl_xml_label_save_async().              */
+/*--------------------------------------------------------------------------*/
+static void
+save_async_thread_func (GTask        *task,
+			gpointer      source_object,
+			gpointer      task_data,
+			GCancellable *cancellable)
+{
+	SaveData *data = task_data;
+
+	g_task_return_int (task, xml_label_write_file (data));
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Back on main thread after gl_xml_label_save_async().           */
+/*--------------------------------------------------------------------------*/
+static void
+save_async_done_cb (GObject      *source_object,
+		    GAsyncResult *result,
+		    SaveData     *data)
+{
+	glXMLLabelStatus status;
+
+	gl_debug (DEBUG_XML, "START");
+
+	status = g_task_propagate_int (G_TASK (result), NULL);
+
+	if (status == XML_LABEL_OK) {
+
+		gl_label_set_filename (data->live_label, data->utf8_filename);
+
+		/* Edits made during the save are not in the file. */
+		if (!data->live_changed_flag) {
+			gl_label_clear_modified (data->live_label);
+		}
+
+	}
+
+	if (data->callback) {
+		data->callback (data->live_label, status, data->user_data);
+	}
+
+	save_data_free (data);
 
 	gl_debug (DEBUG_XML, "END");
+}
 
-	*status = XML_LABEL_OK;
-	return doc;
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Write label to its (optionally compressed) file.               */
+/*--------------------------------------------------------------------------*/
+static glXMLLabelStatus
+xml_label_write_file (SaveData *data)
+{
+	xmlTextWriterPtr  writer;
+	glXMLLabelStatus  status;
+
+	writer = xmlNewTextWriterFilename (data->filename, data->compression);
+	if (writer == NULL) {
+		g_message ("Problem saving xml file.");
+		return XML_LABEL_ERROR_SAVE_FILE;
+	}
+
+	status = xml_label_write (writer, data);
+	xmlFreeTextWriter (writer);
+
+	if (status != XML_LABEL_OK) {
+		g_message ("Problem saving xml file.");
+	}
+
+	return status;
 }
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Add XML Objects Node                                           */
+/* PRIVATE.  Stream label document to xml writer.                           */
+/*--------------------------------------------------------------------------*/
+static glXMLLabelStatus
+xml_label_write (xmlTextWriterPtr  writer,
+		 SaveData         *data)
+{
+	gl_debug (DEBUG_XML, "START");
+
+	xmlTextWriterSetIndent (writer, TRUE);
+	xmlTextWriterSetIndentString (writer, (xmlChar *)"  ");
+
+	xmlTextWriterStartDocument (writer, "1.0", NULL, NULL);
+	xmlTextWriterStartElementNS (writer, NULL, (xmlChar *)"Glabels-document",
+				     (xmlChar *)LGL_XML_NAME_SPACE);
+
+	xml_write_node (writer, data->template_doc->xmlRootNode->children);
+
+	xml_write_objects (writer, data);
+
+	if (data->merge_type != NULL) {
+		xml_write_merge_fields (writer, data);
+	}
+
+	xml_write_data (writer, data);
+
+	xmlTextWriterEndElement (writer);
+
+	/* Output errors are sticky, so checking the final writes is enough. */
+	if ( (xmlTextWriterEndDocument (writer) < 0) ||
+	     (xmlTextWriterFlush (writer) < 0) ) {
+		gl_debug (DEBUG_XML, "END -- write error");
+		return XML_LABEL_ERROR_SAVE_FILE;
+	}
+
+	gl_debug (DEBUG_XML, "END");
+
+	return XML_LABEL_OK;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Copy a prebuilt element node (attributes only) to writer.      */
+/*--------------------------------------------------------------------------*/
+static void
+xml_write_node (xmlTextWriterPtr  writer,
+		xmlNodePtr        node)
+{
+	xmlNodePtr  child;
+	xmlAttrPtr  attr;
+	xmlChar    *value;
+
+	for (; node != NULL; node = node->next) {
+
+		if (node->type != XML_ELEMENT_NODE) continue;
+
+		xmlTextWriterStartElement (writer, node->name);
+
+		for (attr = node->properties; attr != NULL; attr = attr->next) {
+			value = xmlNodeGetContent ((xmlNodePtr)attr);
+			xmlTextWriterWriteAttribute (writer, attr->name, value);
+			xmlFree (value);
+		}
+
+		child = node->children;
+		xml_write_node (writer, child);
+
+		xmlTextWriterEndElement (writer);
+	}
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Write Objects Node                                             */
 /*--------------------------------------------------------------------------*/
 static void
-xml_create_objects (xmlNodePtr  parent,
-		    xmlNsPtr    ns,
-		    glLabel    *label)
+xml_write_objects (xmlTextWriterPtr  writer,
+		   SaveData         *data)
 {
-	xmlNodePtr     node;
-        gboolean       rotate_flag;
         const GList   *object_list;
 	GList         *p;
 	glLabelObject *object;
 
 	gl_debug (DEBUG_XML, "START");
 
-        rotate_flag = gl_label_get_rotate_flag (label);
-        object_list = gl_label_get_object_list (label);
+        object_list = gl_label_get_object_list (data->label);
 
-	node = xmlNewChild (parent, ns, (xmlChar *)"Objects", NULL);
-	lgl_xml_set_prop_string (node, "id", "0");
-	lgl_xml_set_prop_boolean (node, "rotate", rotate_flag);
+	xmlTextWriterStartElement (writer, (xmlChar *)"Objects");
+	xml_write_prop_string (writer, "id", "0");
+	xml_write_prop_boolean (writer, "rotate", data->rotate_flag);
 
 	for (p = (GList *)object_list; p != NULL; p = p->next) {
 
 		object = GL_LABEL_OBJECT(p->data);
 
 		if ( GL_IS_LABEL_TEXT(object) ) {
-			xml_create_object_text (node, ns, object);
+			xml_write_object_text (writer, data, object);
 		} else if ( GL_IS_LABEL_BOX(object) ) {
-			xml_create_object_box (node, ns, object);
+			xml_write_object_box (writer, data, object);
 		} else if ( GL_IS_LABEL_ELLIPSE(object) ) {
-			xml_create_object_ellipse (node, ns, object);
+			xml_write_object_ellipse (writer, data, object);
 		} else if ( GL_IS_LABEL_LINE(object) ) {
-			xml_create_object_line (node, ns, object);
+			xml_write_object_line (writer, data, object);
 		} else if ( GL_IS_LABEL_IMAGE(object) ) {
-			xml_create_object_image (node, ns, object);
+			xml_write_object_image (writer, data, object);
 		} else if ( GL_IS_LABEL_BARCODE(object) ) {
-			xml_create_object_barcode (node, ns, object);
+			xml_write_object_barcode (writer, data, object);
 		} else {
 			g_message ("Unknown label object");
 		}
 
 	}
 
+	xmlTextWriterEndElement (writer);
+
 	gl_debug (DEBUG_XML, "END");
 }
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Add XML Objects->Object-text Node                              */
+/* PRIVATE.  Write Objects->Object-text Node                                */
 /*--------------------------------------------------------------------------*/
 static void
-xml_create_object_text (xmlNodePtr     parent,
-			xmlNsPtr       ns,
-			glLabelObject *object)
+xml_write_object_text (xmlTextWriterPtr  writer,
+		       SaveData         *data,
+		       glLabelObject    *object)
 {
-	xmlNodePtr        node;
 	gdouble           x, y;
 	gdouble           w, h;
 	PangoAlignment    align;
@@ -1333,84 +1618,85 @@ xml_create_object_text (xmlNodePtr     parent,
 
 	gl_debug (DEBUG_XML, "START");
 
-	node = xmlNewChild (parent, ns, (xmlChar *)"Object-text", NULL);
+	xmlTextWriterStartElement (writer, (xmlChar *)"Object-text");
 
 	/* position attrs */
 	gl_label_object_get_position (object, &x, &y);
-	lgl_xml_set_prop_length (node, "x", x);
-	lgl_xml_set_prop_length (node, "y", y);
+	xml_write_prop_length (writer, data, "x", x);
+	xml_write_prop_length (writer, data, "y", y);
 
 	/* size attrs */
 	gl_label_object_get_raw_size ( object, &w, &h);
-	lgl_xml_set_prop_length (node, "w", w);
-	lgl_xml_set_prop_length (node, "h", h);
+	xml_write_prop_length (writer, data, "w", w);
+	xml_write_prop_length (writer, data, "h", h);
 
 	/* justify attr */
 	align = gl_label_object_get_text_alignment (object);
-	lgl_xml_set_prop_string (node, "justify", gl_str_util_align_to_string (align));
+	xml_write_prop_string (writer, "justify", gl_str_util_align_to_string (align));
 
 	/* valign attr */
 	valign = gl_label_object_get_text_valignment (object);
-	lgl_xml_set_prop_string (node, "valign", gl_str_util_valign_to_string (valign));
+	xml_write_prop_string (writer, "valign", gl_str_util_valign_to_string (valign));
 
 	/* auto_shrink attr */
 	auto_shrink = gl_label_text_get_auto_shrink (GL_LABEL_TEXT (object));
-	lgl_xml_set_prop_boolean (node, "auto_shrink", auto_shrink);
+	xml_write_prop_boolean (writer, "auto_shrink", auto_shrink);
 
 	/* affine attrs */
-	xml_create_affine_attrs (node, object);
+	xml_write_affine_attrs (writer, object);
 
 	/* shadow attrs */
-	xml_create_shadow_attrs (node, object);
+	xml_write_shadow_attrs (writer, data, object);
 
 	/* Add children */
-	xml_create_toplevel_span (node, ns, GL_LABEL_TEXT(object));
+	xml_write_toplevel_span (writer, GL_LABEL_TEXT(object));
+
+	xmlTextWriterEndElement (writer);
 
 	gl_debug (DEBUG_XML, "END");
 }
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Add XML Objects->Object-box Node                               */
+/* PRIVATE.  Write Objects->Object-box Node                                 */
 /*--------------------------------------------------------------------------*/
 static void
-xml_create_object_box (xmlNodePtr     parent,
-		       xmlNsPtr       ns,
-		       glLabelObject *object)
+xml_write_object_box (xmlTextWriterPtr  writer,
+		      SaveData         *data,
+		      glLabelObject    *object)
 {
-	xmlNodePtr        node;
 	gdouble           x, y;
 	gdouble           w, h;
 	gdouble           line_width;
 	glColorNode      *line_color_node;
-	glColorNode *fill_color_node;
+	glColorNode      *fill_color_node;
 
 	gl_debug (DEBUG_XML, "START");
 
-	node = xmlNewChild (parent, ns, (xmlChar *)"Object-box", NULL);
+	xmlTextWriterStartElement (writer, (xmlChar *)"Object-box");
 
 	/* position attrs */
 	gl_label_object_get_position (object, &x, &y);
-	lgl_xml_set_prop_length (node, "x", x);
-	lgl_xml_set_prop_length (node, "y", y);
+	xml_write_prop_length (writer, data, "x", x);
+	xml_write_prop_length (writer, data, "y", y);
 
 	/* size attrs */
 	gl_label_object_get_size (object, &w, &h);
-	lgl_xml_set_prop_length (node, "w", w);
-	lgl_xml_set_prop_length (node, "h", h);
+	xml_write_prop_length (writer, data, "w", w);
+	xml_write_prop_length (writer, data, "h", h);
 
 	/* line attrs */
 	line_width = gl_label_object_get_line_width (GL_LABEL_OBJECT(object));
-	lgl_xml_set_prop_length (node, "line_width", line_width);
-	
+	xml_write_prop_length (writer, data, "line_width", line_width);
+
 	line_color_node = gl_label_object_get_line_color (GL_LABEL_OBJECT(object));
 	if (line_color_node->field_flag)
 	{
-		lgl_xml_set_prop_string (node, "line_color_field", line_color_node->key);
+		xml_write_prop_string (writer, "line_color_field", line_color_node->key);
 	}
 	else
 	{
-		lgl_xml_set_prop_uint_hex (node, "line_color", line_color_node->color);
+		xml_write_prop_uint_hex (writer, "line_color", line_color_node->color);
 	}
 	gl_color_node_free (&line_color_node);
 
@@ -1418,65 +1704,66 @@ xml_create_object_box (xmlNodePtr     parent,
 	fill_color_node = gl_label_object_get_fill_color (GL_LABEL_OBJECT(object));
 	if (fill_color_node->field_flag)
 	{
-		lgl_xml_set_prop_string (node, "fill_color_field", fill_color_node->key);
+		xml_write_prop_string (writer, "fill_color_field", fill_color_node->key);
 	}
 	else
 	{
-		lgl_xml_set_prop_uint_hex (node, "fill_color", fill_color_node->color);
+		xml_write_prop_uint_hex (writer, "fill_color", fill_color_node->color);
 	}
 	gl_color_node_free (&fill_color_node);
 
 	/* affine attrs */
-	xml_create_affine_attrs (node, object);
+	xml_write_affine_attrs (writer, object);
 
 	/* shadow attrs */
-	xml_create_shadow_attrs (node, object);
+	xml_write_shadow_attrs (writer, data, object);
+
+	xmlTextWriterEndElement (writer);
 
 	gl_debug (DEBUG_XML, "END");
 }
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Add XML Objects->Object-ellipse Node                           */
+/* PRIVATE.  Write Objects->Object-ellipse Node                             */
 /*--------------------------------------------------------------------------*/
 static void
-xml_create_object_ellipse (xmlNodePtr     parent,
-			   xmlNsPtr       ns,
-			   glLabelObject *object)
+xml_write_object_ellipse (xmlTextWriterPtr  writer,
+			  SaveData         *data,
+			  glLabelObject    *object)
 {
-	xmlNodePtr        node;
 	gdouble           x, y;
 	gdouble           w, h;
 	gdouble           line_width;
 	glColorNode      *line_color_node;
-	glColorNode *fill_color_node;
+	glColorNode      *fill_color_node;
 
 	gl_debug (DEBUG_XML, "START");
 
-	node = xmlNewChild (parent, ns, (xmlChar *)"Object-ellipse", NULL);
+	xmlTextWriterStartElement (writer, (xmlChar *)"Object-ellipse");
 
 	/* position attrs */
 	gl_label_object_get_position (object, &x, &y);
-	lgl_xml_set_prop_length (node, "x", x);
-	lgl_xml_set_prop_length (node, "y", y);
+	xml_write_prop_length (writer, data, "x", x);
+	xml_write_prop_length (writer, data, "y", y);
 
 	/* size attrs */
 	gl_label_object_get_size (object, &w, &h);
-	lgl_xml_set_prop_length (node, "w", w);
-	lgl_xml_set_prop_length (node, "h", h);
+	xml_write_prop_length (writer, data, "w", w);
+	xml_write_prop_length (writer, data, "h", h);
 
 	/* line attrs */
 	line_width = gl_label_object_get_line_width (GL_LABEL_OBJECT(object));
-	lgl_xml_set_prop_length (node, "line_width", line_width);
-	
+	xml_write_prop_length (writer, data, "line_width", line_width);
+
 	line_color_node = gl_label_object_get_line_color (GL_LABEL_OBJECT(object));
 	if (line_color_node->field_flag)
 	{
-		lgl_xml_set_prop_string (node, "line_color_field", line_color_node->key);
+		xml_write_prop_string (writer, "line_color_field", line_color_node->key);
 	}
 	else
 	{
-		lgl_xml_set_prop_uint_hex (node, "line_color", line_color_node->color);
+		xml_write_prop_uint_hex (writer, "line_color", line_color_node->color);
 	}
 	gl_color_node_free (&line_color_node);
 
@@ -1485,33 +1772,34 @@ xml_create_object_ellipse (xmlNodePtr     parent,
 	fill_color_node = gl_label_object_get_fill_color (GL_LABEL_OBJECT(object));
 	if (fill_color_node->field_flag)
 	{
-		lgl_xml_set_prop_string (node, "fill_color_field", fill_color_node->key);
+		xml_write_prop_string (writer, "fill_color_field", fill_color_node->key);
 	}
 	else
 	{
-		lgl_xml_set_prop_uint_hex (node, "fill_color", fill_color_node->color);
+		xml_write_prop_uint_hex (writer, "fill_color", fill_color_node->color);
 	}
 	gl_color_node_free (&fill_color_node);
 
 	/* affine attrs */
-	xml_create_affine_attrs (node, object);
+	xml_write_affine_attrs (writer, object);
 
 	/* shadow attrs */
-	xml_create_shadow_attrs (node, object);
+	xml_write_shadow_attrs (writer, data, object);
+
+	xmlTextWriterEndElement (writer);
 
 	gl_debug (DEBUG_XML, "END");
 }
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Add XML Objects->Object-line Node                              */
+/* PRIVATE.  Write Objects->Object-line Node                                */
 /*--------------------------------------------------------------------------*/
 static void
-xml_create_object_line (xmlNodePtr     parent,
-			xmlNsPtr       ns,
-			glLabelObject *object)
+xml_write_object_line (xmlTextWriterPtr  writer,
+		       SaveData         *data,
+		       glLabelObject    *object)
 {
-	xmlNodePtr        node;
 	gdouble           x, y;
 	gdouble           dx, dy;
 	gdouble           line_width;
@@ -1519,99 +1807,101 @@ xml_create_object_line (xmlNodePtr     parent,
 
 	gl_debug (DEBUG_XML, "START");
 
-	node = xmlNewChild (parent, ns, (xmlChar *)"Object-line", NULL);
+	xmlTextWriterStartElement (writer, (xmlChar *)"Object-line");
 
 	/* position attrs */
 	gl_label_object_get_position (object, &x, &y);
-	lgl_xml_set_prop_length (node, "x", x);
-	lgl_xml_set_prop_length (node, "y", y);
+	xml_write_prop_length (writer, data, "x", x);
+	xml_write_prop_length (writer, data, "y", y);
 
 	/* length attrs */
 	gl_label_object_get_size (object, &dx, &dy);
-	lgl_xml_set_prop_length (node, "dx", dx);
-	lgl_xml_set_prop_length (node, "dy", dy);
+	xml_write_prop_length (writer, data, "dx", dx);
+	xml_write_prop_length (writer, data, "dy", dy);
 
 	/* line attrs */
 	line_width = gl_label_object_get_line_width (GL_LABEL_OBJECT(object));
-	lgl_xml_set_prop_length (node, "line_width", line_width);
-	
+	xml_write_prop_length (writer, data, "line_width", line_width);
+
 	line_color_node = gl_label_object_get_line_color (GL_LABEL_OBJECT(object));
 	if (line_color_node->field_flag)
 	{
-		lgl_xml_set_prop_string (node, "line_color_field", line_color_node->key);
+		xml_write_prop_string (writer, "line_color_field", line_color_node->key);
 	}
 	else
 	{
-		lgl_xml_set_prop_uint_hex (node, "line_color", line_color_node->color);
+		xml_write_prop_uint_hex (writer, "line_color", line_color_node->color);
 	}
 	gl_color_node_free (&line_color_node);
 
 
 	/* affine attrs */
-	xml_create_affine_attrs (node, object);
+	xml_write_affine_attrs (writer, object);
 
 	/* shadow attrs */
-	xml_create_shadow_attrs (node, object);
+	xml_write_shadow_attrs (writer, data, object);
+
+	xmlTextWriterEndElement (writer);
 
 	gl_debug (DEBUG_XML, "END");
 }
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Add XML Objects->Object-image Node                             */
+/* PRIVATE.  Write Objects->Object-image Node                               */
 /*--------------------------------------------------------------------------*/
 static void
-xml_create_object_image (xmlNodePtr     parent,
-			 xmlNsPtr       ns,
-			 glLabelObject *object)
+xml_write_object_image (xmlTextWriterPtr  writer,
+			SaveData         *data,
+			glLabelObject    *object)
 {
-	xmlNodePtr        node;
 	gdouble           x, y;
 	gdouble           w, h;
 	glTextNode       *filename;
 
 	gl_debug (DEBUG_XML, "START");
 
-	node = xmlNewChild (parent, ns, (xmlChar *)"Object-image", NULL);
+	xmlTextWriterStartElement (writer, (xmlChar *)"Object-image");
 
 	/* position attrs */
 	gl_label_object_get_position (object, &x, &y);
-	lgl_xml_set_prop_length (node, "x", x);
-	lgl_xml_set_prop_length (node, "y", y);
+	xml_write_prop_length (writer, data, "x", x);
+	xml_write_prop_length (writer, data, "y", y);
 
 	/* size attrs */
 	gl_label_object_get_size (object, &w, &h);
-	lgl_xml_set_prop_length (node, "w", w);
-	lgl_xml_set_prop_length (node, "h", h);
+	xml_write_prop_length (writer, data, "w", w);
+	xml_write_prop_length (writer, data, "h", h);
 
 	/* src OR field attr */
 	filename = gl_label_image_get_filename (GL_LABEL_IMAGE(object));
 	if (filename->field_flag) {
-		lgl_xml_set_prop_string (node, "field", filename->data);
+		xml_write_prop_string (writer, "field", filename->data);
 	} else {
-		lgl_xml_set_prop_string (node, "src", filename->data);
+		xml_write_prop_string (writer, "src", filename->data);
 	}
 	gl_text_node_free (&filename);
 
 	/* affine attrs */
-	xml_create_affine_attrs (node, object);
+	xml_write_affine_attrs (writer, object);
 
 	/* shadow attrs */
-	xml_create_shadow_attrs (node, object);
+	xml_write_shadow_attrs (writer, data, object);
+
+	xmlTextWriterEndElement (writer);
 
 	gl_debug (DEBUG_XML, "END");
 }
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Add XML Objects->Object-barcode Node                           */
+/* PRIVATE.  Write Objects->Object-barcode Node                             */
 /*--------------------------------------------------------------------------*/
 static void
-xml_create_object_barcode (xmlNodePtr     parent,
-			   xmlNsPtr       ns,
-			   glLabelObject *object)
+xml_write_object_barcode (xmlTextWriterPtr  writer,
+			  SaveData         *data,
+			  glLabelObject    *object)
 {
-	xmlNodePtr           node;
 	gdouble              x, y;
 	gdouble              w, h;
 	glTextNode          *text_node;
@@ -1620,33 +1910,33 @@ xml_create_object_barcode (xmlNodePtr     parent,
 
 	gl_debug (DEBUG_XML, "START");
 
-	node = xmlNewChild (parent, ns, (xmlChar *)"Object-barcode", NULL);
+	xmlTextWriterStartElement (writer, (xmlChar *)"Object-barcode");
 
 	/* position attrs */
 	gl_label_object_get_position (object, &x, &y);
-	lgl_xml_set_prop_length (node, "x", x);
-	lgl_xml_set_prop_length (node, "y", y);
+	xml_write_prop_length (writer, data, "x", x);
+	xml_write_prop_length (writer, data, "y", y);
 
 	/* size attrs */
 	gl_label_object_get_raw_size (object, &w, &h);
-	lgl_xml_set_prop_length (node, "w", w);
-	lgl_xml_set_prop_length (node, "h", h);
+	xml_write_prop_length (writer, data, "w", w);
+	xml_write_prop_length (writer, data, "h", h);
 
 	/* Barcode properties attrs */
 	style = gl_label_barcode_get_style (GL_LABEL_BARCODE(object));
-	lgl_xml_set_prop_string (node, "backend", style->backend_id);
-	lgl_xml_set_prop_string (node, "style", style->id);
-	lgl_xml_set_prop_boolean (node, "text", style->text_flag);
-	lgl_xml_set_prop_boolean (node, "checksum", style->checksum_flag);
-	
+	xml_write_prop_string (writer, "backend", style->backend_id);
+	xml_write_prop_string (writer, "style", style->id);
+	xml_write_prop_boolean (writer, "text", style->text_flag);
+	xml_write_prop_boolean (writer, "checksum", style->checksum_flag);
+
 	color_node = gl_label_object_get_line_color (GL_LABEL_OBJECT(object));
 	if (color_node->field_flag)
 	{
-		lgl_xml_set_prop_string (node, "color_field", color_node->key);
+		xml_write_prop_string (writer, "color_field", color_node->key);
 	}
 	else
 	{
-		lgl_xml_set_prop_uint_hex (node, "color", color_node->color);
+		xml_write_prop_uint_hex (writer, "color", color_node->color);
 	}
 	gl_color_node_free (&color_node);
 
@@ -1654,136 +1944,111 @@ xml_create_object_barcode (xmlNodePtr     parent,
 	/* data OR field attr */
 	text_node = gl_label_barcode_get_data (GL_LABEL_BARCODE(object));
 	if (text_node->field_flag) {
-		lgl_xml_set_prop_string (node, "field", text_node->data);
-	        lgl_xml_set_prop_int (node, "format", style->format_digits);
+		xml_write_prop_string (writer, "field", text_node->data);
+	        xml_write_prop_int (writer, "format", style->format_digits);
 	} else {
-		lgl_xml_set_prop_string (node, "data", text_node->data);
+		xml_write_prop_string (writer, "data", text_node->data);
 	}
 	gl_text_node_free (&text_node);
 
 	/* affine attrs */
-	xml_create_affine_attrs (node, object);
+	xml_write_affine_attrs (writer, object);
 
 	/* shadow attrs */
-	xml_create_shadow_attrs (node, object);
+	xml_write_shadow_attrs (writer, data, object);
 
         gl_label_barcode_style_free (style);
 
+	xmlTextWriterEndElement (writer);
+
 	gl_debug (DEBUG_XML, "END");
 }
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Add XML Label Merge Fields Node                                */
+/* PRIVATE.  Write Label Merge Fields Node                                  */
 /*--------------------------------------------------------------------------*/
 static void
-xml_create_merge_fields (xmlNodePtr  parent,
-			 xmlNsPtr    ns,
-			 glLabel    *label)
+xml_write_merge_fields (xmlTextWriterPtr  writer,
+			SaveData         *data)
 {
-	xmlNodePtr  node;
-	gchar      *string;
-	glMerge    *merge;
-
 	gl_debug (DEBUG_XML, "START");
 
-	merge = gl_label_get_merge (label);
-
-	node = xmlNewChild (parent, ns, (xmlChar *)"Merge", NULL);
-
-	string = gl_merge_get_name (merge);
-	lgl_xml_set_prop_string (node, "type", string);
-	g_free (string);
-
-	string = gl_merge_get_src (merge);
-	lgl_xml_set_prop_string (node, "src", string);
-	g_free (string);
-
-	g_object_unref (G_OBJECT(merge));
+	xmlTextWriterStartElement (writer, (xmlChar *)"Merge");
+	xml_write_prop_string (writer, "type", data->merge_type);
+	xml_write_prop_string (writer, "src", data->merge_src);
+	xmlTextWriterEndElement (writer);
 
 	gl_debug (DEBUG_XML, "END");
 }
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Add XML Label Data Node                                        */
+/* PRIVATE.  Write Label Data Node                                          */
 /*--------------------------------------------------------------------------*/
 static void
-xml_create_data (xmlDocPtr   doc,
-                 xmlNodePtr  parent,
-		 xmlNsPtr    ns,
-		 glLabel    *label)
+xml_write_data (xmlTextWriterPtr  writer,
+		SaveData         *data)
 {
-	xmlNodePtr  node;
 	GHashTable *cache;
 	GList      *name_list, *p;
 
 	gl_debug (DEBUG_XML, "START");
 
-	node = xmlNewChild (parent, ns, (xmlChar *)"Data", NULL);
+	xmlTextWriterStartElement (writer, (xmlChar *)"Data");
 
-	cache = gl_label_get_pixbuf_cache (label);
+	cache = gl_label_get_pixbuf_cache (data->label);
 	name_list = gl_pixbuf_cache_get_name_list (cache);
 
 	for (p = name_list; p != NULL; p=p->next) {
-		xml_create_pixdata (node, ns, label, p->data);
+		xml_write_pixdata (writer, data, p->data);
 	}
 
 	gl_pixbuf_cache_free_name_list (name_list);
 
 
-	cache = gl_label_get_svg_cache (label);
+	cache = gl_label_get_svg_cache (data->label);
 	name_list = gl_svg_cache_get_name_list (cache);
 
 	for (p = name_list; p != NULL; p=p->next) {
-		xml_create_file_svg (doc, node, ns, label, p->data);
+		xml_write_file_svg (writer, data, p->data);
 	}
 
 	gl_pixbuf_cache_free_name_list (name_list);
 
+	xmlTextWriterEndElement (writer);
 
 	gl_debug (DEBUG_XML, "END");
 }
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Add XML Label Data embedded Pixdata Node                       */
+/* PRIVATE.  Write Label Data embedded Pixdata Node                         */
 /*--------------------------------------------------------------------------*/
 static void
-xml_create_pixdata (xmlNodePtr  parent,
-		    xmlNsPtr    ns,
-		    glLabel    *label,
-		    gchar      *name)
+xml_write_pixdata (xmlTextWriterPtr  writer,
+		   SaveData         *data,
+		   gchar            *name)
 {
-	xmlNodePtr  node;
 	GHashTable *pixbuf_cache;
 	GdkPixbuf  *pixbuf;
-	GdkPixdata *pixdata;
-	guchar     *stream;
-	guint       stream_length;
-	gchar      *base64;
 
 	gl_debug (DEBUG_XML, "START");
 
-	pixbuf_cache = gl_label_get_pixbuf_cache (label);
+	pixbuf_cache = gl_label_get_pixbuf_cache (data->label);
 
 	pixbuf = gl_pixbuf_cache_get_pixbuf (pixbuf_cache, name);
 	if ( pixbuf != NULL ) {
 
-		pixdata = g_new0 (GdkPixdata, 1);
-		gdk_pixdata_from_pixbuf (pixdata, pixbuf, FALSE);
-		stream = gdk_pixdata_serialize (pixdata, &stream_length);
-		base64 = g_base64_encode (stream, stream_length);
+		xmlTextWriterStartElement (writer, (xmlChar *)"Pixdata");
+		xml_write_prop_string (writer, "name", name);
+		xml_write_prop_string (writer, "encoding", "Base64");
 
-		node = xmlNewChild (parent, ns, (xmlChar *)"Pixdata", (xmlChar *)base64);
-		lgl_xml_set_prop_string (node, "name", name);
-		lgl_xml_set_prop_string (node, "encoding", "Base64");
+		xml_write_pixdata_base64 (writer, pixbuf);
 
-		gl_pixbuf_cache_remove_pixbuf (pixbuf_cache, name);
+		xmlTextWriterEndElement (writer);
 
-		g_free (pixdata);
-		g_free (stream);
-		g_free (base64);
+		gl_pixbuf_cache_remove_pixbuf (pixbuf_cache, name);
 	}
 
 
@@ -1792,33 +2057,101 @@ xml_create_pixdata (xmlNodePtr  parent,
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Add XML Label Data embedded SVG file Node                      */
+/* PRIVATE.  Write base64 encoded GdkPixdata stream of pixbuf.              */
+/*                                                                          */
+/* Produces the same stream as gdk_pixdata_serialize() of a raw (non-RLE)   */
+/* pixdata, but encodes it a row at a time instead of copying the whole     */
+/* image and its base64 representation into memory first.                  */
 /*--------------------------------------------------------------------------*/
 static void
-xml_create_file_svg (xmlDocPtr   doc,
-                     xmlNodePtr  parent,
-                     xmlNsPtr    ns,
-                     glLabel    *label,
-                     gchar      *name)
+xml_write_pixdata_base64 (xmlTextWriterPtr  writer,
+			  GdkPixbuf        *pixbuf)
+{
+	gint      width, height, rowstride, n_channels;
+	guint32   header[GDK_PIXDATA_HEADER_LENGTH / sizeof (guint32)];
+	guint32   pixdata_type;
+	guchar   *pixels;
+	guchar   *last_row;
+	gsize     last_row_length;
+	gchar    *base64;
+	gsize     base64_length;
+	gint      state = 0, save = 0;
+	gint      i;
+
+	width      = gdk_pixbuf_get_width (pixbuf);
+	height     = gdk_pixbuf_get_height (pixbuf);
+	rowstride  = gdk_pixbuf_get_rowstride (pixbuf);
+	n_channels = gdk_pixbuf_get_n_channels (pixbuf);
+	pixels     = gdk_pixbuf_get_pixels (pixbuf);
+
+	g_return_if_fail (gdk_pixbuf_get_bits_per_sample (pixbuf) == 8);
+	g_return_if_fail ((n_channels == 3) || (n_channels == 4));
+
+	pixdata_type = (gdk_pixbuf_get_has_alpha (pixbuf) ? GDK_PIXDATA_COLOR_TYPE_RGBA : GDK_PIXDATA_COLOR_TYPE_RGB)
+		| GDK_PIXDATA_SAMPLE_WIDTH_8 | GDK_PIXDATA_ENCODING_RAW;
+
+	header[0] = GUINT32_TO_BE (GDK_PIXBUF_MAGIC_NUMBER);
+	header[1] = GUINT32_TO_BE (GDK_PIXDATA_HEADER_LENGTH + rowstride * height);
+	header[2] = GUINT32_TO_BE (pixdata_type);
+	header[3] = GUINT32_TO_BE (rowstride);
+	header[4] = GUINT32_TO_BE (width);
+	header[5] = GUINT32_TO_BE (height);
+
+	base64 = g_malloc ((MAX (rowstride, GDK_PIXDATA_HEADER_LENGTH) / 3 + 1) * 4 + 4);
+
+	base64_length = g_base64_encode_step ((guchar *)header, GDK_PIXDATA_HEADER_LENGTH,
+					      FALSE, base64, &state, &save);
+	xmlTextWriterWriteRawLen (writer, (xmlChar *)base64, base64_length);
+
+	for (i = 0; i < height - 1; i++) {
+		base64_length = g_base64_encode_step (pixels + i * rowstride, rowstride,
+						      FALSE, base64, &state, &save);
+		xmlTextWriterWriteRawLen (writer, (xmlChar *)base64, base64_length);
+	}
+
+	/* The last row of a pixbuf is not padded out to the full rowstride. */
+	if (height > 0) {
+		last_row        = g_malloc0 (rowstride);
+		last_row_length = MIN (rowstride, width * n_channels);
+		memcpy (last_row, pixels + (height - 1) * rowstride, last_row_length);
+		base64_length = g_base64_encode_step (last_row, rowstride,
+						      FALSE, base64, &state, &save);
+		xmlTextWriterWriteRawLen (writer, (xmlChar *)base64, base64_length);
+		g_free (last_row);
+	}
+
+	base64_length = g_base64_encode_close (FALSE, base64, &state, &save);
+	xmlTextWriterWriteRawLen (writer, (xmlChar *)base64, base64_length);
+
+	g_free (base64);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Write Label Data embedded SVG file Node                        */
+/*--------------------------------------------------------------------------*/
+static void
+xml_write_file_svg (xmlTextWriterPtr  writer,
+		    SaveData         *data,
+		    gchar            *name)
 {
-	xmlNodePtr  node;
-	xmlNodePtr  cdata_section_node;
 	GHashTable *svg_cache;
         gchar      *svg_data;
 
 	gl_debug (DEBUG_XML, "START");
 
-	svg_cache = gl_label_get_svg_cache (label);
+	svg_cache = gl_label_get_svg_cache (data->label);
 
 	svg_data = gl_svg_cache_get_contents (svg_cache, name);
 	if ( svg_data != NULL ) {
 
-		node = xmlNewChild (parent, ns, (xmlChar *)"File", NULL);
-		lgl_xml_set_prop_string (node, "name", name);
-		lgl_xml_set_prop_string (node, "format", "SVG");
+		xmlTextWriterStartElement (writer, (xmlChar *)"File");
+		xml_write_prop_string (writer, "name", name);
+		xml_write_prop_string (writer, "format", "SVG");
+
+                xmlTextWriterWriteCDATA (writer, (xmlChar *)svg_data);
 
-                cdata_section_node = xmlNewCDataBlock (doc, (xmlChar *)svg_data, strlen (svg_data));
-                xmlAddChild (node, cdata_section_node);
+		xmlTextWriterEndElement (writer);
 
 		g_free (svg_data);
 	}
@@ -1829,14 +2162,12 @@ xml_create_file_svg (xmlDocPtr   doc,
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Create top-level Span node.                                    */
+/* PRIVATE.  Write top-level Span node.                                     */
 /*--------------------------------------------------------------------------*/
 static void
-xml_create_toplevel_span (xmlNodePtr        parent,
-			  xmlNsPtr          ns,
-			  glLabelText      *object_text)
+xml_write_toplevel_span (xmlTextWriterPtr  writer,
+			 glLabelText      *object_text)
 {
-	xmlNodePtr        node;
 	gchar            *font_family;
 	gdouble           font_size;
 	PangoWeight       font_weight;
@@ -1845,9 +2176,8 @@ xml_create_toplevel_span (xmlNodePtr        parent,
 	gdouble           text_line_spacing;
 	GList            *lines, *p_line, *p_node;
 	glTextNode       *text_node;
-	xmlNodePtr        child;
 
-	node = xmlNewChild (parent, ns, (xmlChar *)"Span", NULL);
+	xmlTextWriterStartElement (writer, (xmlChar *)"Span");
 
 	/* All span attrs at top level. */
 	font_family = gl_label_object_get_font_family (GL_LABEL_OBJECT(object_text));
@@ -1855,24 +2185,27 @@ xml_create_toplevel_span (xmlNodePtr        parent,
 	text_line_spacing = gl_label_object_get_text_line_spacing (GL_LABEL_OBJECT(object_text));
 	font_weight = gl_label_object_get_font_weight (GL_LABEL_OBJECT(object_text));
 	font_italic_flag = gl_label_object_get_font_italic_flag (GL_LABEL_OBJECT(object_text));
-	
+
 	color_node = gl_label_object_get_text_color (GL_LABEL_OBJECT(object_text));
 	if (color_node->field_flag)
 	{
-		lgl_xml_set_prop_string (node, "color_field", color_node->key);
+		xml_write_prop_string (writer, "color_field", color_node->key);
 	}
 	else
 	{
-		lgl_xml_set_prop_uint_hex (node, "color", color_node->color);
+		xml_write_prop_uint_hex (writer, "color", color_node->color);
 	}
 	gl_color_node_free (&color_node);
-	
-	lgl_xml_set_prop_string (node, "font_family", font_family);
-	lgl_xml_set_prop_double (node, "font_size", font_size);
-	lgl_xml_set_prop_string (node, "font_weight", gl_str_util_weight_to_string (font_weight));
-	lgl_xml_set_prop_boolean (node, "font_italic", font_italic_flag);
-	
-	lgl_xml_set_prop_double (node, "line_spacing", text_line_spacing);
+
+	xml_write_prop_string (writer, "font_family", font_family);
+	xml_write_prop_double (writer, "font_size", font_size);
+	xml_write_prop_string (writer, "font_weight", gl_str_util_weight_to_string (font_weight));
+	xml_write_prop_boolean (writer, "font_italic", font_italic_flag);
+
+	xml_write_prop_double (writer, "line_spacing", text_line_spacing);
+
+	/* Span has mixed content, so indentation would alter the text. */
+	xmlTextWriterSetIndent (writer, FALSE);
 
 	/* Build children. */
 	lines = gl_label_text_get_lines (GL_LABEL_TEXT(object_text));
@@ -1883,20 +2216,25 @@ xml_create_toplevel_span (xmlNodePtr        parent,
 			text_node = (glTextNode *) p_node->data;
 
 			if (text_node->field_flag) {
-				child = xmlNewChild (node, ns, (xmlChar *)"Field", NULL);
-				lgl_xml_set_prop_string (child, "name", text_node->data);
+				xmlTextWriterStartElement (writer, (xmlChar *)"Field");
+				xml_write_prop_string (writer, "name", text_node->data);
+				xmlTextWriterEndElement (writer);
 			} else {
-				xmlNodeAddContent (node, (xmlChar *)text_node->data);
+				xmlTextWriterWriteString (writer, (xmlChar *)text_node->data);
 			}
 
 		}
 
 		if ( p_line->next ) {
-			child = xmlNewChild (node, ns, (xmlChar *)"NL", NULL);
+			xmlTextWriterStartElement (writer, (xmlChar *)"NL");
+			xmlTextWriterEndElement (writer);
 		}
 
 	}
 
+	xmlTextWriterEndElement (writer);
+	xmlTextWriterSetIndent (writer, TRUE);
+
 	gl_text_node_lines_free (&lines);
 	g_free (font_family);
 
@@ -1904,31 +2242,32 @@ xml_create_toplevel_span (xmlNodePtr        parent,
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Create affine attributes.                                      */
+/* PRIVATE.  Write affine attributes.                                       */
 /*--------------------------------------------------------------------------*/
 static void
-xml_create_affine_attrs (xmlNodePtr        node,
-			 glLabelObject    *object)
+xml_write_affine_attrs (xmlTextWriterPtr  writer,
+			glLabelObject    *object)
 {
         cairo_matrix_t matrix;
 
 	gl_label_object_get_matrix (object, &matrix);
 
-	lgl_xml_set_prop_double (node, "a0", matrix.xx);
-	lgl_xml_set_prop_double (node, "a1", matrix.yx);
-	lgl_xml_set_prop_double (node, "a2", matrix.xy);
-	lgl_xml_set_prop_double (node, "a3", matrix.yy);
-	lgl_xml_set_prop_double (node, "a4", matrix.x0);
-	lgl_xml_set_prop_double (node, "a5", matrix.y0);
+	xml_write_prop_double (writer, "a0", matrix.xx);
+	xml_write_prop_double (writer, "a1", matrix.yx);
+	xml_write_prop_double (writer, "a2", matrix.xy);
+	xml_write_prop_double (writer, "a3", matrix.yy);
+	xml_write_prop_double (writer, "a4", matrix.x0);
+	xml_write_prop_double (writer, "a5", matrix.y0);
 }
 
 
 /*--------------------------------------------------------------------------*/
-/* PRIVATE.  Create shadow attributes.                                      */
+/* PRIVATE.  Write shadow attributes.                                       */
 /*--------------------------------------------------------------------------*/
 static void
-xml_create_shadow_attrs (xmlNodePtr        node,
-			 glLabelObject    *object)
+xml_write_shadow_attrs (xmlTextWriterPtr  writer,
+			SaveData         *data,
+			glLabelObject    *object)
 {
 	gboolean          shadow_state;
 	gdouble           shadow_x;
@@ -1940,29 +2279,107 @@ xml_create_shadow_attrs (xmlNodePtr        node,
 
 	if (shadow_state)
 	{
-		lgl_xml_set_prop_boolean (node, "shadow", shadow_state);
+		xml_write_prop_boolean (writer, "shadow", shadow_state);
 
 		gl_label_object_get_shadow_offset (object, &shadow_x, &shadow_y);
-		lgl_xml_set_prop_length (node, "shadow_x", shadow_x);
-		lgl_xml_set_prop_length (node, "shadow_y", shadow_y);
-		
+		xml_write_prop_length (writer, data, "shadow_x", shadow_x);
+		xml_write_prop_length (writer, data, "shadow_y", shadow_y);
+
 		shadow_color_node = gl_label_object_get_shadow_color (object);
 		if (shadow_color_node->field_flag)
 		{
-			lgl_xml_set_prop_string (node, "shadow_color_field", shadow_color_node->key);
+			xml_write_prop_string (writer, "shadow_color_field", shadow_color_node->key);
 		}
 		else
 		{
-			lgl_xml_set_prop_uint_hex (node, "shadow_color", shadow_color_node->color);
+			xml_write_prop_uint_hex (writer, "shadow_color", shadow_color_node->color);
 		}
 		gl_color_node_free (&shadow_color_node);
 
 		shadow_opacity = gl_label_object_get_shadow_opacity (object);
-		lgl_xml_set_prop_double (node, "shadow_opacity", shadow_opacity);
+		xml_write_prop_double (writer, "shadow_opacity", shadow_opacity);
+	}
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* PRIVATE.  Attribute writers.  These mirror the lgl_xml_set_prop_*()      */
+/* functions, but take units explicitly so they are safe to use off the     */
+/* main thread.                                                             */
+/*--------------------------------------------------------------------------*/
+static void
+xml_write_prop_string (xmlTextWriterPtr  writer,
+		       const gchar      *property,
+		       const gchar      *val)
+{
+	if (val != NULL)
+	{
+		xmlTextWriterWriteAttribute (writer, (xmlChar *)property, (xmlChar *)val);
 	}
 }
 
 
+static void
+xml_write_prop_double (xmlTextWriterPtr  writer,
+		       const gchar      *property,
+		       gdouble           val)
+{
+        gchar  *string, buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+        /* Guarantee "C" locale by use of g_ascii_formatd */
+        string = g_ascii_formatd (buffer, G_ASCII_DTOSTR_BUF_SIZE, "%g", val);
+
+	xmlTextWriterWriteAttribute (writer, (xmlChar *)property, (xmlChar *)string);
+}
+
+
+static void
+xml_write_prop_boolean (xmlTextWriterPtr  writer,
+			const gchar      *property,
+			gboolean          val)
+{
+	xmlTextWriterWriteAttribute (writer, (xmlChar *)property,
+				     (xmlChar *)(val ? "True" : "False"));
+}
+
+
+static void
+xml_write_prop_int (xmlTextWriterPtr  writer,
+		    const gchar      *property,
+		    gint              val)
+{
+	xmlTextWriterWriteFormatAttribute (writer, (xmlChar *)property, "%d", val);
+}
+
+
+static void
+xml_write_prop_uint_hex (xmlTextWriterPtr  writer,
+			 const gchar      *property,
+			 guint             val)
+{
+	xmlTextWriterWriteFormatAttribute (writer, (xmlChar *)property, "0x%08x", val);
+}
+
+
+static void
+xml_write_prop_length (xmlTextWriterPtr  writer,
+		       SaveData         *data,
+		       const gchar      *property,
+		       gdouble           val)
+{
+        gchar  *string, buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+        /* Convert to document units */
+        val *= lgl_units_get_units_per_point (data->units);
+
+        /* Guarantee "C" locale by use of g_ascii_formatd */
+        string = g_ascii_formatd (buffer, G_ASCII_DTOSTR_BUF_SIZE, "%g", val);
+
+	xmlTextWriterWriteFormatAttribute (writer, (xmlChar *)property, "%s%s",
+					   string, lgl_units_get_id (data->units));
+}
+
+
 
 /*
  * Local Variables:       -- emacs
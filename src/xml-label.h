@@ -34,14 +34,20 @@ typedef enum {
 } glXMLLabelStatus;
 
 
+typedef void (*glXMLLabelSaveCallback) (glLabel          *label,
+					glXMLLabelStatus  status,
+					gpointer          user_data);
+
+
 extern glLabel      *gl_xml_label_open          (const gchar * filename,
 						 glXMLLabelStatus *status);
 extern glLabel      *gl_xml_label_open_buffer   (const gchar * buffer,
 						 glXMLLabelStatus *status);
 
-extern void          gl_xml_label_save          (glLabel * label,
+extern void          gl_xml_label_save_async    (glLabel * label,
 						 const gchar * filename,
-						 glXMLLabelStatus *status);
+						 glXMLLabelSaveCallback callback,
+						 gpointer user_data);
 extern gchar        *gl_xml_label_save_buffer   (glLabel * label,
 						 glXMLLabelStatus *status);
 